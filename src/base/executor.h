@@ -28,6 +28,8 @@ public:
 
     void submit(Func);
 
+    int numThreads() const { return static_cast<int>(threads_.size()); }
+
 private:
     void runWorkerLoop();
     Func take();
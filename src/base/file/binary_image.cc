@@ -0,0 +1,204 @@
+#include "base/file/binary_image.h"
+
+#ifndef OS_WIN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "base/file/file.h"
+#include "base/macros.h"
+
+using namespace std;
+
+namespace file {
+
+namespace {
+
+const char MAGIC[8] = { 'P', 'U', 'Y', 'O', 'I', 'M', 'G', '\0' };
+
+struct Header {
+    char magic[8];
+    uint32_t kind;
+    uint32_t version;
+    uint64_t sourceHash;
+};
+
+} // anonymous namespace
+
+string binaryImagePath(const string& sourcePath)
+{
+    return sourcePath + ".bin";
+}
+
+uint64_t hashContent(const string& content)
+{
+    // FNV-1a.
+    uint64_t h = 14695981039346656037ULL;
+    for (char c : content) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint64_t hashFileContent(const string& filename)
+{
+    string content;
+    if (!readFile(filename, &content))
+        return 0;
+    return hashContent(content);
+}
+
+BinaryImageWriter::BinaryImageWriter(uint32_t kind, uint32_t version, uint64_t sourceHash)
+{
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.kind = kind;
+    header.version = version;
+    header.sourceHash = sourceHash;
+    write(header);
+}
+
+void BinaryImageWriter::writeString(const string& s)
+{
+    write(static_cast<uint32_t>(s.size()));
+    data_.append(s);
+}
+
+bool BinaryImageWriter::save(const string& filename) const
+{
+    // Writes to a temporary file first, so that a reader never sees a half-written image.
+#ifdef OS_WIN
+    string tmpFilename = filename + ".tmp";
+    if (!writeFile(tmpFilename, data_))
+        return false;
+#else
+    // The temporary file is unique, so that the processes which save the same image
+    // at the same time don't write to the same temporary file.
+    vector<char> tmpPath(filename.begin(), filename.end());
+    const char suffix[] = ".XXXXXX";
+    tmpPath.insert(tmpPath.end(), suffix, suffix + sizeof(suffix));
+    int fd = mkstemp(tmpPath.data());
+    if (fd < 0) {
+        PLOG(WARNING) << "failed to make a temporary file for " << filename;
+        return false;
+    }
+    string tmpFilename(tmpPath.data());
+
+    // mkstemp makes a file only the owner can read.
+    bool ok = fchmod(fd, 0644) == 0;
+    for (size_t pos = 0; ok && pos < data_.size(); ) {
+        ssize_t n = ::write(fd, data_.data() + pos, data_.size() - pos);
+        if (n < 0) {
+            ok = false;
+            break;
+        }
+        pos += n;
+    }
+    if (::close(fd) < 0)
+        ok = false;
+    if (!ok) {
+        unlink(tmpFilename.c_str());
+        return false;
+    }
+#endif
+    if (rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+        remove(tmpFilename.c_str());
+        return false;
+    }
+    return true;
+}
+
+BinaryImageReader::BinaryImageReader() :
+    data_(nullptr),
+    size_(0),
+    pos_(0)
+{
+}
+
+BinaryImageReader::~BinaryImageReader()
+{
+    close();
+}
+
+bool BinaryImageReader::open(const string& filename, uint32_t kind, uint32_t version, uint64_t sourceHash)
+{
+    close();
+
+#ifdef OS_WIN
+    // TODO(mayah): Windows version? The caller falls back to the source text.
+    UNUSED_VARIABLE(filename);
+    UNUSED_VARIABLE(kind);
+    UNUSED_VARIABLE(version);
+    UNUSED_VARIABLE(sourceHash);
+    return false;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        PLOG(WARNING) << "failed to mmap " << filename;
+        return false;
+    }
+
+    data_ = static_cast<const char*>(p);
+    size_ = st.st_size;
+    pos_ = 0;
+
+    Header header;
+    CHECK(read(&header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.kind != kind) {
+        LOG(WARNING) << filename << " is not an expected binary image";
+        close();
+        return false;
+    }
+    if (header.version != version || header.sourceHash != sourceHash) {
+        LOG(INFO) << filename << " is stale";
+        close();
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+bool BinaryImageReader::readString(string* s)
+{
+    uint32_t size;
+    if (!read(&size))
+        return false;
+    if (size_ - pos_ < size)
+        return false;
+    s->assign(data_ + pos_, size);
+    pos_ += size;
+    return true;
+}
+
+void BinaryImageReader::close()
+{
+#ifndef OS_WIN
+    if (data_)
+        munmap(const_cast<char*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    pos_ = 0;
+}
+
+} // namespace file
@@ -0,0 +1,124 @@
+#ifndef BASE_FILE_BINARY_IMAGE_H_
+#define BASE_FILE_BINARY_IMAGE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "base/noncopyable.h"
+
+namespace file {
+
+// A binary image is a precompiled form of a text file (e.g. a TOML book), so that
+// it can be loaded without parsing. An image starts with a header that has
+// a magic number, the kind and version of the payload, and the hash of the source text.
+// When the source text is modified, the hash won't match, and the image is stale.
+
+// Returns the path of the image compiled from |sourcePath|.
+std::string binaryImagePath(const std::string& sourcePath);
+
+// Returns a hash of |content|.
+std::uint64_t hashContent(const std::string& content);
+// Returns a hash of the content of |filename|. Returns 0 if the file cannot be read.
+std::uint64_t hashFileContent(const std::string& filename);
+
+class BinaryImageWriter : noncopyable {
+public:
+    BinaryImageWriter(std::uint32_t kind, std::uint32_t version, std::uint64_t sourceHash);
+
+    // T should be trivially copyable.
+    template<typename T>
+    void write(const T& v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T should be trivially copyable");
+        data_.append(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    // The elements are aligned for T, so that they can be used in place.
+    // See BinaryImageReader::readArrayView().
+    template<typename T>
+    void writeArray(const std::vector<T>& vs)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T should be trivially copyable");
+        write(static_cast<std::uint32_t>(vs.size()));
+        data_.append((alignof(T) - data_.size() % alignof(T)) % alignof(T), '\0');
+        data_.append(reinterpret_cast<const char*>(vs.data()), sizeof(T) * vs.size());
+    }
+
+    void writeString(const std::string&);
+
+    bool save(const std::string& filename) const;
+
+private:
+    std::string data_;
+};
+
+// BinaryImageReader maps an image with mmap, and reads values from it.
+// All read methods return false when the image is too short.
+class BinaryImageReader : noncopyable {
+public:
+    BinaryImageReader();
+    ~BinaryImageReader();
+
+    // Opens |filename|, and checks its header. Returns false if the image doesn't exist
+    // or it was not made with |kind|, |version| and |sourceHash|.
+    bool open(const std::string& filename, std::uint32_t kind, std::uint32_t version, std::uint64_t sourceHash);
+
+    template<typename T>
+    bool read(T* v)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T should be trivially copyable");
+        if (size_ - pos_ < sizeof(T))
+            return false;
+        memcpy(v, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    template<typename T>
+    bool readArray(std::vector<T>* vs)
+    {
+        const T* data;
+        std::uint32_t size;
+        if (!readArrayView(&data, &size))
+            return false;
+        vs->assign(data, data + size);
+        return true;
+    }
+
+    // Returns the elements in the mapped image without copying them.
+    // They're valid while this reader is open.
+    template<typename T>
+    bool readArrayView(const T** data, std::uint32_t* size)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T should be trivially copyable");
+        if (!read(size))
+            return false;
+        size_t padding = (alignof(T) - pos_ % alignof(T)) % alignof(T);
+        if (size_ - pos_ < padding || (size_ - pos_ - padding) / sizeof(T) < *size)
+            return false;
+        pos_ += padding;
+        *data = reinterpret_cast<const T*>(data_ + pos_);
+        pos_ += sizeof(T) * *size;
+        return true;
+    }
+
+    bool readString(std::string*);
+
+    bool isOpen() const { return data_ != nullptr; }
+    // Returns true if all the payload has been read.
+    bool isEnd() const { return pos_ == size_; }
+
+private:
+    void close();
+
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+} // namespace file
+
+#endif // BASE_FILE_BINARY_IMAGE_H_
@@ -0,0 +1,129 @@
+#include "base/file/binary_image.h"
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/file/file.h"
+#include "base/file/path.h"
+#include "base/file/temporary_file.h"
+
+using namespace std;
+
+TEST(BinaryImageTest, writeAndRead)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    file::BinaryImageWriter writer(1, 2, 3);
+    writer.write(static_cast<int>(42));
+    writer.write(1.5);
+    writer.writeString("puyo");
+    writer.writeArray(vector<int> { 1, 2, 3 });
+    ASSERT_TRUE(writer.save(filename));
+
+    file::BinaryImageReader reader;
+    ASSERT_TRUE(reader.open(filename, 1, 2, 3));
+
+    int i;
+    double d;
+    string s;
+    vector<int> vs;
+    EXPECT_TRUE(reader.read(&i));
+    EXPECT_TRUE(reader.read(&d));
+    EXPECT_TRUE(reader.readString(&s));
+    EXPECT_TRUE(reader.readArray(&vs));
+    EXPECT_TRUE(reader.isEnd());
+    EXPECT_FALSE(reader.read(&i));
+
+    EXPECT_EQ(42, i);
+    EXPECT_EQ(1.5, d);
+    EXPECT_EQ("puyo", s);
+    EXPECT_EQ((vector<int> { 1, 2, 3 }), vs);
+}
+
+TEST(BinaryImageTest, readArrayView)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    file::BinaryImageWriter writer(1, 2, 3);
+    writer.write(static_cast<char>('x'));
+    writer.writeArray(vector<double> { 0.5, 1.5 });
+    ASSERT_TRUE(writer.save(filename));
+
+    file::BinaryImageReader reader;
+    ASSERT_TRUE(reader.open(filename, 1, 2, 3));
+
+    char c;
+    const double* data = nullptr;
+    uint32_t size = 0;
+    ASSERT_TRUE(reader.read(&c));
+    ASSERT_TRUE(reader.readArrayView(&data, &size));
+    EXPECT_TRUE(reader.isEnd());
+
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(data) % alignof(double));
+    ASSERT_EQ(2U, size);
+    EXPECT_EQ(0.5, data[0]);
+    EXPECT_EQ(1.5, data[1]);
+}
+
+TEST(BinaryImageTest, stale)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    file::BinaryImageWriter writer(1, 2, 3);
+    ASSERT_TRUE(writer.save(filename));
+
+    file::BinaryImageReader reader;
+    EXPECT_FALSE(reader.open(filename, 4, 2, 3));
+    EXPECT_FALSE(reader.open(filename, 1, 4, 3));
+    EXPECT_FALSE(reader.open(filename, 1, 2, 4));
+    EXPECT_TRUE(reader.open(filename, 1, 2, 3));
+
+    EXPECT_TRUE(file::remove(filename));
+    EXPECT_FALSE(reader.open(filename, 1, 2, 3));
+}
+
+TEST(BinaryImageTest, hashFileContent)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    ASSERT_TRUE(file::writeFile(filename, "foo"));
+    uint64_t h1 = file::hashFileContent(filename);
+    ASSERT_TRUE(file::writeFile(filename, "bar"));
+    uint64_t h2 = file::hashFileContent(filename);
+    EXPECT_NE(h1, h2);
+}
+
+TEST(BinaryImageTest, saveConcurrently)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    // Each thread saves the same image, as the processes which regenerate the same book do.
+    vector<thread> threads;
+    vector<int> saved(8);
+    for (size_t t = 0; t < saved.size(); ++t) {
+        threads.emplace_back([&filename, &saved, t]() {
+            file::BinaryImageWriter writer(1, 2, 3);
+            writer.writeArray(vector<int>(10000, 42));
+            saved[t] = writer.save(filename);
+        });
+    }
+    for (auto& th : threads)
+        th.join();
+
+    for (int ok : saved)
+        EXPECT_TRUE(ok);
+
+    file::BinaryImageReader reader;
+    ASSERT_TRUE(reader.open(filename, 1, 2, 3));
+    vector<int> vs;
+    EXPECT_TRUE(reader.readArray(&vs));
+    EXPECT_TRUE(reader.isEnd());
+    EXPECT_EQ(vector<int>(10000, 42), vs);
+}
@@ -0,0 +1,68 @@
+#include "base/file/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glog/logging.h>
+
+using namespace std;
+
+namespace file {
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const string& path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        PLOG(ERROR) << "couldn't open " << path;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        PLOG(ERROR) << "couldn't stat " << path;
+        ::close(fd);
+        return false;
+    }
+
+    // mmap() fails for an empty file.
+    if (st.st_size == 0) {
+        ::close(fd);
+        data_ = "";
+        size_ = 0;
+        return true;
+    }
+
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping is kept after the descriptor is closed.
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        PLOG(ERROR) << "couldn't map " << path;
+        return false;
+    }
+
+    data_ = static_cast<const char*>(p);
+    size_ = st.st_size;
+    mapped_ = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mapped_)
+        munmap(const_cast<char*>(data_), size_);
+
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+}
+
+} // namespace file
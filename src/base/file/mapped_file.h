@@ -0,0 +1,36 @@
+#ifndef BASE_FILE_MAPPED_FILE_H_
+#define BASE_FILE_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+#include "base/noncopyable.h"
+
+namespace file {
+
+// MappedFile maps a whole file into memory as read only. Reading many large
+// files (e.g. a corpus of game logs) this way doesn't copy them into the heap.
+class MappedFile : noncopyable {
+public:
+    MappedFile() {}
+    ~MappedFile();
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+
+    // The mapped content. An empty file has non-null data() whose size() is 0.
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    // true if |data_| should be unmapped.
+    bool mapped_ = false;
+};
+
+} // namespace file
+
+#endif // BASE_FILE_MAPPED_FILE_H_
@@ -0,0 +1,45 @@
+#include "base/file/mapped_file.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "base/file/file.h"
+#include "base/file/temporary_file.h"
+
+using namespace std;
+
+TEST(MappedFileTest, open)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    const string content("puyo\0puyo", 9);
+    ASSERT_TRUE(file::writeFile(filename, content));
+
+    file::MappedFile mapped;
+    ASSERT_TRUE(mapped.open(filename));
+    EXPECT_TRUE(mapped.isOpen());
+    EXPECT_EQ(content, string(mapped.data(), mapped.size()));
+
+    mapped.close();
+    EXPECT_FALSE(mapped.isOpen());
+    EXPECT_EQ(0U, mapped.size());
+}
+
+TEST(MappedFileTest, empty)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    file::MappedFile mapped;
+    ASSERT_TRUE(mapped.open(filename));
+    EXPECT_TRUE(mapped.isOpen());
+    EXPECT_EQ(0U, mapped.size());
+}
+
+TEST(MappedFileTest, nonexistent)
+{
+    file::MappedFile mapped;
+    EXPECT_FALSE(mapped.open("/nonexistent/mapped_file_test"));
+    EXPECT_FALSE(mapped.isOpen());
+}
@@ -0,0 +1,50 @@
+#ifndef BASE_FILE_TEMPORARY_FILE_H_
+#define BASE_FILE_TEMPORARY_FILE_H_
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "base/noncopyable.h"
+
+namespace file {
+
+// TemporaryFile makes a unique empty file in /tmp, and removes it on destruction.
+// The file can be rewritten or removed while a TemporaryFile is alive.
+// This is for tests.
+class TemporaryFile : noncopyable {
+public:
+    // |suffix| is appended to the unique name, e.g. ".json".
+    explicit TemporaryFile(const std::string& suffix = std::string())
+    {
+        std::string pattern = "/tmp/puyoai_test_XXXXXX" + suffix;
+        std::vector<char> buf(pattern.begin(), pattern.end());
+        buf.push_back('\0');
+        int fd = mkstemps(buf.data(), static_cast<int>(suffix.size()));
+        CHECK_GE(fd, 0) << "failed to make a temporary file";
+        close(fd);
+        path_ = buf.data();
+    }
+
+    TemporaryFile(TemporaryFile&& other) : path_(std::move(other.path_)) { other.path_.clear(); }
+
+    ~TemporaryFile()
+    {
+        if (!path_.empty())
+            unlink(path_.c_str());
+    }
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+} // namespace file
+
+#endif // BASE_FILE_TEMPORARY_FILE_H_
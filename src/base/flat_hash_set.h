@@ -0,0 +1,136 @@
+#ifndef BASE_FLAT_HASH_SET_H_
+#define BASE_FLAT_HASH_SET_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glog/logging.h>
+
+namespace flat_hash {
+
+// The hash values might be weak in the lower bits, so they are mixed
+// (fmix64, the finalizer of MurmurHash3) before they are masked.
+inline std::uint64_t mix(std::uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+// Returns the smallest power of 2 capacity which keeps the load factor of |n| keys <= 1/2.
+inline std::size_t capacityFor(std::size_t n, std::size_t minCapacity)
+{
+    std::size_t capacity = minCapacity;
+    while (capacity < n * 2)
+        capacity *= 2;
+    return capacity;
+}
+
+} // namespace flat_hash
+
+// FlatHashSet is a set of 64-bit hash values (e.g. CoreField::hash()) with open
+// addressing and linear probing. Unlike std::unordered_set, insert() doesn't allocate
+// unless the table grows, and clear() keeps the table, so a set can be reused
+// for every turn of a search.
+class FlatHashSet {
+public:
+    explicit FlatHashSet(std::size_t expectedSize = 0) { reserve(expectedSize); }
+
+    // Returns true if |key| is newly inserted.
+    bool insert(std::uint64_t key)
+    {
+        if (key == EMPTY_KEY) {
+            bool inserted = !hasEmptyKey_;
+            hasEmptyKey_ = true;
+            size_ += inserted;
+            return inserted;
+        }
+
+        if ((size_ + 1) * 2 > table_.size())
+            rehash(table_.empty() ? MIN_CAPACITY : table_.size() * 2);
+
+        for (std::size_t i = indexOf(key); ; i = (i + 1) & mask_) {
+            if (table_[i] == key)
+                return false;
+            if (table_[i] == EMPTY_KEY) {
+                table_[i] = key;
+                ++size_;
+                return true;
+            }
+        }
+    }
+
+    bool contains(std::uint64_t key) const
+    {
+        if (key == EMPTY_KEY)
+            return hasEmptyKey_;
+        if (table_.empty())
+            return false;
+
+        for (std::size_t i = indexOf(key); ; i = (i + 1) & mask_) {
+            if (table_[i] == key)
+                return true;
+            if (table_[i] == EMPTY_KEY)
+                return false;
+        }
+    }
+
+    // Removes all the keys without freeing the table.
+    void clear()
+    {
+        if (size_ == 0)
+            return;
+        std::fill(table_.begin(), table_.end(), static_cast<std::uint64_t>(EMPTY_KEY));
+        hasEmptyKey_ = false;
+        size_ = 0;
+    }
+
+    // Makes the table large enough for |n| keys.
+    void reserve(std::size_t n)
+    {
+        std::size_t capacity = flat_hash::capacityFor(n, MIN_CAPACITY);
+        if (capacity > table_.size())
+            rehash(capacity);
+    }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    static const std::uint64_t EMPTY_KEY = 0;
+    static const std::size_t MIN_CAPACITY = 16;
+
+    std::size_t indexOf(std::uint64_t key) const
+    {
+        return static_cast<std::size_t>(flat_hash::mix(key)) & mask_;
+    }
+
+    void rehash(std::size_t capacity)
+    {
+        DCHECK_EQ(capacity & (capacity - 1), 0U) << "capacity should be a power of 2";
+
+        std::vector<std::uint64_t> old(capacity, static_cast<std::uint64_t>(EMPTY_KEY));
+        old.swap(table_);
+        mask_ = capacity - 1;
+        for (std::uint64_t key : old) {
+            if (key == EMPTY_KEY)
+                continue;
+            std::size_t i = indexOf(key);
+            while (table_[i] != EMPTY_KEY)
+                i = (i + 1) & mask_;
+            table_[i] = key;
+        }
+    }
+
+    std::vector<std::uint64_t> table_;
+    std::size_t mask_ = 0;
+    std::size_t size_ = 0;
+    bool hasEmptyKey_ = false;
+};
+
+#endif // BASE_FLAT_HASH_SET_H_
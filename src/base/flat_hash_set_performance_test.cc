@@ -0,0 +1,71 @@
+#include "base/flat_hash_set.h"
+
+#include <iostream>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/time_stamp_counter.h"
+
+using namespace std;
+
+namespace {
+
+// Keys like the field hashes in a beam search: a turn inserts about 10000 hashes,
+// about a third of which are duplicated, and the set is cleared for the next turn.
+vector<vector<uint64_t>> makeTurns()
+{
+    mt19937_64 mt(1);
+    vector<vector<uint64_t>> turns(50);
+    for (auto& keys : turns) {
+        vector<uint64_t> unique(7000);
+        for (auto& key : unique)
+            key = mt();
+        for (int i = 0; i < 10000; ++i)
+            keys.push_back(unique[mt() % unique.size()]);
+    }
+    return turns;
+}
+
+} // namespace
+
+TEST(FlatHashSetPerformanceTest, unorderedSet)
+{
+    const vector<vector<uint64_t>> turns = makeTurns();
+    TimeStampCounterData tsc;
+    size_t numInserted = 0;
+
+    for (int i = 0; i < 20; ++i) {
+        for (const auto& keys : turns) {
+            ScopedTimeStampCounter stsc(&tsc);
+            unordered_set<uint64_t> visited;
+            for (uint64_t key : keys)
+                numInserted += visited.insert(key).second;
+        }
+    }
+
+    cout << "inserted: " << numInserted << endl;
+    tsc.showStatistics();
+}
+
+TEST(FlatHashSetPerformanceTest, flatHashSet)
+{
+    const vector<vector<uint64_t>> turns = makeTurns();
+    TimeStampCounterData tsc;
+    size_t numInserted = 0;
+
+    FlatHashSet visited;
+    for (int i = 0; i < 20; ++i) {
+        for (const auto& keys : turns) {
+            ScopedTimeStampCounter stsc(&tsc);
+            visited.clear();
+            for (uint64_t key : keys)
+                numInserted += visited.insert(key);
+        }
+    }
+
+    cout << "inserted: " << numInserted << endl;
+    tsc.showStatistics();
+}
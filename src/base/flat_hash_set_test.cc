@@ -0,0 +1,52 @@
+#include "base/flat_hash_set.h"
+
+#include <random>
+#include <unordered_set>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+TEST(FlatHashSetTest, insert)
+{
+    FlatHashSet set;
+    EXPECT_TRUE(set.empty());
+
+    EXPECT_TRUE(set.insert(1));
+    EXPECT_FALSE(set.insert(1));
+    EXPECT_TRUE(set.insert(0));
+    EXPECT_FALSE(set.insert(0));
+    EXPECT_TRUE(set.insert(~0ULL));
+
+    EXPECT_EQ(3U, set.size());
+    EXPECT_TRUE(set.contains(0));
+    EXPECT_TRUE(set.contains(1));
+    EXPECT_TRUE(set.contains(~0ULL));
+    EXPECT_FALSE(set.contains(2));
+}
+
+TEST(FlatHashSetTest, clear)
+{
+    FlatHashSet set;
+    for (uint64_t i = 0; i < 100; ++i)
+        set.insert(i);
+    set.clear();
+
+    EXPECT_TRUE(set.empty());
+    for (uint64_t i = 0; i < 100; ++i)
+        EXPECT_FALSE(set.contains(i));
+    EXPECT_TRUE(set.insert(50));
+}
+
+TEST(FlatHashSetTest, sameAsUnorderedSet)
+{
+    mt19937_64 mt(1);
+    FlatHashSet set;
+    unordered_set<uint64_t> expected;
+    for (int i = 0; i < 100000; ++i) {
+        // Many duplicates and keys with the same lower bits.
+        uint64_t key = (mt() % 30000) << 20;
+        EXPECT_EQ(expected.insert(key).second, set.insert(key));
+    }
+    EXPECT_EQ(expected.size(), set.size());
+}
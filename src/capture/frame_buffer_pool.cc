@@ -0,0 +1,87 @@
+#include "capture/frame_buffer_pool.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <glog/logging.h>
+
+using namespace std;
+
+struct FrameBufferPool::State {
+    ~State()
+    {
+        CHECK_EQ(available.size(), surfaces.size());
+        for (SDL_Surface* surface : surfaces)
+            SDL_FreeSurface(surface);
+    }
+
+    mutex mu;
+    condition_variable condVar;
+    vector<SDL_Surface*> surfaces;
+    vector<SDL_Surface*> available;
+};
+
+// static
+UniqueSDLSurface FrameBufferPool::wrap(const shared_ptr<State>& state, SDL_Surface* surface)
+{
+    // The deleter keeps |state| alive until the surface is returned.
+    return UniqueSDLSurface(surface, [state](SDL_Surface* s) {
+        s->userdata = nullptr;
+        lock_guard<mutex> lock(state->mu);
+        state->available.push_back(s);
+        state->condVar.notify_one();
+    });
+}
+
+FrameBufferPool::FrameBufferPool(int numBuffers, int width, int height) :
+    width_(width),
+    height_(height),
+    state_(new State)
+{
+    CHECK_GT(numBuffers, 0);
+
+    for (int i = 0; i < numBuffers; ++i) {
+        SDL_Surface* surface = SDL_CreateRGBSurface(0, width, height, 32, 0, 0, 0, 0);
+        CHECK(surface) << SDL_GetError();
+        state_->surfaces.push_back(surface);
+    }
+    state_->available = state_->surfaces;
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+}
+
+UniqueSDLSurface FrameBufferPool::tryAcquire()
+{
+    lock_guard<mutex> lock(state_->mu);
+    if (state_->available.empty())
+        return emptyUniqueSDLSurface();
+
+    SDL_Surface* surface = state_->available.back();
+    state_->available.pop_back();
+    return wrap(state_, surface);
+}
+
+UniqueSDLSurface FrameBufferPool::acquire()
+{
+    unique_lock<mutex> lock(state_->mu);
+    while (state_->available.empty())
+        state_->condVar.wait(lock);
+
+    SDL_Surface* surface = state_->available.back();
+    state_->available.pop_back();
+    return wrap(state_, surface);
+}
+
+int FrameBufferPool::capacity() const
+{
+    return static_cast<int>(state_->surfaces.size());
+}
+
+int FrameBufferPool::numAvailable() const
+{
+    lock_guard<mutex> lock(state_->mu);
+    return static_cast<int>(state_->available.size());
+}
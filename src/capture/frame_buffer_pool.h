@@ -0,0 +1,41 @@
+#ifndef CAPTURE_FRAME_BUFFER_POOL_H_
+#define CAPTURE_FRAME_BUFFER_POOL_H_
+
+#include <memory>
+
+#include "base/noncopyable.h"
+#include "gui/unique_sdl_surface.h"
+
+// FrameBufferPool has a fixed number of preallocated 32bit surfaces.
+// A surface taken from the pool is returned to the pool when the UniqueSDLSurface
+// is destructed, so frames can be passed between a capture thread and consumers
+// without allocating a new surface for each frame.
+// The surfaces can outlive the pool. They are freed when all of them are released.
+// This class is thread-safe.
+class FrameBufferPool : noncopyable {
+public:
+    FrameBufferPool(int numBuffers, int width, int height);
+    ~FrameBufferPool();
+
+    // Returns an empty surface if all the buffers are in use.
+    UniqueSDLSurface tryAcquire();
+    // Waits until a buffer is released if all the buffers are in use.
+    UniqueSDLSurface acquire();
+
+    int capacity() const;
+    int numAvailable() const;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+private:
+    struct State;
+
+    static UniqueSDLSurface wrap(const std::shared_ptr<State>&, SDL_Surface*);
+
+    const int width_;
+    const int height_;
+    std::shared_ptr<State> state_;
+};
+
+#endif // CAPTURE_FRAME_BUFFER_POOL_H_
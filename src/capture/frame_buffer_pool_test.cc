@@ -0,0 +1,46 @@
+#include "capture/frame_buffer_pool.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+TEST(FrameBufferPoolTest, recycle)
+{
+    FrameBufferPool pool(2, 32, 16);
+    EXPECT_EQ(2, pool.capacity());
+    EXPECT_EQ(2, pool.numAvailable());
+
+    UniqueSDLSurface s1 = pool.tryAcquire();
+    UniqueSDLSurface s2 = pool.tryAcquire();
+    ASSERT_TRUE(s1.get());
+    ASSERT_TRUE(s2.get());
+    EXPECT_EQ(32, s1->w);
+    EXPECT_EQ(16, s1->h);
+    EXPECT_EQ(0, pool.numAvailable());
+
+    // All the buffers are in use.
+    EXPECT_FALSE(pool.tryAcquire().get());
+
+    SDL_Surface* released = s1.get();
+    s1.reset();
+    EXPECT_EQ(1, pool.numAvailable());
+
+    // The released buffer should be reused.
+    UniqueSDLSurface s3 = pool.acquire();
+    EXPECT_EQ(released, s3.get());
+}
+
+TEST(FrameBufferPoolTest, surfaceOutlivesPool)
+{
+    UniqueSDLSurface surface(emptyUniqueSDLSurface());
+    {
+        FrameBufferPool pool(1, 8, 8);
+        surface = pool.acquire();
+    }
+
+    ASSERT_TRUE(surface.get());
+    EXPECT_EQ(8, surface->w);
+    surface.reset();
+}
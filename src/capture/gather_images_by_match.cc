@@ -6,48 +6,16 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <SDL.h>
-#include <SDL_image.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
 #include "base/file/path.h"
-#include "base/strings.h"
 #include "capture/ac_analyzer.h"
-#include "gui/unique_sdl_surface.h"
+#include "capture/image_batch_processor.h"
 
 using namespace std;
 
-bool listBMPsRecursively(const std::string& root, std::vector<std::string>* files)
-{
-    cout << root << endl;
-
-    vector<string> tmp_files;
-    if (!file::listFiles(root, &tmp_files))
-        return false;
-
-    for (const auto& f : tmp_files) {
-        if (f == "." || f == "..")
-            continue;
-
-        string p = file::joinPath(root, f);
-
-        if (strings::hasSuffix(f, ".bmp")) {
-            files->push_back(p);
-            continue;
-        }
-
-        if (!file::isDirectory(p)) {
-            LOG(INFO) << "Unknown file: " << p << endl;
-            continue;
-        }
-
-        if (!listBMPsRecursively(p, files)) {
-            return false;
-        }
-    }
-
-    return true;
-}
+DECLARE_int32(num_threads);
 
 int main(int argc, char* argv[])
 {
@@ -61,21 +29,29 @@ int main(int argc, char* argv[])
 
     // list files.
     vector<string> files;
-    CHECK(listBMPsRecursively(argv[1], &files));
-    std::sort(files.begin(), files.end());
+    CHECK(listImagesRecursively(argv[1], &files));
 
     cout << "file listed: size=" << files.size() << endl;
 
-    ACAnalyzer analyzer;
+    // Detecting game states is independent for each image, so it's done in parallel.
+    // Splitting into matches depends on the order of images, so it's done sequentially.
+    ImageBatchProcessor processor(std::max(1, FLAGS_num_threads));
+    vector<CaptureGameState> states = processor.process(files, [](ACAnalyzer* analyzer, const string& f, SDL_Surface* surface) {
+        if (!surface) {
+            LOG(ERROR) << "Failed to load " << f;
+            return CaptureGameState::UNKNOWN;
+        }
+        return analyzer->detectGameState(surface);
+    });
+
+    cout << "game state detected" << endl;
 
     int match_no = 0;
     bool game_end_detected = false;
 
     for (size_t i = 0; i < files.size(); ++i) {
         const auto& f = files[i];
-        UniqueSDLSurface surface = makeUniqueSDLSurface(IMG_Load(f.c_str()));
-
-        CaptureGameState state = analyzer.detectGameState(surface.get());
+        CaptureGameState state = states[i];
         if (state == CaptureGameState::LEVEL_SELECT) {
             // game start
             if (game_end_detected) {
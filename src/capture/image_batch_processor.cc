@@ -0,0 +1,68 @@
+#include "capture/image_batch_processor.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include "base/file/path.h"
+#include "base/strings.h"
+
+using namespace std;
+
+namespace {
+
+bool listImagesRecursivelyInternal(const string& root, vector<string>* files)
+{
+    vector<string> tmp_files;
+    if (!file::listFiles(root, &tmp_files))
+        return false;
+
+    for (const auto& f : tmp_files) {
+        if (f == "." || f == "..")
+            continue;
+
+        string p = file::joinPath(root, f);
+        if (strings::hasSuffix(f, ".bmp") || strings::hasSuffix(f, ".png")) {
+            files->push_back(p);
+            continue;
+        }
+
+        if (!file::isDirectory(p)) {
+            LOG(INFO) << "Unknown file: " << p;
+            continue;
+        }
+
+        if (!listImagesRecursivelyInternal(p, files))
+            return false;
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+bool listImagesRecursively(const string& root, vector<string>* files)
+{
+    if (!listImagesRecursivelyInternal(root, files))
+        return false;
+
+    sort(files->begin(), files->end());
+    return true;
+}
+
+ImageBatchProcessor::ImageBatchProcessor(int numThreads) :
+    executor_(numThreads)
+{
+    CHECK_GT(numThreads, 0);
+
+    // Constructing ACAnalyzer sets up the recognizer model, so analyzers are created
+    // once here and reused for every image.
+    for (int i = 0; i < numThreads; ++i)
+        analyzers_.emplace_back(new ACAnalyzer);
+
+    executor_.start();
+}
+
+ImageBatchProcessor::~ImageBatchProcessor()
+{
+}
@@ -0,0 +1,68 @@
+#ifndef CAPTURE_IMAGE_BATCH_PROCESSOR_H_
+#define CAPTURE_IMAGE_BATCH_PROCESSOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <SDL.h>
+#include <SDL_image.h>
+
+#include "base/executor.h"
+#include "base/noncopyable.h"
+#include "base/wait_group.h"
+#include "capture/ac_analyzer.h"
+#include "gui/unique_sdl_surface.h"
+
+// Lists image files (*.bmp and *.png) under |root| recursively. The result is sorted.
+bool listImagesRecursively(const std::string& root, std::vector<std::string>* files);
+
+// ImageBatchProcessor processes many captured images on a thread pool.
+// Each worker has its own ACAnalyzer, because an analyzer is not thread-safe.
+class ImageBatchProcessor : noncopyable {
+public:
+    explicit ImageBatchProcessor(int numThreads);
+    ~ImageBatchProcessor();
+
+    // Calls |f(ACAnalyzer*, const std::string& filename, SDL_Surface*)| for each image,
+    // and returns the results in the order of |filenames|. When an image cannot be loaded,
+    // the surface is nullptr. The result type must be default constructible.
+    // Note that |f| is called from multiple threads.
+    template<typename Func>
+    auto process(const std::vector<std::string>& filenames, Func f)
+        -> std::vector<typename std::result_of<Func(ACAnalyzer*, const std::string&, SDL_Surface*)>::type>;
+
+private:
+    Executor executor_;
+    std::vector<std::unique_ptr<ACAnalyzer>> analyzers_;
+};
+
+template<typename Func>
+auto ImageBatchProcessor::process(const std::vector<std::string>& filenames, Func f)
+    -> std::vector<typename std::result_of<Func(ACAnalyzer*, const std::string&, SDL_Surface*)>::type>
+{
+    typedef typename std::result_of<Func(ACAnalyzer*, const std::string&, SDL_Surface*)>::type Result;
+    std::vector<Result> results(filenames.size());
+
+    // Images are taken one by one, so that a slow image doesn't block a whole shard.
+    std::atomic<size_t> next(0);
+    WaitGroup wg;
+    wg.add(analyzers_.size());
+    for (const auto& analyzer : analyzers_) {
+        ACAnalyzer* a = analyzer.get();
+        executor_.submit([&, a]() {
+            for (size_t i = next++; i < filenames.size(); i = next++) {
+                UniqueSDLSurface surface(makeUniqueSDLSurface(IMG_Load(filenames[i].c_str())));
+                results[i] = f(a, filenames[i], surface.get());
+            }
+            wg.done();
+        });
+    }
+    wg.waitUntilDone();
+
+    return results;
+}
+
+#endif // CAPTURE_IMAGE_BATCH_PROCESSOR_H_
@@ -45,6 +45,11 @@ Images::~Images() {
 
 UniqueSDLSurface Images::getNextFrame()
 {
+    if (index_ >= static_cast<int>(images_.size())) {
+        done_ = true;
+        return emptyUniqueSDLSurface();
+    }
+
     prev_index_ = index_;
     SDL_Surface* surface = IMG_Load(images_[index_].c_str());
     if (surface == NULL) {
@@ -1,19 +1,29 @@
 #include "capture/movie_source.h"
 
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
+#include <glog/logging.h>
+
 using namespace std;
 
 // TODO: Remove this re-definition. It is a workaround for old libavutil.
-#ifndef PIX_FMT_RGB24
-#define PIX_FMT_RGB24 AV_PIX_FMT_RGB24
+#ifndef PIX_FMT_BGRA
+#define PIX_FMT_BGRA AV_PIX_FMT_BGRA
 #endif
 
+namespace {
+// The consumers (e.g. Capture) keep the current and 4 previous frames.
+const int NUM_CONSUMER_FRAMES = 6;
+}
+
 MovieSource::MovieSource(const char* filename) :
     filename_(filename),
     waitUntilTrue_(true),
     sws_(NULL),
-    surf_(makeUniqueSDLSurface(nullptr))
+    shouldStopDecoder_(false),
+    decoderFinished_(false)
 {
     format_ = NULL;
 
@@ -66,48 +76,22 @@ MovieSource::MovieSource(const char* filename) :
     // c.f. http://stackoverflow.com/questions/24057248/ffmpeg-undefined-references-to-av-frame-alloc
 
     frame_ = av_frame_alloc();
-    if (frame_ == NULL) {
-        fprintf(stderr, "Couldn't allocate frame memory\n");
-        return;
-    }
-
-    frame_rgb_ = av_frame_alloc();
-    if (frame_rgb_ == NULL) {
-        fprintf(stderr, "Couldn't allocate frame_rgb memory\n");
-        return;
-    }
 #else
     frame_ = avcodec_alloc_frame();
+#endif
     if (frame_ == NULL) {
         fprintf(stderr, "Couldn't allocate frame memory\n");
         return;
     }
 
-    frame_rgb_ = avcodec_alloc_frame();
-    if (frame_rgb_ == NULL) {
-        fprintf(stderr, "Couldn't allocate frame_rgb memory\n");
-        return;
-    }
-#endif
-
-    int buf_len = avpicture_get_size(PIX_FMT_RGB24, width_, height_);
-    uint8_t* buffer = (uint8_t*)calloc(sizeof(uint8_t), buf_len);
-    avpicture_fill((AVPicture*)frame_rgb_, buffer,
-                   PIX_FMT_RGB24, width_, height_);
-
-    SDL_Surface* surf = SDL_CreateRGBSurfaceFrom(frame_rgb_->data[0], width_, height_, 24,
-                                                 buf_len / height_,
-                                                 255, 255 << 8, 255 << 16, 0);
-    surf_ = makeUniqueSDLSurface(surf);
-
-    fprintf(stderr,"Parsed movie: width=%d height=%d pitch=%d\n",
-            width_, height_, surf_->pitch);
+    fprintf(stderr,"Parsed movie: width=%d height=%d\n", width_, height_);
 
     ok_ = true;
 }
 
 MovieSource::~MovieSource()
 {
+    stopDecoder();
     // TODO(hamaji): Free resource.
 }
 
@@ -116,31 +100,168 @@ void MovieSource::nextStep()
     waitUntilTrue_ = true;
 }
 
-UniqueSDLSurface MovieSource::getNextFrame()
+void MovieSource::setDecimation(int n)
 {
-    int frame_finished;
-    while (true) {
-        if (av_read_frame(format_, &packet_) < 0) {
-            done_ = true;
-            return emptyUniqueSDLSurface();
-        }
+    CHECK(!decoderThread_.joinable()) << "decimation should be set before starting the decoder";
+    CHECK_GT(n, 0);
+    decimation_ = n;
+}
 
-        if (packet_.stream_index == video_index_) {
-            avcodec_decode_video2(codec_, frame_, &frame_finished, &packet_);
+void MovieSource::setReadAhead(int numFrames)
+{
+    CHECK(!decoderThread_.joinable()) << "read ahead should be set before starting the decoder";
+    CHECK_GT(numFrames, 0);
+    readAhead_ = numFrames;
+}
 
-            if (frame_finished) {
-                sws_ = sws_getCachedContext(sws_,
-                                            width_, height_, codec_->pix_fmt,
-                                            width_, height_, PIX_FMT_RGB24,
-                                            SWS_BICUBIC, NULL, NULL, NULL);
+bool MovieSource::start()
+{
+    if (!ok())
+        return false;
+    if (decoderThread_.joinable())
+        return true;
 
-                sws_scale(sws_, frame_->data, frame_->linesize, 0, height_, frame_rgb_->data, frame_rgb_->linesize);
-                break;
-            }
-        }
+    if (!pool_) {
+        // The decoder thread holds one more frame while waiting for the queue.
+        pool_.reset(new FrameBufferPool(readAhead_ + NUM_CONSUMER_FRAMES + 1, width_, height_));
+        queue_.reset(new base::BlockingQueue<DecodedFrame>(readAhead_));
+    }
+
+    shouldStopDecoder_ = false;
+    decoderFinished_ = false;
+    decoderThread_ = thread([this]() {
+        runDecoderLoop();
+    });
+    return true;
+}
+
+bool MovieSource::stopDecoder()
+{
+    if (!decoderThread_.joinable())
+        return false;
+
+    shouldStopDecoder_ = true;
+    // The decoder thread might be waiting for the queue to have a space.
+    while (!decoderFinished_) {
+        DecodedFrame frame;
+        (void)queue_->takeWithTimeout(chrono::steady_clock::now() + chrono::milliseconds(10), &frame);
+    }
+    decoderThread_.join();
+
+    while (!queue_->empty())
+        (void)queue_->take();
+    return true;
+}
 
+bool MovieSource::seekToFrame(int64_t frameIndex)
+{
+    if (!ok())
+        return false;
+
+    bool wasRunning = stopDecoder();
+
+    const AVStream* stream = format_->streams[video_index_];
+    int64_t startTime = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    int64_t timestamp = startTime + av_rescale_q(frameIndex, av_inv_q(stream->r_frame_rate), stream->time_base);
+    if (av_seek_frame(format_, video_index_, timestamp, AVSEEK_FLAG_BACKWARD) < 0) {
+        LOG(ERROR) << "failed to seek: frame=" << frameIndex;
+        if (wasRunning)
+            start();
+        return false;
+    }
+    avcodec_flush_buffers(codec_);
+
+    seekTarget_ = frameIndex;
+    nextFrameIndex_ = frameIndex;
+    done_ = false;
+
+    if (wasRunning)
+        return start();
+    return true;
+}
+
+bool MovieSource::seekToTime(double seconds)
+{
+    const AVStream* stream = format_->streams[video_index_];
+    return seekToFrame(llround(seconds * av_q2d(stream->r_frame_rate)));
+}
+
+bool MovieSource::decodeNextFrame()
+{
+    int frame_finished = 0;
+    while (av_read_frame(format_, &packet_) >= 0) {
+        if (packet_.stream_index == video_index_)
+            avcodec_decode_video2(codec_, frame_, &frame_finished, &packet_);
         av_free_packet(&packet_);
+
+        if (frame_finished)
+            return true;
+    }
+
+    // Flush the frames delayed in the decoder.
+    av_init_packet(&packet_);
+    packet_.data = NULL;
+    packet_.size = 0;
+    avcodec_decode_video2(codec_, frame_, &frame_finished, &packet_);
+    return frame_finished;
+}
+
+int64_t MovieSource::frameIndexOfCurrentFrame()
+{
+    const AVStream* stream = format_->streams[video_index_];
+    int64_t pts = av_frame_get_best_effort_timestamp(frame_);
+    if (pts == AV_NOPTS_VALUE)
+        return nextFrameIndex_++;
+
+    int64_t startTime = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    nextFrameIndex_ = av_rescale_q(pts - startTime, stream->time_base, av_inv_q(stream->r_frame_rate)) + 1;
+    return nextFrameIndex_ - 1;
+}
+
+void MovieSource::runDecoderLoop()
+{
+    while (!shouldStopDecoder_) {
+        if (!decodeNextFrame())
+            break;
+
+        int64_t index = frameIndexOfCurrentFrame();
+        if (index < seekTarget_)
+            continue;
+        if (index % decimation_ != 0)
+            continue;
+
+        // Convert directly into the pooled surface. The surface is XRGB8888, i.e. BGRA in memory.
+        UniqueSDLSurface surface(pool_->acquire());
+        uint8_t* data[4] = { static_cast<uint8_t*>(surface->pixels), NULL, NULL, NULL };
+        int linesize[4] = { surface->pitch, 0, 0, 0 };
+        sws_ = sws_getCachedContext(sws_,
+                                    width_, height_, codec_->pix_fmt,
+                                    width_, height_, PIX_FMT_BGRA,
+                                    SWS_BICUBIC, NULL, NULL, NULL);
+        sws_scale(sws_, frame_->data, frame_->linesize, 0, height_, data, linesize);
+
+        queue_->push(DecodedFrame { std::move(surface), index });
+    }
+
+    // An empty surface tells the end of the movie.
+    if (!shouldStopDecoder_)
+        queue_->push(DecodedFrame { emptyUniqueSDLSurface(), -1 });
+    decoderFinished_ = true;
+}
+
+UniqueSDLSurface MovieSource::getNextFrame()
+{
+    if (done_)
+        return emptyUniqueSDLSurface();
+    if (!decoderThread_.joinable() && !start())
+        return emptyUniqueSDLSurface();
+
+    DecodedFrame frame = queue_->take();
+    if (!frame.surface) {
+        done_ = true;
+        return emptyUniqueSDLSurface();
     }
+    frameIndex_ = frame.frameIndex;
 
     // Wait until next frame.
     Uint32 currentTime = SDL_GetTicks();
@@ -156,7 +277,7 @@ UniqueSDLSurface MovieSource::getNextFrame()
     }
     lastTaken_ = SDL_GetTicks();
 
-    return makeUniqueSDLSurface(SDL_ConvertSurface(surf_.get(), surf_->format, 0));
+    return std::move(frame.surface);
 }
 
 void MovieSource::init()
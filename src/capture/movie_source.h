@@ -4,7 +4,9 @@
 #include <stdint.h>
 
 #include <atomic>
+#include <memory>
 #include <string>
+#include <thread>
 
 #include <SDL.h>
 
@@ -13,9 +15,14 @@ extern "C" {
 #include <libswscale/swscale.h>
 }
 
+#include "base/blocking_queue.h"
+#include "capture/frame_buffer_pool.h"
 #include "capture/source.h"
 #include "gui/unique_sdl_surface.h"
 
+// MovieSource decodes a movie on its own decoder thread. The decoder thread reads
+// ahead a few frames and converts them into pooled surfaces, so that the caller
+// doesn't need to wait for decoding.
 class MovieSource : public Source {
 public:
     explicit MovieSource(const char* filename);
@@ -24,14 +31,42 @@ public:
 
     virtual ~MovieSource();
 
-    virtual UniqueSDLSurface getNextFrame();
+    // Starts the decoder thread. getNextFrame() calls this if it's not started yet.
+    virtual bool start() override;
+    virtual UniqueSDLSurface getNextFrame() override;
 
     void setFPS(int fps) { fps_ = fps; }
     void nextStep();
 
+    // Only the frames whose index is a multiple of |n| are converted and returned.
+    // The other frames are decoded but not converted.
+    // These setters should be called before the decoder thread starts.
+    void setDecimation(int n);
+    void setReadAhead(int numFrames);
+
+    // Seeks to the keyframe before the target, and decodes up to the target without
+    // converting the frames, so the next frame is exactly the target.
+    bool seekToFrame(int64_t frameIndex);
+    bool seekToTime(double seconds);
+
+    // The index of the frame returned by the last getNextFrame().
+    int64_t frameIndex() const { return frameIndex_; }
+
     static void init();
 
 private:
+    struct DecodedFrame {
+        UniqueSDLSurface surface;
+        int64_t frameIndex;
+    };
+
+    void runDecoderLoop();
+    // Returns true if the decoder thread was running.
+    bool stopDecoder();
+    // Decodes the next video frame into |frame_|. Returns false at the end of the movie.
+    bool decodeNextFrame();
+    int64_t frameIndexOfCurrentFrame();
+
     const char* filename_;
 
     int fps_ = 60;
@@ -42,13 +77,24 @@ private:
     AVFormatContext* format_;
     AVCodecContext* codec_;
     AVFrame* frame_;
-    AVFrame* frame_rgb_;
     int video_index_;
 
     AVPacket packet_;
     SwsContext* sws_;
 
-    UniqueSDLSurface surf_;
+    int decimation_ = 1;
+    int readAhead_ = 8;
+    // Frames before this index are skipped after seeking.
+    int64_t seekTarget_ = 0;
+    // Used when a decoded frame doesn't have its timestamp.
+    int64_t nextFrameIndex_ = 0;
+    int64_t frameIndex_ = -1;
+
+    std::unique_ptr<FrameBufferPool> pool_;
+    std::unique_ptr<base::BlockingQueue<DecodedFrame>> queue_;
+    std::thread decoderThread_;
+    std::atomic<bool> shouldStopDecoder_;
+    std::atomic<bool> decoderFinished_;
 };
 
 #endif  // CAPTURE_MOVIE_H_
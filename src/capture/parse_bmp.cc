@@ -1,7 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -11,6 +14,7 @@
 #include "capture/capture.h"
 #include "capture/color.h"
 #include "capture/ac_analyzer.h"
+#include "capture/image_batch_processor.h"
 #include "gui/bounding_box.h"
 #include "gui/main_window.h"
 #include "gui/unique_sdl_surface.h"
@@ -18,32 +22,54 @@
 
 using namespace std;
 
+DECLARE_int32(num_threads);
+
 int main(int argc, char* argv[])
 {
     google::ParseCommandLineFlags(&argc, &argv, true);
     google::InitGoogleLogging(argv[0]);
 
     if (argc < 2) {
-        fprintf(stderr, "Usage: %s <in-bmp>\n", argv[0]);
+        fprintf(stderr, "Usage: %s <in-bmp>...\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
     SDL_Init(SDL_INIT_VIDEO);
     atexit(SDL_Quit);
 
-    UniqueSDLSurface surf(makeUniqueSDLSurface(IMG_Load(argv[1])));
-    if (!surf) {
-        fprintf(stderr, "Failed to load %s!\n", argv[1]);
-        exit(EXIT_FAILURE);
-    }
+    // When a single image is given, the result is saved to output.bmp as before.
+    // Otherwise, the result of foo.bmp is saved to foo-output.bmp.
+    vector<string> files(argv + 1, argv + argc);
+    const bool single = files.size() == 1;
 
-    ACAnalyzer analyzer;
-    unique_ptr<AnalyzerResult> result(analyzer.analyze(surf.get(), nullptr, nullptr, nullptr, deque<unique_ptr<AnalyzerResult>>()));
+    ImageBatchProcessor processor(std::max(1, FLAGS_num_threads));
+    vector<string> results = processor.process(files, [single](ACAnalyzer* analyzer, const string& f, SDL_Surface* surf) {
+        if (!surf)
+            return string();
 
-    analyzer.drawWithAnalysisResult(surf.get());
-    SDL_SaveBMP(surf.get(), "output.bmp");
+        unique_ptr<AnalyzerResult> result(analyzer->analyze(surf, nullptr, nullptr, nullptr, deque<unique_ptr<AnalyzerResult>>()));
+        analyzer->drawWithAnalysisResult(surf);
 
-    cout << result->toString() << endl;
+        string output = "output.bmp";
+        if (!single) {
+            string::size_type pos = f.rfind('.');
+            output = (pos == string::npos ? f : f.substr(0, pos)) + "-output.bmp";
+        }
+        SDL_SaveBMP(surf, output.c_str());
+        return result->toString();
+    });
+
+    bool ok = true;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (results[i].empty()) {
+            fprintf(stderr, "Failed to load %s!\n", files[i].c_str());
+            ok = false;
+            continue;
+        }
+        if (!single)
+            cout << files[i] << endl;
+        cout << results[i] << endl;
+    }
 
-    return 0;
+    return ok ? 0 : EXIT_FAILURE;
 }
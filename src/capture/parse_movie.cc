@@ -19,6 +19,8 @@
 
 DEFINE_bool(draw_result, true, "draw analyzer result");
 DEFINE_int32(fps, 60, "FPS. When 0, hitting space will go next step.");
+DEFINE_double(start_sec, 0, "The position [s] in the movie to start parsing.");
+DEFINE_int32(decimation, 1, "Parse only every N-th frame.");
 
 int main(int argc, char* argv[])
 {
@@ -41,6 +43,9 @@ int main(int argc, char* argv[])
         exit(EXIT_FAILURE);
     }
     source.setFPS(FLAGS_fps);
+    source.setDecimation(FLAGS_decimation);
+    if (FLAGS_start_sec > 0)
+        CHECK(source.seekToTime(FLAGS_start_sec));
 
     ACAnalyzer analyzer;
     Capture capture(&source, &analyzer);
@@ -7,6 +7,8 @@
 
 #include <SDL_image.h>
 
+#include "base/time.h"
+
 DEFINE_string(save_img_dir, "/tmp", "");
 
 using namespace std;
@@ -38,13 +40,22 @@ Source::Source() :
     ok_(false),
     done_(false),
     width_(-1),
-    height_(-1)
+    height_(-1),
+    numDeliveredFrames_(0),
+    numDroppedFrames_(0),
+    lastFrameTime_(-1)
 {
 }
 
 UniqueSDLSurface Source::nextFrame()
 {
+    lastFrameTime_ = -1;
     UniqueSDLSurface surface = getNextFrame();
+    if (surface.get()) {
+        ++numDeliveredFrames_;
+        if (lastFrameTime_ < 0)
+            lastFrameTime_ = currentTime();
+    }
 
     if (savesScreenShot_ && surface.get()) {
         saveScreenShot(surface.get());
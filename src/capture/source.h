@@ -1,6 +1,9 @@
 #ifndef CAPTURE_SOURCE_H_
 #define CAPTURE_SOURCE_H_
 
+#include <atomic>
+#include <cstdint>
+
 #include <SDL.h>
 #include "gui/unique_sdl_surface.h"
 
@@ -26,16 +29,41 @@ public:
 
     void setSavesScreenShot(bool b) { savesScreenShot_ = b; }
 
+    // The number of frames returned from nextFrame().
+    std::int64_t numDeliveredFrames() const { return numDeliveredFrames_; }
+    // The number of frames the source has dropped because the consumer was too slow.
+    std::int64_t numDroppedFrames() const { return numDroppedFrames_; }
+
+    // The time [s] when the frame last returned from nextFrame() was produced,
+    // e.g. when the capture device delivered it. Negative if no frame was returned.
+    double lastFrameTime() const { return lastFrameTime_; }
+
 protected:
+    // A frame produced on the source's own thread, and the time [s] it was produced.
+    struct TimedFrame {
+        UniqueSDLSurface surface;
+        double time;
+    };
+
     Source();
 
     virtual UniqueSDLSurface getNextFrame() = 0;
 
+    void addDroppedFrames(int n) { numDroppedFrames_ += n; }
+    // A source that produces frames before getNextFrame() is called (e.g. on a capture
+    // thread) calls this in getNextFrame() with the time the returned frame was produced.
+    // Otherwise, the frame is stamped when getNextFrame() returns it.
+    void setFrameTime(double t) { lastFrameTime_ = t; }
+
     bool ok_;
     bool done_;
     bool savesScreenShot_ = false;
     int width_;
     int height_;
+
+    std::atomic<std::int64_t> numDeliveredFrames_;
+    std::atomic<std::int64_t> numDroppedFrames_;
+    double lastFrameTime_;
 };
 
 #endif  // CAPTURE_SOURCE_H_
@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include <gflags/gflags.h>
 #include <glog/logging.h>
@@ -12,6 +15,7 @@
 #include "capture/capture.h"
 #include "capture/color.h"
 #include "capture/ac_analyzer.h"
+#include "capture/image_batch_processor.h"
 #include "gui/bounding_box.h"
 #include "gui/main_window.h"
 #include "gui/unique_sdl_surface.h"
@@ -19,42 +23,29 @@
 
 using namespace std;
 
-int main(int argc, char* argv[])
-{
-    google::ParseCommandLineFlags(&argc, &argv, true);
-    google::InitGoogleLogging(argv[0]);
+DECLARE_int32(num_threads);
 
-    if (argc < 2) {
-        fprintf(stderr, "Usage: %s <in-bmp>\n", argv[0]);
-        exit(EXIT_FAILURE);
-    }
-
-    SDL_Init(SDL_INIT_VIDEO);
-    atexit(SDL_Quit);
-
-    UniqueSDLSurface surf(makeUniqueSDLSurface(IMG_Load(argv[1])));
-    if (!surf) {
-        fprintf(stderr, "Failed to load %s!\n", argv[1]);
-        exit(EXIT_FAILURE);
-    }
-
-    // TODO(mayah): Since bounding box is initialized in ACAnalyzer, we need to use this here.
-    // This must be wrong.
-    ACAnalyzer analyzer;
+namespace {
 
+// Splits the field of |surf| into boxes, and saves each box as <prefix><color>-<x>-<y>.bmp.
+// Returns the recognized field.
+string splitImage(ACAnalyzer* analyzer, SDL_Surface* surf, const string& prefix)
+{
     const int WIDTH = 32;
     const int HEIGHT = 32;
 
+    ostringstream ss;
     for (int y = 12; y >= 1; --y) {
         for (int x = 1; x <= 6; ++x) {
             Box b = BoundingBox::boxForAnalysis(0, x, y);
-            RealColor rc = analyzer.analyzeBox(surf.get(), b);
+            RealColor rc = analyzer->analyzeBox(surf, b);
 
             const SDL_Rect rect = b.toSDLRect();
             UniqueSDLSurface dest(makeUniqueSDLSurface(SDL_CreateRGBSurface(0, WIDTH, HEIGHT, 32, 0, 0, 0, 0)));
-            SDL_BlitSurface(surf.get(), &rect, dest.get(), nullptr);
+            SDL_BlitSurface(surf, &rect, dest.get(), nullptr);
 
             ostringstream filename;
+            filename << prefix;
             switch (rc) {
             case RealColor::RC_EMPTY:  filename << 'E'; break;
             case RealColor::RC_WALL:   filename << 'W'; break;
@@ -68,10 +59,60 @@ int main(int argc, char* argv[])
             filename << "-" << x << "-" << y << ".bmp";
             SDL_SaveBMP(dest.get(), filename.str().c_str());
 
-            cout << toChar(rc);
+            ss << toChar(rc);
+        }
+        ss << endl;
+    }
+
+    return ss.str();
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <in-bmp>...\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    SDL_Init(SDL_INIT_VIDEO);
+    atexit(SDL_Quit);
+
+    // When several images are given, the boxes of foo.bmp are saved as foo-<color>-<x>-<y>.bmp
+    // so that they don't overwrite each other.
+    vector<string> files(argv + 1, argv + argc);
+    const bool single = files.size() == 1;
+
+    // TODO(mayah): Since bounding box is initialized in ACAnalyzer, we need to use this here.
+    // This must be wrong.
+    ImageBatchProcessor processor(std::max(1, FLAGS_num_threads));
+    vector<string> results = processor.process(files, [single](ACAnalyzer* analyzer, const string& f, SDL_Surface* surf) {
+        if (!surf)
+            return string();
+
+        string prefix;
+        if (!single) {
+            string::size_type pos = f.rfind('.');
+            prefix = (pos == string::npos ? f : f.substr(0, pos)) + "-";
+        }
+        return splitImage(analyzer, surf, prefix);
+    });
+
+    bool ok = true;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (results[i].empty()) {
+            fprintf(stderr, "Failed to load %s!\n", files[i].c_str());
+            ok = false;
+            continue;
         }
-        cout << endl;
+        if (!single)
+            cout << files[i] << endl;
+        cout << results[i];
     }
 
-    return 0;
+    return ok ? 0 : EXIT_FAILURE;
 }
@@ -20,6 +20,9 @@
 
 using namespace std;
 
+DEFINE_int64(start_frame, 0, "The first frame to split.");
+DEFINE_int32(decimation, 1, "Split only every N-th frame.");
+
 int main(int argc, char* argv[])
 {
     google::ParseCommandLineFlags(&argc, &argv, true);
@@ -41,6 +44,9 @@ int main(int argc, char* argv[])
         exit(EXIT_FAILURE);
     }
     source.setFPS(0);
+    source.setDecimation(FLAGS_decimation);
+    if (FLAGS_start_frame > 0)
+        CHECK(source.seekToFrame(FLAGS_start_frame));
 
     // TODO(mayah): Since bounding box is initialized in ACAnalyzer, we need to use this here.
     // This must be wrong.
@@ -5,6 +5,7 @@
 #include <glog/logging.h>
 #include <gflags/gflags.h>
 
+#include "base/time.h"
 #include "capture/driver/syntek.h"
 
 #include <iostream>
@@ -17,7 +18,16 @@ DEFINE_int32(capture_offset_y, 8, "The y offset to crop captured image.");
 DEFINE_int32(capture_width, 640, "The cropped captured image width.");
 DEFINE_int32(capture_height, 224, "The cropped captured image height.");
 
+namespace {
+const int NUM_RAW_BUFFERS = 4;
+// Consumers keep a few previous frames for analysis, so we need some more.
+const int NUM_FRAME_BUFFERS = 8;
+}
+
 SyntekSource::SyntekSource() :
+    rawPool_(NUM_RAW_BUFFERS, 720, 240),
+    framePool_(NUM_FRAME_BUFFERS, 320, 224),
+    surfaces_queue_(NUM_RAW_BUFFERS),
     discarded_(0)
 {
     width_ = 320;
@@ -44,6 +54,7 @@ bool SyntekSource::start()
                            bool /*isHigh*/,
                            int bytesPerRow,
                            int numRowsPerBuffer) {
+        double receivedTime = currentTime();
         lock_guard<mutex> lock(mu_);
 
         if (discarded_ < FLAGS_initial_discards) {
@@ -51,7 +62,12 @@ bool SyntekSource::start()
             return;
         }
 
-        UniqueSDLSurface surf(makeUniqueSDLSurface(SDL_CreateRGBSurface(0, 720, 240, 32, 0, 0, 0, 0)));
+        UniqueSDLSurface surf(rawPool_.tryAcquire());
+        if (!surf) {
+            // The consumer is too slow. Drop this frame instead of allocating a new buffer.
+            addDroppedFrames(1);
+            return;
+        }
 
         int* pixels = static_cast<int*>(surf->pixels);
 
@@ -69,7 +85,7 @@ bool SyntekSource::start()
             }
         }
 
-        surfaces_queue_.push(std::move(surf));
+        surfaces_queue_.push(TimedFrame { std::move(surf), receivedTime });
         // cond_.notify_one();
     };
 
@@ -85,15 +101,17 @@ UniqueSDLSurface SyntekSource::getNextFrame()
 {
     while (surfaces_queue_.size() >= 2) {
         (void)surfaces_queue_.take();
+        addDroppedFrames(1);
     }
 
-    UniqueSDLSurface raw_surf = surfaces_queue_.take();
-    UniqueSDLSurface surf(makeUniqueSDLSurface(SDL_CreateRGBSurface(0, 320, 224, 32, 0, 0, 0, 0)));
+    TimedFrame raw_frame = surfaces_queue_.take();
+    setFrameTime(raw_frame.time);
+    UniqueSDLSurface surf(framePool_.acquire());
     // Convert 720x240 to 640x224.
     const SDL_Rect srcRect {
         FLAGS_capture_offset_x, FLAGS_capture_offset_y,
         FLAGS_capture_width, FLAGS_capture_height };
-    SDL_BlitScaled(raw_surf.get(), &srcRect, surf.get(), nullptr);
+    SDL_BlitScaled(raw_frame.surface.get(), &srcRect, surf.get(), nullptr);
     return surf;
 }
 
@@ -11,6 +11,7 @@
 #include "base/base.h"
 #include "base/blocking_queue.h"
 #include "capture/capture_source.h"
+#include "capture/frame_buffer_pool.h"
 #include "capture/source.h"
 #include "gui/unique_sdl_surface.h"
 
@@ -31,7 +32,12 @@ private:
     std::thread th_;
     std::mutex mu_;
 
-    base::InfiniteBlockingQueue<UniqueSDLSurface> surfaces_queue_;
+    // Raw 720x240 frames written by the driver thread.
+    FrameBufferPool rawPool_;
+    // Cropped 320x224 frames handed to the consumer.
+    FrameBufferPool framePool_;
+    // Bounded by |rawPool_|, so the driver thread never blocks on this.
+    base::BlockingQueue<TimedFrame> surfaces_queue_;
 
     int discarded_;
 
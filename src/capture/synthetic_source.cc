@@ -0,0 +1,82 @@
+#include "capture/synthetic_source.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include <glog/logging.h>
+
+#include "base/time.h"
+
+using namespace std;
+
+SyntheticSource::SyntheticSource(int width, int height, int numFrames, int numBuffers) :
+    numFrames_(numFrames),
+    pool_(numBuffers, width, height),
+    queue_(numBuffers),
+    producerDone_(false),
+    shouldStop_(false)
+{
+    width_ = width;
+    height_ = height;
+    ok_ = true;
+}
+
+SyntheticSource::~SyntheticSource()
+{
+    shouldStop_ = true;
+    if (th_.joinable())
+        th_.join();
+}
+
+bool SyntheticSource::start()
+{
+    CHECK(!th_.joinable());
+    th_ = thread([this]() {
+        runLoop();
+    });
+    return true;
+}
+
+// static
+int SyntheticSource::frameIdOf(const SDL_Surface* surface)
+{
+    return static_cast<const int32_t*>(surface->pixels)[0];
+}
+
+UniqueSDLSurface SyntheticSource::getNextFrame()
+{
+    // Take the latest frame like SyntekSource does.
+    while (queue_.size() >= 2) {
+        (void)queue_.take();
+        addDroppedFrames(1);
+    }
+
+    TimedFrame frame;
+    while (!queue_.takeWithTimeout(chrono::steady_clock::now() + chrono::milliseconds(10), &frame)) {
+        if (producerDone_ && queue_.empty()) {
+            end();
+            return emptyUniqueSDLSurface();
+        }
+    }
+
+    setFrameTime(frame.time);
+    return std::move(frame.surface);
+}
+
+void SyntheticSource::runLoop()
+{
+    for (int frameId = 0; frameId < numFrames_ && !shouldStop_; ++frameId) {
+        UniqueSDLSurface surface(pool_.tryAcquire());
+        if (!surface) {
+            addDroppedFrames(1);
+            continue;
+        }
+
+        int32_t* pixels = static_cast<int32_t*>(surface->pixels);
+        fill(pixels, pixels + surface->pitch / 4 * surface->h, frameId);
+        queue_.push(TimedFrame { std::move(surface), currentTime() });
+    }
+
+    producerDone_ = true;
+}
@@ -0,0 +1,40 @@
+#ifndef CAPTURE_SYNTHETIC_SOURCE_H_
+#define CAPTURE_SYNTHETIC_SOURCE_H_
+
+#include <atomic>
+#include <thread>
+
+#include "base/blocking_queue.h"
+#include "capture/frame_buffer_pool.h"
+#include "capture/source.h"
+
+// SyntheticSource is a stand-in for capture hardware.
+// It produces |numFrames| frames from its own thread in the same way as SyntekSource,
+// so frame recycling and dropping can be tested without a capture device.
+// The pixels of the i-th frame (0-origin) are filled with i.
+class SyntheticSource : public Source {
+public:
+    SyntheticSource(int width, int height, int numFrames, int numBuffers = 4);
+    virtual ~SyntheticSource();
+
+    virtual bool start() override;
+
+    // Returns the frame id written in |surface|.
+    static int frameIdOf(const SDL_Surface* surface);
+
+protected:
+    virtual UniqueSDLSurface getNextFrame() override;
+
+private:
+    void runLoop();
+
+    const int numFrames_;
+    FrameBufferPool pool_;
+    base::BlockingQueue<TimedFrame> queue_;
+
+    std::thread th_;
+    std::atomic<bool> producerDone_;
+    std::atomic<bool> shouldStop_;
+};
+
+#endif // CAPTURE_SYNTHETIC_SOURCE_H_
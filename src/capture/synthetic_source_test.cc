@@ -0,0 +1,105 @@
+#include "capture/synthetic_source.h"
+
+#include <chrono>
+#include <deque>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/time.h"
+
+using namespace std;
+
+TEST(SyntheticSourceTest, deliverAllFrames)
+{
+    const int NUM_FRAMES = 100;
+    SyntheticSource source(16, 16, NUM_FRAMES);
+    ASSERT_TRUE(source.start());
+
+    int lastFrameId = -1;
+    double lastFrameTime = -1;
+    while (true) {
+        UniqueSDLSurface surface(source.nextFrame());
+        if (!surface.get())
+            break;
+
+        int frameId = SyntheticSource::frameIdOf(surface.get());
+        EXPECT_LT(lastFrameId, frameId);
+        lastFrameId = frameId;
+
+        EXPECT_LE(lastFrameTime, source.lastFrameTime());
+        EXPECT_LE(source.lastFrameTime(), currentTime());
+        lastFrameTime = source.lastFrameTime();
+    }
+    EXPECT_LT(source.lastFrameTime(), 0);
+
+    EXPECT_TRUE(source.done());
+    EXPECT_EQ(NUM_FRAMES, source.numDeliveredFrames() + source.numDroppedFrames());
+}
+
+TEST(SyntheticSourceTest, dropFramesUnderBackpressure)
+{
+    const int NUM_FRAMES = 100;
+    const int NUM_BUFFERS = 4;
+    SyntheticSource source(16, 16, NUM_FRAMES, NUM_BUFFERS);
+    ASSERT_TRUE(source.start());
+
+    // The consumer keeps all the frames, so the pool runs out and the rest are dropped.
+    vector<UniqueSDLSurface> holding;
+    set<SDL_Surface*> surfaces;
+    while (true) {
+        UniqueSDLSurface surface(source.nextFrame());
+        if (!surface.get())
+            break;
+        surfaces.insert(surface.get());
+        holding.push_back(std::move(surface));
+        ASSERT_LE(holding.size(), static_cast<size_t>(NUM_BUFFERS));
+    }
+
+    // The frames are in the preallocated buffers only.
+    EXPECT_EQ(holding.size(), surfaces.size());
+    EXPECT_GT(source.numDroppedFrames(), 0);
+    EXPECT_GE(source.numDroppedFrames(), NUM_FRAMES - NUM_BUFFERS);
+    EXPECT_EQ(NUM_FRAMES, source.numDeliveredFrames() + source.numDroppedFrames());
+}
+
+TEST(SyntheticSourceTest, recycleFramesUnderBackpressure)
+{
+    const int NUM_FRAMES = 100;
+    const int NUM_BUFFERS = 4;
+    SyntheticSource source(16, 16, NUM_FRAMES, NUM_BUFFERS);
+    ASSERT_TRUE(source.start());
+
+    // The consumer keeps the previous frames like Capture does.
+    deque<UniqueSDLSurface> holding;
+    set<SDL_Surface*> surfaces;
+    while (true) {
+        UniqueSDLSurface surface(source.nextFrame());
+        if (!surface.get())
+            break;
+        surfaces.insert(surface.get());
+        holding.push_back(std::move(surface));
+        while (holding.size() >= NUM_BUFFERS)
+            holding.pop_front();
+    }
+
+    // The released buffers are reused instead of allocating new ones.
+    EXPECT_LE(surfaces.size(), static_cast<size_t>(NUM_BUFFERS));
+    EXPECT_EQ(NUM_FRAMES, source.numDeliveredFrames() + source.numDroppedFrames());
+}
+
+TEST(SyntheticSourceTest, stampFramesWhenProduced)
+{
+    SyntheticSource source(16, 16, 1);
+    ASSERT_TRUE(source.start());
+
+    // The frame waits in the source while the consumer is busy.
+    this_thread::sleep_for(chrono::milliseconds(20));
+    double takenTime = currentTime();
+    UniqueSDLSurface surface(source.nextFrame());
+    ASSERT_TRUE(surface.get());
+    EXPECT_LE(0, source.lastFrameTime());
+    EXPECT_LT(source.lastFrameTime(), takenTime);
+}
@@ -13,6 +13,8 @@
 #include <libv4l2.h>
 #include <linux/videodev2.h>
 
+#include <glog/logging.h>
+
 using namespace std;
 
 namespace {
@@ -107,6 +109,14 @@ void showCurrentAudio(int fd)
 
 }  // anonymous namespace
 
+VidDevSource::Buffer::~Buffer()
+{
+    if (surface)
+        SDL_FreeSurface(surface);
+    if (start && start != MAP_FAILED)
+        munmap(start, length);
+}
+
 VidDevSource::VidDevSource(const string& dev) :
     dev_(dev)
 {
@@ -165,16 +175,18 @@ VidDevSource::~VidDevSource()
 
 void VidDevSource::quit()
 {
+    lock_guard<mutex> lock(mu_);
+    ++generation_;
+    hasSequence_ = false;
+
     int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     if (v4l2_ioctl(fd_, VIDIOC_STREAMOFF, &type) < 0) {
         perror("v4l2_ioctl VIDIOC_STREAMOFF");
         exit(EXIT_FAILURE);
     }
     v4l2_close(fd_);
-    for (size_t i = 0; i < buf_cnt_; i++) {
-        munmap(buffers_[i].start, buffers_[i].length);
-    }
-    free(buffers_);
+    // Buffers still used by the consumer are unmapped when they are released.
+    buffers_.clear();
 }
 
 void VidDevSource::initBuffers()
@@ -201,9 +213,7 @@ void VidDevSource::initBuffers()
         exit(EXIT_FAILURE);
     }
 
-    buf_cnt_ = reqbuf.count;
-    buffers_ = (Buffer*)calloc(reqbuf.count, sizeof(*buffers_));
-    assert(buffers_ != NULL);
+    buffers_.clear();
 
     fprintf(stderr, "mmap:");
     for (size_t i = 0; i < reqbuf.count; i++) {
@@ -217,26 +227,26 @@ void VidDevSource::initBuffers()
             exit(EXIT_FAILURE);
         }
 
-        buffers_[i].length = buffer.length; /* remember for munmap() */
-        buffers_[i].start = (char*)mmap(NULL, buffer.length,
-                                        PROT_READ | PROT_WRITE, /* recommended */
-                                        MAP_SHARED,             /* recommended */
-                                        fd_, buffer.m.offset);
-        // This document says rmask and bmask should be swapped, but hmm?
-        // http://linuxtv.org/downloads/v4l-dvb-apis/packed-rgb.html
-        buffers_[i].surface = SDL_CreateRGBSurfaceFrom(buffers_[i].start,
-                                                       width_, height_, 16,
-                                                       width_ * 2,
-                                                       31 << 11, 63 << 5, 31, 0);
-        assert(buffers_[i].surface);
-
-        fprintf(stderr, " %lu:%p+%lu", i, buffers_[i].start, buffers_[i].length);
-        if (MAP_FAILED == buffers_[i].start) {
-            /* If you do not exit here you should unmap() and free()
-               the buffers mapped so far. */
+        shared_ptr<Buffer> buf(new Buffer);
+        buf->length = buffer.length; /* remember for munmap() */
+        buf->start = (char*)mmap(NULL, buffer.length,
+                                 PROT_READ | PROT_WRITE, /* recommended */
+                                 MAP_SHARED,             /* recommended */
+                                 fd_, buffer.m.offset);
+        fprintf(stderr, " %lu:%p+%lu", i, buf->start, buf->length);
+        if (MAP_FAILED == buf->start) {
             perror("mmap");
             exit(EXIT_FAILURE);
         }
+
+        // This document says rmask and bmask should be swapped, but hmm?
+        // http://linuxtv.org/downloads/v4l-dvb-apis/packed-rgb.html
+        buf->surface = SDL_CreateRGBSurfaceFrom(buf->start,
+                                                width_, height_, 16,
+                                                width_ * 2,
+                                                31 << 11, 63 << 5, 31, 0);
+        assert(buf->surface);
+        buffers_.push_back(std::move(buf));
     }
     fprintf(stderr, "\n");
 
@@ -296,16 +306,45 @@ UniqueSDLSurface VidDevSource::getNextFrame()
         exit(EXIT_FAILURE);
     }
 
-    const Buffer& buf = buffers_[buffer.index];
 #if 0
     static int cnt = 0;
     fprintf(stderr, "%d %d\n", cnt++, buffer.index);
 #endif
 
-    if (v4l2_ioctl(fd_, VIDIOC_QBUF, &buffer) < 0) {
-        perror("VIDIOC_QBUF");
-        exit(EXIT_FAILURE);
+    int generation;
+    {
+        lock_guard<mutex> lock(mu_);
+        // The driver skips sequence numbers when it had no queued buffer to fill.
+        if (hasSequence_ && buffer.sequence > lastSequence_ + 1)
+            addDroppedFrames(buffer.sequence - lastSequence_ - 1);
+        hasSequence_ = true;
+        lastSequence_ = buffer.sequence;
+        generation = generation_;
     }
 
-    return makeUniqueSDLSurface(buf.surface);
+    // The surface refers to the mmapped buffer directly. The buffer is given back
+    // to the driver when the consumer releases the surface.
+    shared_ptr<Buffer> buf = buffers_[buffer.index];
+    unsigned int index = buffer.index;
+    // |buf| is captured to keep the buffer mapped while the surface is used.
+    return UniqueSDLSurface(buf->surface, [this, buf, index, generation](SDL_Surface*) {
+        requeue(index, generation);
+    });
+}
+
+void VidDevSource::requeue(unsigned int index, int generation)
+{
+    lock_guard<mutex> lock(mu_);
+    if (generation != generation_)
+        return;
+
+    struct v4l2_buffer buffer;
+    memset(&buffer, 0, sizeof(buffer));
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    buffer.index = index;
+
+    if (v4l2_ioctl(fd_, VIDIOC_QBUF, &buffer) < 0) {
+        PLOG(ERROR) << "VIDIOC_QBUF";
+    }
 }
@@ -5,12 +5,17 @@
 # error "USE_V4L2 must be defined to include viddev_source.h"
 #endif
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <SDL.h>
 
 #include "capture/source.h"
 
+// VidDevSource captures frames with V4L2 mmap streaming. The returned frames are
+// the mmapped buffers themselves, so they must be released before VidDevSource is destructed.
 class VidDevSource : public Source {
 public:
     explicit VidDevSource(const std::string& dev);
@@ -19,10 +24,15 @@ public:
     virtual UniqueSDLSurface getNextFrame() override;
 
 private:
+    // A buffer mmapped from the device. A surface returned from getNextFrame() refers to
+    // the buffer directly, so the buffer is alive until the surface is released even if
+    // the device is re-initialized.
     struct Buffer {
-        char* start;
-        size_t length;
-        SDL_Surface* surface;
+        ~Buffer();
+
+        char* start = nullptr;
+        size_t length = 0;
+        SDL_Surface* surface = nullptr;
     };
 
     void init();
@@ -30,10 +40,18 @@ private:
 
     void quit();
 
+    // Gives the buffer back to the driver.
+    void requeue(unsigned int index, int generation);
+
     const std::string dev_;
     int fd_;
-    Buffer* buffers_;
-    size_t buf_cnt_;
+    std::vector<std::shared_ptr<Buffer>> buffers_;
+
+    std::mutex mu_;
+    // Incremented when the device is closed, so that buffers of the old device are not queued.
+    int generation_ = 0;
+    bool hasSequence_ = false;
+    unsigned int lastSequence_ = 0;
 };
 
 #endif  // CAPTURE_VIDDEV_H_
@@ -14,6 +14,7 @@
 #include "core/rensa_tracker.h"
 #include "core/score.h"
 
+class PackedField;
 class PlainField;
 struct Position;
 
@@ -100,6 +101,8 @@ public:
 #endif
 
 private:
+    friend class PackedField;
+
     BitField escapeInvisible();
     void recoverInvisible(const BitField&);
 
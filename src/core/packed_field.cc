@@ -0,0 +1,105 @@
+#include "core/packed_field.h"
+
+#include <smmintrin.h>
+
+#include "base/bmi.h"
+#include "core/plain_field.h"
+
+using namespace std;
+
+namespace {
+
+// The rows 1-14 of the columns 1-3 in the lower 64 bits of FieldBits,
+// and the ones of the columns 4-6 in the upper 64 bits.
+const uint64_t LOW_COLUMNS_MASK = 0x7FFE7FFE7FFE0000ULL;
+const uint64_t HIGH_COLUMNS_MASK = 0x00007FFE7FFE7FFEULL;
+
+const int PLANE_BITS = 42;
+const uint64_t PLANE_MASK = (1ULL << PLANE_BITS) - 1;
+
+// Packs 3 planes of 42 bits into 2 words.
+inline void packPlanes(const uint64_t planes[3], uint64_t* w)
+{
+    w[0] = planes[0] | (planes[1] << PLANE_BITS);
+    w[1] = (planes[1] >> (64 - PLANE_BITS)) | (planes[2] << (2 * PLANE_BITS - 64));
+}
+
+inline uint64_t unpackPlane(const uint64_t* w, int i)
+{
+    switch (i) {
+    case 0:
+        return w[0] & PLANE_MASK;
+    case 1:
+        return ((w[0] >> PLANE_BITS) | (w[1] << (64 - PLANE_BITS))) & PLANE_MASK;
+    case 2:
+        return (w[1] >> (2 * PLANE_BITS - 64)) & PLANE_MASK;
+    }
+    return 0;
+}
+
+} // anonymous namespace
+
+PackedField::PackedField(const BitField& bf)
+{
+    uint64_t lowPlanes[3];
+    uint64_t highPlanes[3];
+    for (int i = 0; i < 3; ++i) {
+        const __m128i& m = bf.m_[i].xmm();
+        lowPlanes[i] = bmi::extractBits(_mm_cvtsi128_si64(m), LOW_COLUMNS_MASK);
+        highPlanes[i] = bmi::extractBits(_mm_extract_epi64(m, 1), HIGH_COLUMNS_MASK);
+    }
+
+    packPlanes(lowPlanes, data_);
+    packPlanes(highPlanes, data_ + 2);
+}
+
+PackedField::PackedField(const PlainField& pf) :
+    PackedField(BitField(pf))
+{
+}
+
+BitField PackedField::toBitField() const
+{
+    // BitField() has the walls.
+    BitField bf;
+    for (int i = 0; i < 3; ++i) {
+        uint64_t low = bmi::depositBits(unpackPlane(data_, i), LOW_COLUMNS_MASK);
+        uint64_t high = bmi::depositBits(unpackPlane(data_ + 2, i), HIGH_COLUMNS_MASK);
+        bf.m_[i].setAll(FieldBits(_mm_set_epi64x(high, low)));
+    }
+    return bf;
+}
+
+PlainField PackedField::toPlainField() const
+{
+    PlainField pf;
+    for (int x = 1; x <= 6; ++x) {
+        for (int y = 1; y <= 14; ++y)
+            pf.setColor(x, y, color(x, y));
+    }
+    return pf;
+}
+
+PuyoColor PackedField::color(int x, int y) const
+{
+    DCHECK(1 <= x && x <= 6 && 1 <= y && y <= 14) << x << ' ' << y;
+
+    const uint64_t* w = x <= 3 ? data_ : data_ + 2;
+    int index = ((x - 1) % 3) * 14 + (y - 1);
+
+    int c = 0;
+    for (int i = 0; i < 3; ++i) {
+        int pos = i * PLANE_BITS + index;
+        uint64_t bit = pos < 64 ? (w[0] >> pos) : (w[1] >> (pos - 64));
+        c |= static_cast<int>(bit & 1) << i;
+    }
+    return static_cast<PuyoColor>(c);
+}
+
+uint64_t PackedField::hash() const
+{
+    uint64_t h = 0;
+    for (int i = 0; i < 4; ++i)
+        h = (h ^ data_[i]) * 0x9E3779B97F4A7C15ULL;
+    return h;
+}
@@ -0,0 +1,49 @@
+#ifndef CORE_PACKED_FIELD_H_
+#define CORE_PACKED_FIELD_H_
+
+#include <cstdint>
+
+#include "core/bit_field.h"
+#include "core/core_field.h"
+#include "core/puyo_color.h"
+
+class PlainField;
+
+// PackedField is a compact field to store many fields, e.g. the states of a beam search,
+// transposition tables, or replays. Each cell (1 <= x <= 6, 1 <= y <= 14) has 3 bits of
+// PuyoColor, so a field is 252 bits in 32 bytes.
+// A CoreField is 80 bytes, and a PlainField is 128 bytes.
+//
+// The 3 bit planes of BitField are extracted with PEXT, and deposited back with PDEP.
+// A PackedField can't be simulated. Convert it to BitField or CoreField.
+class PackedField {
+public:
+    PackedField() : data_ {} {}
+    explicit PackedField(const BitField&);
+    explicit PackedField(const CoreField& cf) : PackedField(cf.bitField()) {}
+    explicit PackedField(const PlainField&);
+
+    BitField toBitField() const;
+    CoreField toCoreField() const { return CoreField(toBitField()); }
+    PlainField toPlainField() const;
+
+    PuyoColor color(int x, int y) const;
+
+    std::uint64_t hash() const;
+
+    friend bool operator==(const PackedField& lhs, const PackedField& rhs)
+    {
+        return lhs.data_[0] == rhs.data_[0] && lhs.data_[1] == rhs.data_[1] &&
+            lhs.data_[2] == rhs.data_[2] && lhs.data_[3] == rhs.data_[3];
+    }
+    friend bool operator!=(const PackedField& lhs, const PackedField& rhs) { return !(lhs == rhs); }
+
+private:
+    // data_[0] and data_[1] have the columns 1-3, and data_[2] and data_[3] have the columns 4-6.
+    // Each pair has 3 planes of 42 bits (3 columns x 14 rows).
+    std::uint64_t data_[4];
+};
+
+static_assert(sizeof(PackedField) == 32, "PackedField should be 32 bytes");
+
+#endif // CORE_PACKED_FIELD_H_
@@ -0,0 +1,94 @@
+#include "core/packed_field.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/time_stamp_counter.h"
+#include "core/core_field.h"
+#include "core/plain_field.h"
+
+using namespace std;
+
+namespace {
+
+const int NUM_FIELDS = 1000000;
+
+// Fields in the middle of a game: each column has 0-12 random puyos.
+vector<CoreField> makeFields(int n)
+{
+    mt19937 mt(1);
+    const PuyoColor colors[] = { PuyoColor::RED, PuyoColor::BLUE, PuyoColor::YELLOW, PuyoColor::GREEN, PuyoColor::OJAMA };
+
+    vector<CoreField> fields(n);
+    for (auto& field : fields) {
+        PlainField pf;
+        for (int x = 1; x <= 6; ++x) {
+            int height = mt() % 13;
+            for (int y = 1; y <= height; ++y)
+                pf.setColor(x, y, colors[mt() % 5]);
+        }
+        field = CoreField(pf);
+    }
+    return fields;
+}
+
+} // namespace
+
+TEST(PackedFieldPerformanceTest, memory)
+{
+    cout << "bytes per 1M states:" << endl
+         << "  PlainField:  " << sizeof(PlainField) * NUM_FIELDS << endl
+         << "  CoreField:   " << sizeof(CoreField) * NUM_FIELDS << endl
+         << "  BitField:    " << sizeof(BitField) * NUM_FIELDS << endl
+         << "  PackedField: " << sizeof(PackedField) * NUM_FIELDS << endl;
+}
+
+TEST(PackedFieldPerformanceTest, fromCoreField)
+{
+    const vector<CoreField> fields = makeFields(NUM_FIELDS);
+    vector<PackedField> packed(fields.size());
+
+    TimeStampCounterData tsc;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        ScopedTimeStampCounter stsc(&tsc);
+        packed[i] = PackedField(fields[i]);
+    }
+    tsc.showStatistics();
+}
+
+TEST(PackedFieldPerformanceTest, toCoreField)
+{
+    const vector<CoreField> fields = makeFields(NUM_FIELDS);
+    vector<PackedField> packed;
+    packed.reserve(fields.size());
+    for (const auto& field : fields)
+        packed.emplace_back(field);
+
+    TimeStampCounterData tsc;
+    for (size_t i = 0; i < packed.size(); ++i) {
+        ScopedTimeStampCounter stsc(&tsc);
+        CoreField cf(packed[i].toCoreField());
+        EXPECT_EQ(fields[i].height(3), cf.height(3));
+    }
+    tsc.showStatistics();
+}
+
+TEST(PackedFieldPerformanceTest, toBitField)
+{
+    const vector<CoreField> fields = makeFields(NUM_FIELDS);
+    vector<PackedField> packed;
+    packed.reserve(fields.size());
+    for (const auto& field : fields)
+        packed.emplace_back(field);
+
+    TimeStampCounterData tsc;
+    for (size_t i = 0; i < packed.size(); ++i) {
+        ScopedTimeStampCounter stsc(&tsc);
+        BitField bf(packed[i].toBitField());
+        EXPECT_TRUE(bf == fields[i].bitField());
+    }
+    tsc.showStatistics();
+}
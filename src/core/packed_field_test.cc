@@ -0,0 +1,110 @@
+#include "core/packed_field.h"
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "core/plain_field.h"
+
+using namespace std;
+
+namespace {
+
+// A field having all the colors in all the columns, and the 14th row.
+const char* const FULL_FIELD =
+    "RBYGO&" // 14
+    "BYGO&R"
+    "YGO&RB" // 12
+    "GO&RBY"
+    "O&RBYG"
+    "&RBYGO"
+    "RBYGO&"
+    "BYGO&R"
+    "YGO&RB"
+    "GO&RBY"
+    "O&RBYG"
+    "&RBYGO"
+    "RBYGO&"
+    "BYGO&R";
+
+} // namespace
+
+TEST(PackedFieldTest, empty)
+{
+    PackedField pf;
+    EXPECT_EQ(pf, PackedField(BitField()));
+    EXPECT_EQ(BitField(), pf.toBitField());
+
+    for (int x = 1; x <= 6; ++x) {
+        for (int y = 1; y <= 14; ++y)
+            EXPECT_EQ(PuyoColor::EMPTY, pf.color(x, y));
+    }
+}
+
+TEST(PackedFieldTest, convertBitField)
+{
+    const BitField bf(FULL_FIELD);
+    const PackedField pf(bf);
+
+    EXPECT_EQ(bf, pf.toBitField());
+    for (int x = 1; x <= 6; ++x) {
+        for (int y = 1; y <= 14; ++y)
+            EXPECT_EQ(bf.color(x, y), pf.color(x, y)) << x << ' ' << y;
+    }
+}
+
+TEST(PackedFieldTest, convertCoreField)
+{
+    const CoreField cf(
+        "..O..." // 12
+        "..BY.."
+        "RRBYYG"
+        "RBBYGG");
+    const PackedField pf(cf);
+
+    EXPECT_EQ(cf, pf.toCoreField());
+    for (int x = 1; x <= 6; ++x)
+        EXPECT_EQ(cf.height(x), pf.toCoreField().height(x));
+}
+
+TEST(PackedFieldTest, convertPlainField)
+{
+    const PlainField plainField(FULL_FIELD);
+    const PackedField pf(plainField);
+
+    EXPECT_EQ(plainField, pf.toPlainField());
+    EXPECT_EQ(PackedField(BitField(FULL_FIELD)), pf);
+}
+
+TEST(PackedFieldTest, randomFields)
+{
+    mt19937 mt(1);
+    for (int i = 0; i < 1000; ++i) {
+        PlainField plainField;
+        for (int x = 1; x <= 6; ++x) {
+            for (int y = 1; y <= 14; ++y) {
+                PuyoColor c = static_cast<PuyoColor>(mt() % NUM_PUYO_COLORS);
+                if (c == PuyoColor::WALL)
+                    c = PuyoColor::EMPTY;
+                plainField.setColor(x, y, c);
+            }
+        }
+
+        const BitField bf(plainField);
+        const PackedField pf(bf);
+        EXPECT_EQ(bf, pf.toBitField());
+        EXPECT_EQ(plainField, pf.toPlainField());
+    }
+}
+
+TEST(PackedFieldTest, equalityAndHash)
+{
+    PackedField pf1(CoreField("RRB..."));
+    PackedField pf2(CoreField("RRB..."));
+    PackedField pf3(CoreField("RRY..."));
+
+    EXPECT_EQ(pf1, pf2);
+    EXPECT_EQ(pf1.hash(), pf2.hash());
+    EXPECT_NE(pf1, pf3);
+    EXPECT_NE(pf1.hash(), pf3.hash());
+}
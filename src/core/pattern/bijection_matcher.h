@@ -16,6 +16,11 @@ public:
     bool match(const FieldPattern&, const CoreField&);
     bool match(char, PuyoColor);
 
+    // Returns the color bound to the variable |v|, or EMPTY if |v| is not bound yet.
+    PuyoColor color(char v) const { return colors_[v - 'A']; }
+    // Returns the variable bound to the color |c|, or ' ' if |c| is not bound yet.
+    char var(PuyoColor c) const { return chars_[ordinal(c)]; }
+
 private:
     PuyoColor colors_[4];
     char chars_[NUM_PUYO_COLORS];
@@ -0,0 +1,114 @@
+#include "core/pattern/compiled_pattern_tree.h"
+
+#include <glog/logging.h>
+
+using namespace std;
+
+CompiledPatternTree::CompiledPatternTree()
+{
+    clear();
+}
+
+void CompiledPatternTree::clear()
+{
+    nodes_.clear();
+    edges_.clear();
+    leaves_.clear();
+    nodes_.push_back(Node { -1, 0, 0 });
+}
+
+void CompiledPatternTree::compile(const PatternTree& root)
+{
+    nodes_.clear();
+    edges_.clear();
+    leaves_.clear();
+
+    int index = compileNode(root);
+    CHECK_EQ(ROOT, index);
+}
+
+int CompiledPatternTree::compileNode(const PatternTree& tree)
+{
+    int index = static_cast<int>(nodes_.size());
+    int leaf = -1;
+    if (tree.isLeaf()) {
+        leaf = static_cast<int>(leaves_.size());
+        leaves_.push_back(tree.patternBookField());
+    }
+
+    // Edges of this node are allocated before visiting the children,
+    // so that they're contiguous.
+    int edgeBegin = static_cast<int>(edges_.size());
+    int edgeEnd = edgeBegin + static_cast<int>(tree.children_.size());
+    nodes_.push_back(Node { leaf, edgeBegin, edgeEnd });
+    for (const auto& entry : tree.children_)
+        edges_.push_back(Edge { entry.first, -1 });
+
+    for (int i = 0; i < edgeEnd - edgeBegin; ++i) {
+        // compileNode() may reallocate edges_, so don't take a reference before calling it.
+        int child = compileNode(*tree.children_[i].second);
+        edges_[edgeBegin + i].node = child;
+    }
+
+    return index;
+}
+
+void CompiledPatternTree::writeTo(file::BinaryImageWriter* writer) const
+{
+    writer->writeArray(nodes_);
+    writer->writeArray(edges_);
+
+    writer->write(static_cast<uint32_t>(leaves_.size()));
+    for (const auto& leaf : leaves_) {
+        writer->writeString(leaf.name());
+        writer->write(leaf.ironBits());
+        writer->write(leaf.mustBits());
+        writer->write(leaf.ignitionColumn());
+        writer->write(leaf.numVariables());
+        writer->write(leaf.score());
+    }
+}
+
+bool CompiledPatternTree::readFrom(file::BinaryImageReader* reader)
+{
+    nodes_.clear();
+    edges_.clear();
+    leaves_.clear();
+
+    if (!reader->readArray(&nodes_) || !reader->readArray(&edges_))
+        return false;
+
+    uint32_t numLeaves;
+    if (!reader->read(&numLeaves))
+        return false;
+    leaves_.reserve(numLeaves);
+    for (uint32_t i = 0; i < numLeaves; ++i) {
+        string name;
+        FieldBits ironBits;
+        FieldBits mustBits;
+        int ignitionColumn;
+        int numVariables;
+        double score;
+        if (!reader->readString(&name) || !reader->read(&ironBits) || !reader->read(&mustBits) ||
+            !reader->read(&ignitionColumn) || !reader->read(&numVariables) || !reader->read(&score)) {
+            return false;
+        }
+        leaves_.emplace_back(name, ironBits, mustBits, ignitionColumn, numVariables, score);
+    }
+
+    // Validates the indices, so that a broken image won't make complement() crash.
+    if (nodes_.empty())
+        return false;
+    for (const Node& node : nodes_) {
+        if (node.leaf >= static_cast<int>(leaves_.size()))
+            return false;
+        if (node.edgeBegin < 0 || node.edgeBegin > node.edgeEnd || node.edgeEnd > static_cast<int>(edges_.size()))
+            return false;
+    }
+    for (const Edge& edge : edges_) {
+        if (edge.node <= ROOT || edge.node >= static_cast<int>(nodes_.size()))
+            return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef CORE_PATTERN_COMPILED_PATTERN_TREE_H_
+#define CORE_PATTERN_COMPILED_PATTERN_TREE_H_
+
+#include <vector>
+
+#include "base/noncopyable.h"
+#include "base/file/binary_image.h"
+#include "core/pattern/pattern_bit.h"
+#include "core/pattern/pattern_tree.h"
+
+// CompiledPatternTree is a flat form of PatternTree. Nodes are stored in one array
+// in DFS order, and the edges of a node are stored contiguously in another array.
+// Nodes and leaves are referred by integer index, so traversing this doesn't chase pointers.
+// Common prefixes are already merged by PatternTree::put().
+class CompiledPatternTree : noncopyable {
+public:
+    struct Node {
+        int leaf;       // Index of the leaf, or -1 if this node is not a leaf.
+        int edgeBegin;
+        int edgeEnd;
+    };
+
+    struct Edge {
+        PatternBit patternBit;
+        int node;
+    };
+
+    // Makes a tree that has only an empty root.
+    CompiledPatternTree();
+
+    void compile(const PatternTree&);
+    // Makes this have only an empty root.
+    void clear();
+
+    // Writes/reads this tree to/from a binary image. Nodes and edges are copied as is.
+    void writeTo(file::BinaryImageWriter*) const;
+    bool readFrom(file::BinaryImageReader*);
+
+    static const int ROOT = 0;
+
+    const Node& node(int index) const { return nodes_[index]; }
+    const Edge& edge(int index) const { return edges_[index]; }
+    const PatternBookField& leaf(int index) const { return leaves_[index]; }
+
+    size_t numNodes() const { return nodes_.size(); }
+    size_t numLeaves() const { return leaves_.size(); }
+
+private:
+    int compileNode(const PatternTree&);
+
+    std::vector<Node> nodes_;
+    std::vector<Edge> edges_;
+    std::vector<PatternBookField> leaves_;
+};
+
+#endif // CORE_PATTERN_COMPILED_PATTERN_TREE_H_
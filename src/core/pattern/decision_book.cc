@@ -7,7 +7,9 @@
 #include <fstream>
 #include <utility>
 
+#include "base/file/binary_image.h"
 #include "base/strings.h"
+#include "core/core_field.h"
 #include "core/kumipuyo.h"
 #include "core/kumipuyo_seq.h"
 #include "core/pattern/bijection_matcher.h"
@@ -16,6 +18,9 @@ using namespace std;
 
 namespace {
 
+const uint32_t IMAGE_KIND = 0x4B424344; // "DCBK"
+const uint32_t IMAGE_VERSION = 1;
+
 Decision makeDecision(const toml::Value& v)
 {
     const toml::Array ary = v.as<toml::Array>();
@@ -24,13 +29,107 @@ Decision makeDecision(const toml::Value& v)
     return Decision(x, r);
 }
 
+void writeDecisions(const map<string, Decision>& decisions, file::BinaryImageWriter* writer)
+{
+    writer->write(static_cast<uint32_t>(decisions.size()));
+    for (const auto& entry : decisions) {
+        writer->writeString(entry.first);
+        writer->write(entry.second.x);
+        writer->write(entry.second.r);
+    }
+}
+
+bool readDecisions(file::BinaryImageReader* reader, size_t keySize, map<string, Decision>* decisions)
+{
+    uint32_t size;
+    if (!reader->read(&size))
+        return false;
+    for (uint32_t i = 0; i < size; ++i) {
+        string key;
+        int x, r;
+        if (!reader->readString(&key) || !reader->read(&x) || !reader->read(&r))
+            return false;
+        if (key.size() != keySize)
+            return false;
+        (*decisions)[key] = Decision(x, r);
+    }
+    return true;
+}
+
 } // namespace anonymous
 
 DecisionBookField::DecisionBookField(const vector<string>& field, map<string, Decision>&& decisions1, map<string, Decision>&& decisions2) :
-    pattern_(strings::join(field, "")),
+    field_(strings::join(field, "")),
+    pattern_(field_),
     decisions1_(move(decisions1)),
     decisions2_(move(decisions2))
 {
+    for (const auto& pat : pattern_.patterns()) {
+        if ('A' <= pat.var && pat.var <= 'D')
+            fieldVars_ |= 1 << (pat.var - 'A');
+    }
+
+    makeIndex(decisions1_, &index1_);
+    makeIndex(decisions2_, &index2_);
+}
+
+void DecisionBookField::makeIndex(const map<string, Decision>& decisions, unordered_map<int, IndexedDecision>* index)
+{
+    int rank = 0;
+    for (const auto& entry : decisions) {
+        // When several entries have the same key, the first one should be used,
+        // so emplace() that doesn't overwrite is used here.
+        index->emplace(canonicalKey(entry.first), IndexedDecision { rank++, entry.second });
+    }
+}
+
+int DecisionBookField::canonicalKey(const string& nextPattern) const
+{
+    // Each symbol takes 3 bits. 0-3 is a field variable, and 4-7 is the others.
+    int key = 0;
+    char freeVars[4];
+    int numFreeVars = 0;
+    for (size_t i = 0; i < nextPattern.size(); ++i) {
+        char v = nextPattern[i];
+        DCHECK('A' <= v && v <= 'D') << nextPattern;
+
+        int symbol;
+        if (fieldVars_ & (1 << (v - 'A'))) {
+            symbol = v - 'A';
+        } else {
+            int k = find(freeVars, freeVars + numFreeVars, v) - freeVars;
+            if (k == numFreeVars)
+                freeVars[numFreeVars++] = v;
+            symbol = 4 + k;
+        }
+        key |= symbol << (3 * i);
+    }
+
+    return key;
+}
+
+// static
+int DecisionBookField::canonicalKey(const BijectionMatcher& matcher, const PuyoColor* colors, int size)
+{
+    int key = 0;
+    PuyoColor freeColors[4];
+    int numFreeColors = 0;
+    for (int i = 0; i < size; ++i) {
+        char v = matcher.var(colors[i]);
+
+        int symbol;
+        if (v != ' ') {
+            symbol = v - 'A';
+        } else {
+            int k = find(freeColors, freeColors + numFreeColors, colors[i]) - freeColors;
+            if (k == numFreeColors)
+                freeColors[numFreeColors++] = colors[i];
+            symbol = 4 + k;
+        }
+        key |= symbol << (3 * i);
+    }
+
+    return key;
 }
 
 Decision DecisionBookField::nextDecision(const CoreField& cf, const KumipuyoSeq& seq) const
@@ -43,6 +142,86 @@ Decision DecisionBookField::nextDecision(const CoreField& cf, const KumipuyoSeq&
     const Kumipuyo& kp1 = seq.get(0);
     const Kumipuyo& kp2 = seq.get(1);
 
+    // A field variable that covers only ojama puyos is not bound by the matcher.
+    // Then the canonicalized keys don't agree with the index, so all entries are tried.
+    int boundVars = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (matcher.color('A' + i) != PuyoColor::EMPTY)
+            boundVars |= 1 << i;
+    }
+    if (boundVars != fieldVars_)
+        return scanDecision(matcher, kp1, kp2);
+
+    // Check sequence with 2 Tsumos.
+    Decision decision = lookupDecision(matcher, kp1, kp2);
+    if (decision.isValid())
+        return decision;
+
+    // Check sequence with 1 Tsumo.
+    return lookupDecision(matcher, kp1);
+}
+
+Decision DecisionBookField::lookupDecision(const BijectionMatcher& matcher, const Kumipuyo& next1) const
+{
+    // The entry that comes first in decisions1_ wins, as scanDecision() does.
+    // For the same entry, the kumipuyo as it is wins.
+    const IndexedDecision* best = nullptr;
+    bool bestReversed = false;
+    auto check = [&](const Kumipuyo& kp, bool reversed) {
+        PuyoColor colors[2] = { kp.axis, kp.child };
+        auto it = index1_.find(canonicalKey(matcher, colors, 2));
+        if (it == index1_.end())
+            return;
+        if (best && best->rank <= it->second.rank)
+            return;
+        best = &it->second;
+        bestReversed = reversed;
+    };
+
+    check(next1, false);
+    if (!next1.isRep())
+        check(next1.reverse(), true);
+
+    if (!best)
+        return Decision();
+    return bestReversed ? best->decision.reverse() : best->decision;
+}
+
+Decision DecisionBookField::lookupDecision(const BijectionMatcher& matcher, const Kumipuyo& next1, const Kumipuyo& next2) const
+{
+    // The entry that comes first in decisions2_ wins, as scanDecision() does.
+    // For the same entry, the earlier permutation wins.
+    const IndexedDecision* best = nullptr;
+    bool bestReversed = false;
+    auto check = [&](const Kumipuyo& kp1, const Kumipuyo& kp2, bool reversed) {
+        PuyoColor colors[4] = { kp1.axis, kp1.child, kp2.axis, kp2.child };
+        auto it = index2_.find(canonicalKey(matcher, colors, 4));
+        if (it == index2_.end())
+            return;
+        if (best && best->rank <= it->second.rank)
+            return;
+        best = &it->second;
+        bestReversed = reversed;
+    };
+
+    check(next1, next2, false);
+    if (!next2.isRep())
+        check(next1, next2.reverse(), false);
+    if (!next1.isRep()) {
+        check(next1.reverse(), next2, true);
+        if (!next2.isRep())
+            check(next1.reverse(), next2.reverse(), true);
+    }
+
+    if (!best)
+        return Decision();
+    return bestReversed ? best->decision.reverse() : best->decision;
+}
+
+Decision DecisionBookField::scanDecision(const BijectionMatcher& fieldMatcher, const Kumipuyo& kp1, const Kumipuyo& kp2) const
+{
+    BijectionMatcher matcher(fieldMatcher);
+
     // Check sequence with 2 Tsumos.
     for (const auto& entry : decisions2_) {
         if (matchNext(&matcher, entry.first, kp1, kp2))
@@ -169,16 +348,82 @@ bool DecisionBook::loadFromValue(const toml::Value& book)
                 CHECK(false) << "Invalid Tsumo assumption: " << e.first;
             }
         }
-        fields_.emplace_back(f, std::move(m1), std::move(m2));
+        addField(f, std::move(m1), std::move(m2));
     }
 
     return true;
 }
 
+bool DecisionBook::loadWithImage(const string& filename)
+{
+    if (loadImage(filename))
+        return true;
+
+    LOG(INFO) << "No up-to-date image for " << filename << ". Parsing it.";
+    return load(filename);
+}
+
+bool DecisionBook::loadImage(const string& sourceFilename)
+{
+    file::BinaryImageReader reader;
+    if (!reader.open(file::binaryImagePath(sourceFilename), IMAGE_KIND, IMAGE_VERSION, file::hashFileContent(sourceFilename)))
+        return false;
+
+    // Reads all the fields first, so that a broken image doesn't leave a half-loaded book.
+    uint32_t numFields;
+    if (!reader.read(&numFields))
+        return false;
+
+    vector<string> fields(numFields);
+    vector<map<string, Decision>> decisions1(numFields);
+    vector<map<string, Decision>> decisions2(numFields);
+    for (uint32_t i = 0; i < numFields; ++i) {
+        if (!reader.readString(&fields[i]) ||
+            !readDecisions(&reader, 2, &decisions1[i]) ||
+            !readDecisions(&reader, 4, &decisions2[i])) {
+            LOG(WARNING) << "broken image: " << file::binaryImagePath(sourceFilename);
+            return false;
+        }
+    }
+    if (!reader.isEnd()) {
+        LOG(WARNING) << "broken image: " << file::binaryImagePath(sourceFilename);
+        return false;
+    }
+
+    fields_.reserve(fields_.size() + numFields);
+    for (uint32_t i = 0; i < numFields; ++i)
+        addField(vector<string> { fields[i] }, std::move(decisions1[i]), std::move(decisions2[i]));
+
+    return true;
+}
+
+bool DecisionBook::saveImage(const string& sourceFilename) const
+{
+    file::BinaryImageWriter writer(IMAGE_KIND, IMAGE_VERSION, file::hashFileContent(sourceFilename));
+    writer.write(static_cast<uint32_t>(fields_.size()));
+    for (const auto& field : fields_) {
+        writer.writeString(field.field());
+        writeDecisions(field.decisions1(), &writer);
+        writeDecisions(field.decisions2(), &writer);
+    }
+    return writer.save(file::binaryImagePath(sourceFilename));
+}
+
+void DecisionBook::addField(const vector<string>& field, map<string, Decision>&& decisions1, map<string, Decision>&& decisions2)
+{
+    fields_.emplace_back(field, std::move(decisions1), std::move(decisions2));
+    fieldIndex_[fields_.back().occupiedBits()].push_back(static_cast<int>(fields_.size() - 1));
+}
+
 Decision DecisionBook::nextDecision(const CoreField& cf, const KumipuyoSeq& seq) const
 {
-    for (const auto& f : fields_) {
-        Decision decision = f.nextDecision(cf, seq);
+    // Only the fields that have the same occupied cells can match.
+    auto it = fieldIndex_.find(cf.bitField().field13Bits());
+    if (it == fieldIndex_.end())
+        return Decision();
+
+    for (int i : it->second) {
+        Decision decision = fields_[i].nextDecision(cf, seq);
         if (decision.isValid())
             return decision;
     }
@@ -5,10 +5,12 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "base/noncopyable.h"
 #include "core/decision.h"
+#include "core/field_bits.h"
 #include "core/pattern/field_pattern.h"
 
 class BijectionMatcher;
@@ -24,15 +26,47 @@ public:
 
     Decision nextDecision(const CoreField&, const KumipuyoSeq&) const;
 
+    const std::string& field() const { return field_; }
+    const std::map<std::string, Decision>& decisions1() const { return decisions1_; }
+    const std::map<std::string, Decision>& decisions2() const { return decisions2_; }
+
+    // Bits of the cells occupied by this field. A CoreField can match this only when
+    // its occupied cells are the same as this.
+    FieldBits occupiedBits() const { return pattern_.patternBits(); }
+
 private:
+    // Decisions are indexed by the NEXT pattern whose variables are canonicalized:
+    // a variable that appears in the field is kept, and the other variables are renamed
+    // in the order of appearance. Then a NEXT sequence can be canonicalized with the colors
+    // bound by BijectionMatcher, and the bijection is resolved by one lookup.
+    struct IndexedDecision {
+        int rank;  // The position in decisions1_ or decisions2_.
+        Decision decision;
+    };
+
+    void makeIndex(const std::map<std::string, Decision>&, std::unordered_map<int, IndexedDecision>*);
+    int canonicalKey(const std::string& nextPattern) const;
+    static int canonicalKey(const BijectionMatcher&, const PuyoColor* colors, int size);
+
+    Decision lookupDecision(const BijectionMatcher&, const Kumipuyo& next1) const;
+    Decision lookupDecision(const BijectionMatcher&, const Kumipuyo& next1, const Kumipuyo& next2) const;
+    // Finds a decision by trying all the entries. This is used only when the index cannot be used.
+    Decision scanDecision(const BijectionMatcher&, const Kumipuyo& next1, const Kumipuyo& next2) const;
+
     bool matchNext(BijectionMatcher*, const std::string& nextPattern, const Kumipuyo& next1) const;
     bool matchNext(BijectionMatcher*, const std::string& nextPattern, const Kumipuyo& next1, const Kumipuyo& next2) const;
 
+    std::string field_;
     FieldPattern pattern_;
     // Decisions decided with 1 Tsumo.
     std::map<std::string, Decision> decisions1_;
     // Decisions decided with 2 Tsumos.
     std::map<std::string, Decision> decisions2_;
+
+    // Bit i is set when the variable 'A' + i appears in the field.
+    int fieldVars_ = 0;
+    std::unordered_map<int, IndexedDecision> index1_;
+    std::unordered_map<int, IndexedDecision> index2_;
 };
 
 // DecisionBook is a book to return a fixed Decision from the given field and kumipuyo sequence.
@@ -46,13 +80,24 @@ public:
     bool loadFromString(const std::string&);
     bool loadFromValue(const toml::Value&);
 
+    // Loads the binary image compiled from |filename| if it's up to date.
+    // Otherwise, |filename| is parsed. See base/file/binary_image.h.
+    bool loadWithImage(const std::string& filename);
+    // Saves this book as an image of |sourceFilename|.
+    bool saveImage(const std::string& sourceFilename) const;
+
     // Finds next decision. If next decision is not found, invalid Decision will be returned.
     Decision nextDecision(const CoreField&, const KumipuyoSeq&) const;
 
 private:
-    void makeFieldFromValue(const CoreField&, const std::string&, const toml::Value&);
+    bool loadImage(const std::string& sourceFilename);
+    void addField(const std::vector<std::string>& field,
+                  std::map<std::string, Decision>&& decisions1,
+                  std::map<std::string, Decision>&& decisions2);
 
     std::vector<DecisionBookField> fields_;
+    // Indices of fields_ keyed by their occupied cells. Indices are in the book order.
+    std::unordered_map<FieldBits, std::vector<int>> fieldIndex_;
 };
 
 #endif // CPU_MAYAH_DECISION_BOOK_H_
@@ -0,0 +1,64 @@
+#include "core/pattern/decision_book.h"
+
+#include <iostream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "base/time.h"
+#include "base/time_stamp_counter.h"
+#include "core/core_field.h"
+#include "core/kumipuyo_seq.h"
+#include "core/kumipuyo_seq_generator.h"
+
+using namespace std;
+
+namespace {
+
+void runDecisionBook(const string& filename)
+{
+    DecisionBook book;
+    double beginTime = currentTime();
+    ASSERT_TRUE(book.load(filename));
+    double endTime = currentTime();
+    cout << filename << endl;
+    cout << "load: " << (endTime - beginTime) * 1000 << " [ms]" << endl;
+
+    // Follows the book with random sequences, so that both found and not-found cases are measured.
+    TimeStampCounterData tsc;
+    int numFound = 0;
+    int numQueries = 0;
+    for (int seed = 0; seed < 1000; ++seed) {
+        KumipuyoSeq seq = KumipuyoSeqGenerator::generateRandomSequenceWithSeed(32, seed);
+        CoreField cf;
+        while (seq.size() >= 2) {
+            Decision decision;
+            {
+                ScopedTimeStampCounter stsc(&tsc);
+                decision = book.nextDecision(cf, seq);
+            }
+            ++numQueries;
+            if (!decision.isValid())
+                break;
+            ++numFound;
+            if (!cf.dropKumipuyo(decision, seq.front()))
+                break;
+            seq.dropFront();
+        }
+    }
+
+    cout << "queries: " << numQueries << " found: " << numFound << endl;
+    tsc.showStatistics();
+}
+
+}
+
+TEST(DecisionBookPerformanceTest, mayah)
+{
+    runDecisionBook(string(SRC_DIR) + "/cpu/mayah/decision.toml");
+}
+
+TEST(DecisionBookPerformanceTest, peria)
+{
+    runDecisionBook(string(SRC_DIR) + "/cpu/peria/book/joseki.toml");
+}
@@ -2,6 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include "base/file/binary_image.h"
+#include "base/file/file.h"
+#include "base/file/path.h"
+#include "base/file/temporary_file.h"
 #include "core/core_field.h"
 #include "core/kumipuyo_seq.h"
 
@@ -121,3 +125,90 @@ TEST_F(DecisionBookTest, nextDecision3)
     cf.dropKumipuyo(Decision(3, 2), seq.front());
     seq.dropFront();
 }
+
+TEST(DecisionBookFieldTest, nextDecisionWithFreeVariables)
+{
+    DecisionBook book;
+    ASSERT_TRUE(book.loadFromString(
+        "[[book]]\n"
+        "field = [\n"
+        "    \"AA....\"\n"
+        "]\n"
+        "ABAB = [3, 0]\n"
+        "BBCC = [4, 2]\n"
+        "BCBC = [5, 2]\n"));
+
+    CoreField cf("RR....");
+
+    // 'B' and 'C' should be different colors, and they should be different from 'A'.
+    EXPECT_EQ(Decision(4, 2), book.nextDecision(cf, KumipuyoSeq("BBYY")));
+    EXPECT_EQ(Decision(5, 2), book.nextDecision(cf, KumipuyoSeq("BYBY")));
+    EXPECT_FALSE(book.nextDecision(cf, KumipuyoSeq("BBBB")).isValid());
+    EXPECT_FALSE(book.nextDecision(cf, KumipuyoSeq("BBRR")).isValid());
+
+    // The reversed kumipuyo should be considered.
+    EXPECT_EQ(Decision(3, 0), book.nextDecision(cf, KumipuyoSeq("RBRB")));
+    EXPECT_EQ(Decision(3, 2), book.nextDecision(cf, KumipuyoSeq("BRRB")));
+}
+
+TEST(DecisionBookFieldTest, nextDecisionWithBothOrientations)
+{
+    DecisionBook book;
+    ASSERT_TRUE(book.loadFromString(
+        "[[book]]\n"
+        "field = [\n"
+        "    \"AA....\"\n"
+        "]\n"
+        "AB = [3, 0]\n"
+        "BA = [4, 0]\n"));
+
+    CoreField cf("RR....");
+
+    // "YR" matches "BA", and the reversed "RY" matches "AB". "AB" comes first in the book.
+    EXPECT_EQ(Decision(3, 2), book.nextDecision(cf, KumipuyoSeq("YRGG")));
+    EXPECT_EQ(Decision(3, 0), book.nextDecision(cf, KumipuyoSeq("RYGG")));
+}
+
+TEST(DecisionBookFieldTest, nextDecisionWithOjama)
+{
+    DecisionBook book;
+    ASSERT_TRUE(book.loadFromString(
+        "[[book]]\n"
+        "field = [\n"
+        "    \"A.B...\"\n"
+        "]\n"
+        "AB = [4, 0]\n"));
+
+    // 'A' covers only an ojama, so 'A' is not bound to any color.
+    CoreField cf("O.R...");
+    EXPECT_EQ(Decision(4, 0), book.nextDecision(cf, KumipuyoSeq("BR")));
+    EXPECT_EQ(Decision(4, 2), book.nextDecision(cf, KumipuyoSeq("RB")));
+    EXPECT_FALSE(book.nextDecision(cf, KumipuyoSeq("RR")).isValid());
+}
+
+TEST_F(DecisionBookTest, loadWithImage)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    ASSERT_TRUE(file::writeFile(filename, TEST_BOOK));
+
+    ASSERT_TRUE(book().saveImage(filename));
+
+    DecisionBook imageBook;
+    ASSERT_TRUE(imageBook.loadWithImage(filename));
+
+    CoreField cf;
+    KumipuyoSeq seq("RRBBGG");
+    EXPECT_EQ(Decision(3, 3), imageBook.nextDecision(cf, seq));
+    cf.dropKumipuyo(Decision(3, 3), seq.front());
+    seq.dropFront();
+    EXPECT_EQ(Decision(3, 3), imageBook.nextDecision(cf, seq));
+
+    // When the source is modified, the image should not be used.
+    ASSERT_TRUE(file::writeFile(filename, "[[book]]\nfield = []\nAABB = [1, 0]\n"));
+    DecisionBook modifiedBook;
+    ASSERT_TRUE(modifiedBook.loadWithImage(filename));
+    EXPECT_EQ(Decision(1, 0), modifiedBook.nextDecision(CoreField(), KumipuyoSeq("RRBB")));
+
+    EXPECT_TRUE(file::remove(file::binaryImagePath(filename)));
+}
@@ -8,6 +8,7 @@
 
 class PatternBit {
 public:
+    PatternBit() {}
     PatternBit(FieldBits varBits, FieldBits notBits) : varBits_(varBits), notBits_(notBits) {}
 
     size_t hash() const { return varBits_.hash() * 37 + notBits_.hash(); }
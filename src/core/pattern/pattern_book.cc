@@ -3,10 +3,15 @@
 #include <algorithm>
 #include <fstream>
 
+#include "base/file/binary_image.h"
+
 using namespace std;
 
 namespace {
 
+const uint32_t IMAGE_KIND = 0x4B425450; // "PTBK"
+const uint32_t IMAGE_VERSION = 2;
+
 ColumnPuyoList diff(const CoreField& before, const BitField& after)
 {
     ColumnPuyoList cpl;
@@ -46,6 +51,39 @@ bool PatternBook::load(const string& filename)
     return loadFromValue(std::move(result.value));
 }
 
+bool PatternBook::loadWithImage(const string& filename)
+{
+    if (loadImage(filename))
+        return true;
+
+    LOG(INFO) << "No up-to-date image for " << filename << ". Parsing it.";
+    return load(filename);
+}
+
+bool PatternBook::loadImage(const string& sourceFilename)
+{
+    file::BinaryImageReader reader;
+    if (!reader.open(file::binaryImagePath(sourceFilename), IMAGE_KIND, IMAGE_VERSION, file::hashFileContent(sourceFilename)))
+        return false;
+
+    // The patterns in the image are only in the compiled form.
+    root_.reset(new PatternTree);
+    if (!compiled_.readFrom(&reader) || !reader.isEnd()) {
+        LOG(WARNING) << "broken image: " << file::binaryImagePath(sourceFilename);
+        compiled_.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool PatternBook::saveImage(const string& sourceFilename) const
+{
+    file::BinaryImageWriter writer(IMAGE_KIND, IMAGE_VERSION, file::hashFileContent(sourceFilename));
+    compiled_.writeTo(&writer);
+    return writer.save(file::binaryImagePath(sourceFilename));
+}
+
 bool PatternBook::loadFromString(const string& str, bool ignoreDuplicate)
 {
     istringstream ss(str);
@@ -146,6 +184,7 @@ bool PatternBook::loadFromValue(const toml::Value& patterns, bool ignoreDuplicat
         }
     }
 
+    compiled_.compile(*root_);
     return true;
 }
 
@@ -159,7 +198,7 @@ void PatternBook::complement(const CoreField& originalField,
                                 int allowedNumUnusedVariables,
                                 const ComplementCallback& callback) const
 {
-    iterate(*root_, originalField, originalField.bitField(), FieldBits(), allowedNumUnusedVariables, 0, callback);
+    iterate(CompiledPatternTree::ROOT, originalField, originalField.bitField(), FieldBits(), allowedNumUnusedVariables, 0, callback);
 }
 
 void PatternBook::complement(const CoreField& originalField,
@@ -167,17 +206,19 @@ void PatternBook::complement(const CoreField& originalField,
                              int allowedNumUnusedVariables,
                              const ComplementCallback& callback) const
 {
-    for (const auto& entry : root_->children_) {
-        if (entry.first.varBits() != ignitionBits)
+    const CompiledPatternTree::Node& root = compiled_.node(CompiledPatternTree::ROOT);
+    for (int i = root.edgeBegin; i < root.edgeEnd; ++i) {
+        const CompiledPatternTree::Edge& edge = compiled_.edge(i);
+        if (edge.patternBit.varBits() != ignitionBits)
             continue;
         // TODO(mayah): Probably, we don't need to check notBits.
-        iterate(*entry.second, originalField, originalField.bitField(),
-                entry.first.varBits() & ignitionBits,
+        iterate(edge.node, originalField, originalField.bitField(),
+                edge.patternBit.varBits() & ignitionBits,
                 allowedNumUnusedVariables, 0, callback);
     }
 }
 
-void PatternBook::iterate(const PatternTree& tree,
+void PatternBook::iterate(int nodeIndex,
                           const CoreField& originalField,
                           const BitField& currentField,
                           const FieldBits& matchedBits,
@@ -185,66 +226,79 @@ void PatternBook::iterate(const PatternTree& tree,
                           int numUnusedVariables,
                           const ComplementCallback& callback) const
 {
-    if (tree.isLeaf()) {
-        if ((tree.patternBookField().mustBits() & originalField.bitField().field13Bits()) == tree.patternBookField().mustBits()) {
+    const CompiledPatternTree::Node& node = compiled_.node(nodeIndex);
+    if (node.leaf >= 0) {
+        const PatternBookField& patternBookField = compiled_.leaf(node.leaf);
+        if ((patternBookField.mustBits() & originalField.bitField().field13Bits()) == patternBookField.mustBits()) {
             BitField bf(currentField);
-            bf.setColorAllIfEmpty(tree.patternBookField().ironBits(), PuyoColor::IRON);
+            bf.setColorAllIfEmpty(patternBookField.ironBits(), PuyoColor::IRON);
             if (!bf.hasFloatingPuyo()) {
                 CoreField cf(bf);
-                callback(std::move(cf), diff(originalField, bf), numUnusedVariables, matchedBits, tree.patternBookField());
+                callback(std::move(cf), diff(originalField, bf), numUnusedVariables, matchedBits, patternBookField);
             }
         }
     }
 
+    if (node.edgeBegin == node.edgeEnd)
+        return;
+
+    // The color bits are shared by all the edges, so they're computed only once.
     FieldBits ojamaBits = currentField.bits(PuyoColor::OJAMA);
-    for (const auto& entry : tree.children_) {
-        PuyoColor foundColor = PuyoColor::EMPTY;
+    FieldBits colorBits[NUM_NORMAL_PUYO_COLORS];
+    for (int i = 0; i < NUM_NORMAL_PUYO_COLORS; ++i)
+        colorBits[i] = currentField.bits(NORMAL_PUYO_COLORS[i]);
+
+    for (int edgeIndex = node.edgeBegin; edgeIndex < node.edgeEnd; ++edgeIndex) {
+        const CompiledPatternTree::Edge& edge = compiled_.edge(edgeIndex);
+        const FieldBits varBits = edge.patternBit.varBits();
+
+        // Check ojama.
+        if (!(varBits & ojamaBits).isEmpty())
+            continue;
+
+        int foundColorIndex = -1;
         bool ok = true;
         FieldBits newMatchedBits(matchedBits);
-        for (PuyoColor c : NORMAL_PUYO_COLORS) {
-            FieldBits matched = entry.first.varBits() & currentField.bits(c);
+        for (int i = 0; i < NUM_NORMAL_PUYO_COLORS; ++i) {
+            FieldBits matched = varBits & colorBits[i];
             if (matched.isEmpty())
                 continue;
-            if (foundColor != PuyoColor::EMPTY) {
+            if (foundColorIndex >= 0) {
                 ok = false;
                 break;
             }
 
             newMatchedBits.setAll(matched);
-            foundColor = c;
+            foundColorIndex = i;
         }
         if (!ok)
             continue;
 
-        // Check ojama.
-        if (!(entry.first.varBits() & ojamaBits).isEmpty())
-            continue;
-
         bool unusedVariableUsed = false;
-        if (foundColor == PuyoColor::EMPTY) {
+        if (foundColorIndex < 0) {
             if (allowedNumUnusedVariables <= numUnusedVariables)
                 continue;
 
             // TODO(mayah): Should check all colors?
-            for (PuyoColor c : NORMAL_PUYO_COLORS) {
-                if ((entry.first.notBits() & currentField.bits(c)).isEmpty()) {
-                    foundColor = c;
+            for (int i = 0; i < NUM_NORMAL_PUYO_COLORS; ++i) {
+                if ((edge.patternBit.notBits() & colorBits[i]).isEmpty()) {
+                    foundColorIndex = i;
                     break;
                 }
             }
 
-            if (foundColor == PuyoColor::EMPTY)
+            if (foundColorIndex < 0)
                 continue;
 
             unusedVariableUsed = true;
         } else {
             // Check not bits.
-            if (!(entry.first.notBits() & currentField.bits(foundColor)).isEmpty())
+            if (!(edge.patternBit.notBits() & colorBits[foundColorIndex]).isEmpty())
                 continue;
         }
 
         BitField bf(currentField);
-        bf.setColorAll(entry.first.varBits(), foundColor);
-        iterate(*entry.second, originalField, bf, newMatchedBits, allowedNumUnusedVariables, unusedVariableUsed ? numUnusedVariables + 1 : numUnusedVariables, callback);
+        bf.setColorAll(varBits, NORMAL_PUYO_COLORS[foundColorIndex]);
+        iterate(edge.node, originalField, bf, newMatchedBits, allowedNumUnusedVariables, unusedVariableUsed ? numUnusedVariables + 1 : numUnusedVariables, callback);
     }
 }
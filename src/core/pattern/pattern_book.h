@@ -13,6 +13,7 @@
 #include "core/rensa/rensa_detector.h"
 #include "core/column_puyo_list.h"
 #include "core/core_field.h"
+#include "core/pattern/compiled_pattern_tree.h"
 #include "core/pattern/field_pattern.h"
 #include "core/pattern/pattern_bit.h"
 #include "core/pattern/pattern_tree.h"
@@ -33,12 +34,20 @@ public:
     bool loadFromString(const std::string&, bool ignoreDuplicate = false);
     bool loadFromValue(const toml::Value&, bool ignoreDuplicate = false);
 
+    // Loads the binary image compiled from |filename| if it's up to date.
+    // Otherwise, |filename| is parsed. See base/file/binary_image.h.
+    bool loadWithImage(const std::string& filename);
+    // Saves the compiled patterns as an image of |sourceFilename|.
+    bool saveImage(const std::string& sourceFilename) const;
+
     void complement(const CoreField&, const ComplementCallback&) const;
     void complement(const CoreField&, int allowedNumUnusedVariables, const ComplementCallback&) const;
     void complement(const CoreField&, const FieldBits& ignitionBits, int allowedNumUnusedVariables, const ComplementCallback&) const;
 
 private:
-    void iterate(const PatternTree&,
+    bool loadImage(const std::string& sourceFilename);
+
+    void iterate(int nodeIndex,
                  const CoreField& oridinalField,
                  const BitField& currentField,
                  const FieldBits& matchedBits,
@@ -46,7 +55,9 @@ private:
                  int numUnusedVariables,
                  const ComplementCallback&) const;
 
+    // Patterns are put into |root_| while loading, and |compiled_| is used to complement.
     std::unique_ptr<PatternTree> root_;
+    CompiledPatternTree compiled_;
 };
 
 #endif // CPU_MAYAH_PATTERN_BOOK_H_
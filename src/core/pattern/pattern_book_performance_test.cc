@@ -0,0 +1,65 @@
+#include "core/pattern/pattern_book.h"
+
+#include <iostream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "base/time.h"
+#include "base/time_stamp_counter.h"
+#include "core/core_field.h"
+
+using namespace std;
+
+namespace {
+
+void runComplement(const PatternBook& patternBook, const CoreField& field, int allowedNumUnusedVariables)
+{
+    TimeStampCounterData tsc;
+    int numComplemented = 0;
+    auto callback = [&](CoreField&& /*cf*/, const ColumnPuyoList& /*cpl*/,
+                        int /*numFilledUnusedVariables*/, const FieldBits& /*matchedBits*/,
+                        const PatternBookField& /*patternBookField*/) {
+        ++numComplemented;
+    };
+
+    for (int i = 0; i < 1000; ++i) {
+        ScopedTimeStampCounter stsc(&tsc);
+        patternBook.complement(field, allowedNumUnusedVariables, callback);
+    }
+
+    cout << "complemented: " << (numComplemented / 1000) << endl;
+    tsc.showStatistics();
+}
+
+}
+
+TEST(PatternBookPerformanceTest, complement)
+{
+    PatternBook patternBook;
+    double beginTime = currentTime();
+    ASSERT_TRUE(patternBook.load(string(SRC_DIR) + "/cpu/mayah/pattern.toml"));
+    double endTime = currentTime();
+    cout << "load: " << (endTime - beginTime) * 1000 << " [ms]" << endl;
+
+    const CoreField fields[] = {
+        CoreField(),
+        CoreField("RRB..."),
+        CoreField("BB.Y.."
+                  "RRBYY."),
+        CoreField("Y....."
+                  "BBRR.."
+                  "RRBYG."
+                  "BBYYGG"),
+        CoreField("....Y."
+                  "Y..RRG"
+                  "BBYBGG"
+                  "RRBYYG"),
+    };
+
+    for (const auto& field : fields) {
+        cout << field.toDebugString() << endl;
+        runComplement(patternBook, field, 0);
+        runComplement(patternBook, field, 1);
+    }
+}
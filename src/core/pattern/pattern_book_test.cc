@@ -4,6 +4,10 @@
 #include <iostream>
 
 #include "base/base.h"
+#include "base/file/binary_image.h"
+#include "base/file/file.h"
+#include "base/file/path.h"
+#include "base/file/temporary_file.h"
 
 using namespace std;
 
@@ -575,3 +579,50 @@ ignition = 2
 
     testUnmatch(BOOK, original);
 }
+
+TEST(PatternBookTest, loadWithImage)
+{
+    static const char BOOK[] = R"(
+[[pattern]]
+field = [
+    "A.BC..",
+    "AAAB..",
+    "BBBCCC",
+]
+ignition = 1
+)";
+
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    ASSERT_TRUE(file::writeFile(filename, BOOK));
+
+    {
+        PatternBook patternBook;
+        ASSERT_TRUE(patternBook.load(filename));
+        ASSERT_TRUE(patternBook.saveImage(filename));
+    }
+
+    PatternBook patternBook;
+    ASSERT_TRUE(patternBook.loadWithImage(filename));
+
+    const CoreField original(
+        "......"
+        "..YB.."
+        "BBBG..");
+    const CoreField expected(
+        "Y.BG.."
+        "YYYB.."
+        "BBBGGG");
+
+    bool found = false;
+    patternBook.complement(original, [&](CoreField&& cf, const ColumnPuyoList&, int, const FieldBits&,
+                                         const PatternBookField& patternBookField) {
+        if (cf == expected) {
+            found = true;
+            EXPECT_EQ(1, patternBookField.ignitionColumn());
+        }
+    });
+    EXPECT_TRUE(found);
+
+    EXPECT_TRUE(file::remove(file::binaryImagePath(filename)));
+}
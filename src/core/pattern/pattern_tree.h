@@ -2,6 +2,7 @@
 #define CORE_PATTERN_PATTERN_TREE_H_
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "core/pattern/pattern_bit.h"
@@ -42,7 +43,7 @@ public:
                  int ignitionColumn, int numVariables, double score);
 
 private:
-    friend class PatternBook;
+    friend class CompiledPatternTree;
 
     // If leaf, this is not empty.
     std::unique_ptr<PatternBookField> patternBookField_;
@@ -1,15 +1,20 @@
 #include "core/probability/column_puyo_list_probability.h"
 
-#include <fstream>
 #include <limits>
-#include <iostream>
+#include <string>
+#include <unordered_map>
 
+#include <gflags/gflags.h>
+
+#include "base/file/path.h"
 #include "base/strings.h"
 #include "core/kumipuyo.h"
 #include "core/probability/puyo_set_probability.h"
 
 using namespace std;
 
+DECLARE_string(probability_image_dir);
+
 static const Kumipuyo ALL_KUMIPUYO_KINDS[] = {
     Kumipuyo(PuyoColor::RED, PuyoColor::RED),
     Kumipuyo(PuyoColor::RED, PuyoColor::BLUE),
@@ -143,76 +148,109 @@ static void iter(int n, int leftX, ColumnPuyoList* cpl, unordered_map<ColumnPuyo
     }
 }
 
-static void iterForSave(int n, int leftX, ColumnPuyoList* cpl, const unordered_map<ColumnPuyoList, double>& m,
-                        vector<double>* vs, size_t* index)
-{
-    auto it = m.find(*cpl);
-    CHECK(it != m.end()) << cpl->toString();
-    (*vs)[*index] = it->second;
-    *index += 1;
+namespace {
 
-    for (int x = leftX; x <= 6; ++x) {
-        for (PuyoColor c : NORMAL_PUYO_COLORS) {
-            cpl->add(x, c);
-            if (n > 0)
-                iterForSave(n - 1, x, cpl, m, vs, index);
-            cpl->removeTopFrom(x);
-        }
-    }
+const uint32_t IMAGE_KIND = 0x50424C43; // "CLBP"
+const uint32_t IMAGE_VERSION = 1;
+
+const int SIZE_BASE = 7;
+const int NUM_SIZES = SIZE_BASE * SIZE_BASE * SIZE_BASE * SIZE_BASE * SIZE_BASE * SIZE_BASE;
+
+} // anonymous namespace
+
+ColumnPuyoListProbability::ColumnPuyoListProbability() :
+    offsets_(NUM_SIZES, -1),
+    tableSize_(0),
+    table_(nullptr)
+{
+    makeOffsets();
+    makeTable();
 }
 
-static void iterForLoad(int n, int leftX, ColumnPuyoList* cpl, unordered_map<ColumnPuyoList, double>* m,
-                        const vector<double>& vs, size_t* index)
+ColumnPuyoListProbability::ColumnPuyoListProbability(const string& imageFilename) :
+    offsets_(NUM_SIZES, -1),
+    tableSize_(0),
+    table_(nullptr)
 {
-    (*m)[*cpl] = vs[*index];
-    *index += 1;
+    makeOffsets();
+    if (loadTable(imageFilename))
+        return;
 
-    for (int x = leftX; x <= 6; ++x) {
-        for (PuyoColor c : NORMAL_PUYO_COLORS) {
-            cpl->add(x, c);
-            if (n > 0)
-                iterForLoad(n - 1, x, cpl, m, vs, index);
-            cpl->removeTopFrom(x);
-        }
-    }
+    makeTable();
+    if (!saveTable(imageFilename))
+        LOG(WARNING) << "failed to save " << imageFilename;
 }
 
-ColumnPuyoListProbability::ColumnPuyoListProbability()
+void ColumnPuyoListProbability::makeOffsets()
 {
-    const int N = 6;
-    const string filename = "column-puyo-possibility-" + std::to_string(N) + ".dat";
+    static_assert(MAX_TABLE_PUYOS + 1 == SIZE_BASE, "SIZE_BASE should be MAX_TABLE_PUYOS + 1");
+
+    // Assigns offsets to all the column sizes whose sum is at most MAX_TABLE_PUYOS.
+    for (int sizes = 0; sizes < NUM_SIZES; ++sizes) {
+        int total = 0;
+        int numColors = 1;
+        for (int v = sizes; v > 0; v /= SIZE_BASE) {
+            total += v % SIZE_BASE;
+        }
+        if (total > MAX_TABLE_PUYOS)
+            continue;
+        for (int i = 0; i < total; ++i)
+            numColors *= NUM_NORMAL_PUYO_COLORS;
 
-    m_.reserve(1000000);
+        offsets_[sizes] = tableSize_;
+        tableSize_ += numColors;
+    }
+}
 
-    // try to read from the file.
-    ifstream ifs(filename);
-    if (ifs) {
-        ifstream::pos_type begin = ifs.tellg();
-        ifs.seekg(0, fstream::end);
-        ifstream::pos_type end = ifs.tellg();
-        ifs.seekg(0, fstream::beg);
-        ifs.clear();
+int ColumnPuyoListProbability::indexOf(const ColumnPuyoList& cpl) const
+{
+    if (cpl.size() > MAX_TABLE_PUYOS)
+        return -1;
 
-        size_t size = end - begin;
-        vector<double> vs(size / sizeof(double));
-        ifs.read(reinterpret_cast<char*>(vs.data()), size);
+    int sizes = 0;
+    int colors = 0;
+    for (int x = 6; x >= 1; --x) {
+        sizes = sizes * SIZE_BASE + cpl.sizeOn(x);
+    }
+    for (int x = 1; x <= 6; ++x) {
+        for (int i = 0; i < cpl.sizeOn(x); ++i) {
+            PuyoColor c = cpl.get(x, i);
+            if (!isNormalColor(c))
+                return -1;
+            colors = colors * NUM_NORMAL_PUYO_COLORS + normalColorIndex(c);
+        }
+    }
 
-        size_t index = 0;
-        ColumnPuyoList initial;
-        iterForLoad(N, 1, &initial, &m_, vs, &index);
+    return offsets_[sizes] + colors;
+}
 
-        return;
+bool ColumnPuyoListProbability::loadTable(const string& filename)
+{
+    if (!image_.open(filename, IMAGE_KIND, IMAGE_VERSION, tableSize_))
+        return false;
+
+    const double* table;
+    uint32_t size;
+    if (!image_.readArrayView(&table, &size) || size != static_cast<uint32_t>(tableSize_)) {
+        LOG(WARNING) << "broken table: " << filename;
+        return false;
     }
 
+    table_ = table;
+    return true;
+}
+
+void ColumnPuyoListProbability::makeTable()
+{
     unordered_map<ColumnPuyoList, double> reverseMap;
-    reverseMap.reserve(1000000);
+    reverseMap.reserve(tableSize_);
     ColumnPuyoList initial;
     reverseMap[initial] = 0.0;
-    iter(N, 1, &initial, &reverseMap);
+    iter(MAX_TABLE_PUYOS, 1, &initial, &reverseMap);
 
     CHECK(initial.size() == 0);
 
-    //
+    ownedTable_.assign(tableSize_, -1.0);
     for (const auto& entry : reverseMap) {
         ColumnPuyoList cpl;
         for (int x = 1; x <= 6; ++x) {
@@ -221,32 +259,39 @@ ColumnPuyoListProbability::ColumnPuyoListProbability()
             }
         }
 
-        m_[cpl] = entry.second;
+        int index = indexOf(cpl);
+        CHECK_GE(index, 0) << cpl.toString();
+        ownedTable_[index] = entry.second;
     }
 
-    vector<double> vs(m_.size());
-    size_t index = 0;
-    iterForSave(N, 1, &initial, m_, &vs, &index);
-    CHECK(initial.size() == 0);
+    for (double v : ownedTable_)
+        CHECK_GE(v, 0.0);
 
-    CHECK_EQ(vs.size(), index);
+    table_ = ownedTable_.data();
+}
 
-    ofstream ofs(filename);
-    ofs.write(reinterpret_cast<char*>(vs.data()), sizeof(double) * vs.size());
+bool ColumnPuyoListProbability::saveTable(const string& filename) const
+{
+    file::BinaryImageWriter writer(IMAGE_KIND, IMAGE_VERSION, tableSize_);
+    writer.writeArray(ownedTable_);
+    return writer.save(filename);
 }
 
 // static
 const ColumnPuyoListProbability* ColumnPuyoListProbability::instanceSlow()
 {
-    static std::unique_ptr<ColumnPuyoListProbability> s_instance(new ColumnPuyoListProbability);
+    static std::unique_ptr<ColumnPuyoListProbability> s_instance(FLAGS_probability_image_dir.empty() ?
+        new ColumnPuyoListProbability :
+        new ColumnPuyoListProbability(file::joinPath(FLAGS_probability_image_dir,
+                                                     "column-puyo-list-probability-" + std::to_string(MAX_TABLE_PUYOS) + ".bin")));
     return s_instance.get();
 }
 
 double ColumnPuyoListProbability::necessaryKumipuyos(const ColumnPuyoList& cpl) const
 {
-    auto it = m_.find(cpl);
-    if (it != m_.end())
-        return it->second;
+    int index = indexOf(cpl);
+    if (index >= 0)
+        return table_[index];
 
     // TODO(mayah): This is not accurate, but better than returning infinity.
     PuyoSet ps(cpl);
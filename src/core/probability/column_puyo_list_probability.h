@@ -2,24 +2,52 @@
 #define CORE_PROBABILITY_COLUMN_PUYO_LIST_PROBABILITY_H_
 
 #include <memory>
-#include <unordered_map>
+#include <string>
+#include <vector>
 
+#include "base/file/binary_image.h"
 #include "base/noncopyable.h"
 #include "core/column_puyo_list.h"
 
 class ColumnPuyoListProbability : noncopyable, nonmovable {
 public:
     // Taking ColumnPuyoListProbability instance. This might be slow.
+    // The table is mapped from the image in --probability_image_dir, which is the build directory
+    // by default. A missing image is computed and saved there, so it's computed only once.
     static const ColumnPuyoListProbability* instanceSlow();
 
+    // Computes the table.
+    ColumnPuyoListProbability();
+    // Maps the table from the image |imageFilename|. When the image doesn't exist or is broken,
+    // the table is computed and saved to |imageFilename|.
+    explicit ColumnPuyoListProbability(const std::string& imageFilename);
+
     // Returns the expected numbef of kumipuyos to fill ColumnPuyoList.
-    // NOTE: currently this is not thread-safe.
+    // The table is immutable after construction, so this is thread-safe.
     double necessaryKumipuyos(const ColumnPuyoList&) const;
 
 private:
-    ColumnPuyoListProbability();
+    // The table has all ColumnPuyoList that have at most MAX_TABLE_PUYOS normal puyos.
+    static const int MAX_TABLE_PUYOS = 6;
+
+    // Returns the index of |cpl| in the table, or -1 if |cpl| is not in the table.
+    int indexOf(const ColumnPuyoList& cpl) const;
+
+    void makeOffsets();
+    bool loadTable(const std::string& filename);
+    void makeTable();
+    bool saveTable(const std::string& filename) const;
+
+    // The lists are ordered by the sizes of the columns first, then by the colors.
+    // offsets_[sizes] is the index of the first list that has |sizes|, where |sizes| is
+    // the column sizes encoded in base (MAX_TABLE_PUYOS + 1).
+    std::vector<int> offsets_;
+    int tableSize_;
 
-    std::unordered_map<ColumnPuyoList, double> m_;
+    // |table_| points to |ownedTable_| when the table is computed, or to |image_| when it's mapped.
+    const double* table_;
+    std::vector<double> ownedTable_;
+    file::BinaryImageReader image_;
 };
 
 #endif // CORE_PROBABILITY_COLUMN_PUYO_LIST_PROBABILITY_H_
@@ -0,0 +1,113 @@
+#include "core/probability/column_puyo_list_probability.h"
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/file/path.h"
+#include "base/file/temporary_file.h"
+#include "base/time.h"
+#include "base/time_stamp_counter.h"
+
+using namespace std;
+
+namespace {
+
+vector<ColumnPuyoList> makeColumnPuyoLists()
+{
+    const ColumnPuyo puyos[] = {
+        ColumnPuyo(1, PuyoColor::RED), ColumnPuyo(3, PuyoColor::BLUE),
+        ColumnPuyo(1, PuyoColor::YELLOW), ColumnPuyo(4, PuyoColor::GREEN),
+        ColumnPuyo(6, PuyoColor::RED), ColumnPuyo(2, PuyoColor::RED),
+        ColumnPuyo(2, PuyoColor::BLUE), ColumnPuyo(5, PuyoColor::GREEN),
+    };
+
+    vector<ColumnPuyoList> cpls;
+    for (int bits = 0; bits < (1 << 8); ++bits) {
+        ColumnPuyoList cpl;
+        for (int i = 0; i < 8; ++i) {
+            if (bits & (1 << i))
+                cpl.add(puyos[i]);
+        }
+        cpls.push_back(cpl);
+    }
+    return cpls;
+}
+
+}
+
+TEST(ColumnPuyoListProbabilityPerformanceTest, startup)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    ASSERT_TRUE(file::remove(filename));
+
+    {
+        double beginTime = currentTime();
+        ColumnPuyoListProbability prob(filename);
+        double endTime = currentTime();
+        cout << "compute: " << (endTime - beginTime) * 1000 << " [ms]" << endl;
+    }
+
+    {
+        double beginTime = currentTime();
+        ColumnPuyoListProbability prob(filename);
+        double endTime = currentTime();
+        cout << "image: " << (endTime - beginTime) * 1000 << " [ms]" << endl;
+    }
+}
+
+TEST(ColumnPuyoListProbabilityPerformanceTest, necessaryKumipuyos)
+{
+    double beginTime = currentTime();
+    const ColumnPuyoListProbability* instance = ColumnPuyoListProbability::instanceSlow();
+    double endTime = currentTime();
+    cout << "instanceSlow: " << (endTime - beginTime) * 1000 << " [ms]" << endl;
+
+    const vector<ColumnPuyoList> cpls = makeColumnPuyoLists();
+
+    TimeStampCounterData tsc;
+    double sum = 0;
+    for (int i = 0; i < 1000; ++i) {
+        ScopedTimeStampCounter stsc(&tsc);
+        for (const auto& cpl : cpls)
+            sum += instance->necessaryKumipuyos(cpl);
+    }
+
+    cout << "sum: " << sum << endl;
+    tsc.showStatistics();
+}
+
+TEST(ColumnPuyoListProbabilityPerformanceTest, necessaryKumipuyosConcurrently)
+{
+    const ColumnPuyoListProbability* instance = ColumnPuyoListProbability::instanceSlow();
+    const vector<ColumnPuyoList> cpls = makeColumnPuyoLists();
+
+    vector<double> expected;
+    for (const auto& cpl : cpls)
+        expected.push_back(instance->necessaryKumipuyos(cpl));
+
+    const int numThreads = 4;
+    vector<vector<double>> results(numThreads);
+    vector<thread> threads;
+    double beginTime = currentTime();
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                results[t].clear();
+                for (const auto& cpl : cpls)
+                    results[t].push_back(instance->necessaryKumipuyos(cpl));
+            }
+        });
+    }
+    for (auto& th : threads)
+        th.join();
+    double endTime = currentTime();
+    cout << numThreads << " threads: " << (endTime - beginTime) * 1000 << " [ms]" << endl;
+
+    for (int t = 0; t < numThreads; ++t)
+        EXPECT_EQ(expected, results[t]);
+}
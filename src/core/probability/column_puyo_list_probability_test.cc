@@ -1,7 +1,183 @@
 #include "core/probability/column_puyo_list_probability.h"
 
+#include <limits>
+#include <string>
+#include <unordered_map>
+
 #include <gtest/gtest.h>
 
+#include "base/file/path.h"
+#include "base/file/temporary_file.h"
+#include "core/kumipuyo.h"
+
+using namespace std;
+
+namespace {
+
+// The map ColumnPuyoListProbability had before it had the table, as the reference.
+
+const Kumipuyo ALL_KUMIPUYO_KINDS[] = {
+    Kumipuyo(PuyoColor::RED, PuyoColor::RED),
+    Kumipuyo(PuyoColor::RED, PuyoColor::BLUE),
+    Kumipuyo(PuyoColor::RED, PuyoColor::YELLOW),
+    Kumipuyo(PuyoColor::RED, PuyoColor::GREEN),
+    Kumipuyo(PuyoColor::BLUE, PuyoColor::BLUE),
+    Kumipuyo(PuyoColor::BLUE, PuyoColor::YELLOW),
+    Kumipuyo(PuyoColor::BLUE, PuyoColor::GREEN),
+    Kumipuyo(PuyoColor::YELLOW, PuyoColor::YELLOW),
+    Kumipuyo(PuyoColor::YELLOW, PuyoColor::GREEN),
+    Kumipuyo(PuyoColor::GREEN, PuyoColor::GREEN),
+};
+
+double necessaryPuyosReverse(const ColumnPuyoList& cpl, unordered_map<ColumnPuyoList, double>* m)
+{
+    // for child state i:
+    // transition possibility: p_i
+    // the necessary puyos: s_i
+    //
+    // s = (1 + \sum p_i s_i) / \sum p_i
+
+    auto it = m->find(cpl);
+    if (it != m->end())
+        return it->second;
+
+    double s = 16;
+    int puttableCount = 0;
+    for (const auto& kp : ALL_KUMIPUYO_KINDS) {
+
+        double p = numeric_limits<double>::infinity();
+        bool puttable = false;
+        bool used = false;
+
+        // put vertically
+        for (int x = 1; x <= 6; ++x) {
+            if (cpl.sizeOn(x) >= 2) {
+                if ((cpl.get(x, cpl.sizeOn(x) - 1) == kp.axis && cpl.get(x, cpl.sizeOn(x) - 2) == kp.child) ||
+                    (cpl.get(x, cpl.sizeOn(x) - 1) == kp.child && cpl.get(x, cpl.sizeOn(x) - 2) == kp.axis)) {
+                    // ok
+                    puttable = true;
+                    used = true;
+
+                    ColumnPuyoList tmp(cpl);
+                    tmp.removeTopFrom(x);
+                    tmp.removeTopFrom(x);
+                    p = std::min(p, necessaryPuyosReverse(tmp, m));
+                }
+            } else if (cpl.sizeOn(x) == 1) {
+                if (cpl.top(x) == kp.axis || cpl.top(x) == kp.child) {
+                    // ok
+                    puttable = true;
+                    used = true;
+
+                    ColumnPuyoList tmp(cpl);
+                    tmp.removeTopFrom(x);
+                    p = std::min(p, necessaryPuyosReverse(tmp, m));
+                }
+            } else {
+                // ok, but not used.
+                puttable = true;
+            }
+        }
+
+        // put horizontally
+        for (int x = 1; x <= 5; ++x) {
+            if (cpl.sizeOn(x) >= 1 && cpl.sizeOn(x + 1) >= 1) {
+                if ((cpl.top(x) == kp.axis && cpl.top(x + 1) == kp.child) || (cpl.top(x) == kp.child && cpl.top(x + 1) == kp.axis)) {
+                    puttable = true;
+                    used = true;
+
+                    ColumnPuyoList tmp(cpl);
+                    tmp.removeTopFrom(x);
+                    tmp.removeTopFrom(x + 1);
+                    p = std::min(p, necessaryPuyosReverse(tmp, m));
+                }
+            } else if (cpl.sizeOn(x) >= 1 && cpl.sizeOn(x + 1) == 0) {
+                if (cpl.top(x) == kp.axis || cpl.top(x) == kp.child) {
+                    puttable = true;
+                    used = true;
+
+                    ColumnPuyoList tmp(cpl);
+                    tmp.removeTopFrom(x);
+                    p = std::min(p, necessaryPuyosReverse(tmp, m));
+                }
+            }
+        }
+
+        if (cpl.sizeOn(5) == 0 && cpl.sizeOn(6) >= 1) {
+            if (cpl.top(6) == kp.axis || cpl.top(6) == kp.child) {
+                puttable = true;
+                used = true;
+
+                ColumnPuyoList tmp(cpl);
+                tmp.removeTopFrom(6);
+                p = std::min(p, necessaryPuyosReverse(tmp, m));
+            }
+        }
+
+        if (!puttable) {
+            (*m)[cpl] = numeric_limits<double>::infinity();
+            return numeric_limits<double>::infinity();
+        }
+
+        if (used) {
+            if (kp.axis == kp.child) {
+                s += p;
+                puttableCount += 1;
+            } else {
+                s += p * 2;
+                puttableCount += 2;
+            }
+        }
+    }
+
+    double p = s / puttableCount;
+    (*m)[cpl] = p;
+    return p;
+}
+
+void iter(int n, int leftX, ColumnPuyoList* cpl, unordered_map<ColumnPuyoList, double>* m)
+{
+    necessaryPuyosReverse(*cpl, m);
+
+    for (int x = leftX; x <= 6; ++x) {
+        for (PuyoColor c : NORMAL_PUYO_COLORS) {
+            cpl->add(x, c);
+            if (n > 0)
+                iter(n - 1, x, cpl, m);
+            cpl->removeTopFrom(x);
+        }
+    }
+}
+
+unordered_map<ColumnPuyoList, double> makeReferenceMap()
+{
+    unordered_map<ColumnPuyoList, double> reverseMap;
+    ColumnPuyoList initial;
+    reverseMap[initial] = 0.0;
+    iter(6, 1, &initial, &reverseMap);
+
+    unordered_map<ColumnPuyoList, double> m;
+    for (const auto& entry : reverseMap) {
+        ColumnPuyoList cpl;
+        for (int x = 1; x <= 6; ++x) {
+            for (int i = entry.first.sizeOn(x) - 1; i >= 0; --i) {
+                cpl.add(x, entry.first.get(x, i));
+            }
+        }
+
+        m[cpl] = entry.second;
+    }
+    return m;
+}
+
+void expectSameAsReference(const unordered_map<ColumnPuyoList, double>& m, const ColumnPuyoListProbability& prob)
+{
+    for (const auto& entry : m)
+        ASSERT_EQ(entry.second, prob.necessaryKumipuyos(entry.first)) << entry.first.toString();
+}
+
+} // anonymous namespace
+
 TEST(ColumnPuyoListProbabilityTest, necessaryPuyosWithColumnPuyoList)
 {
     const ColumnPuyoListProbability* instance = ColumnPuyoListProbability::instanceSlow();
@@ -15,3 +191,19 @@ TEST(ColumnPuyoListProbabilityTest, necessaryPuyosWithColumnPuyoList)
     cpl.add(2, PuyoColor::RED);
     EXPECT_DOUBLE_EQ(13.0 * 16 / 49, instance->necessaryKumipuyos(cpl));
 }
+
+TEST(ColumnPuyoListProbabilityTest, sameAsReferenceMap)
+{
+    const unordered_map<ColumnPuyoList, double> m = makeReferenceMap();
+
+    expectSameAsReference(m, *ColumnPuyoListProbability::instanceSlow());
+
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    ASSERT_TRUE(file::remove(filename));
+
+    // The first one computes the table and saves the image, and the second one maps it.
+    expectSameAsReference(m, ColumnPuyoListProbability(filename));
+    ASSERT_TRUE(file::exists(filename));
+    expectSameAsReference(m, ColumnPuyoListProbability(filename));
+}
@@ -1,13 +1,102 @@
 #include "core/probability/puyo_set_probability.h"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 
+#include <gflags/gflags.h>
+
+#include "base/file/path.h"
 #include "core/kumipuyo_seq.h"
 
 using namespace std;
 
-PuyoSetProbability::PuyoSetProbability()
+DEFINE_string(probability_image_dir, BUILD_DIR,
+              "The probability tables are mapped from the images in this directory. "
+              "A missing image is computed and saved there. If empty, the tables are computed.");
+
+namespace {
+
+const uint32_t IMAGE_KIND = 0x42505350; // "PSPB"
+const uint32_t IMAGE_VERSION = 1;
+
+}
+
+PuyoSetProbability::PuyoSetProbability() :
+    tableSize_(0),
+    table_(nullptr)
+{
+    makeRowOffsets();
+    makeTable();
+}
+
+PuyoSetProbability::PuyoSetProbability(const string& imageFilename) :
+    tableSize_(0),
+    table_(nullptr)
+{
+    makeRowOffsets();
+    if (loadImage(imageFilename))
+        return;
+
+    makeTable();
+    if (!saveImage(imageFilename))
+        LOG(WARNING) << "failed to save " << imageFilename;
+}
+
+void PuyoSetProbability::makeRowOffsets()
+{
+    rowOffsets_.assign(MAX_N * MAX_N * MAX_N * MAX_N, -1);
+
+    // Assigns rows to the sorted (a, b, c, d) first.
+    for (int a = 0; a < MAX_N; ++a) {
+        for (int b = 0; b <= a; ++b) {
+            for (int c = 0; c <= b; ++c) {
+                for (int d = 0; d <= c; ++d) {
+                    rowOffsets_[((a * MAX_N + b) * MAX_N + c) * MAX_N + d] = tableSize_;
+                    tableSize_ += MAX_K;
+                }
+            }
+        }
+    }
+
+    for (int a = 0; a < MAX_N; ++a) {
+        for (int b = 0; b < MAX_N; ++b) {
+            for (int c = 0; c < MAX_N; ++c) {
+                for (int d = 0; d < MAX_N; ++d) {
+                    int vs[4] = { a, b, c, d };
+                    sort(vs, vs + 4, greater<int>());
+                    rowOffsets_[((a * MAX_N + b) * MAX_N + c) * MAX_N + d] =
+                        rowOffsets_[((vs[0] * MAX_N + vs[1]) * MAX_N + vs[2]) * MAX_N + vs[3]];
+                }
+            }
+        }
+    }
+}
+
+bool PuyoSetProbability::loadImage(const string& filename)
+{
+    if (!image_.open(filename, IMAGE_KIND, IMAGE_VERSION, tableSize_))
+        return false;
+
+    const double* table;
+    uint32_t size;
+    if (!image_.readArrayView(&table, &size) || size != static_cast<uint32_t>(tableSize_)) {
+        LOG(WARNING) << "broken table: " << filename;
+        return false;
+    }
+
+    table_ = table;
+    return true;
+}
+
+bool PuyoSetProbability::saveImage(const string& filename) const
+{
+    file::BinaryImageWriter writer(IMAGE_KIND, IMAGE_VERSION, tableSize_);
+    writer.writeArray(vector<double>(table_, table_ + tableSize_));
+    return writer.save(filename);
+}
+
+void PuyoSetProbability::makeTable()
 {
     auto p = new double[MAX_N][MAX_N][MAX_N][MAX_N][MAX_K];
     auto q = new double[MAX_N][MAX_N][MAX_N][MAX_N][MAX_K];
@@ -96,17 +185,20 @@ PuyoSetProbability::PuyoSetProbability()
         }
     }
 
+    ownedTable_.resize(tableSize_);
     for (int a = 0; a < MAX_N; ++a) {
-        for (int b = 0; b < MAX_N; ++b) {
-            for (int c = 0; c < MAX_N; ++c) {
-                for (int d = 0; d < MAX_N; ++d) {
+        for (int b = 0; b <= a; ++b) {
+            for (int c = 0; c <= b; ++c) {
+                for (int d = 0; d <= c; ++d) {
+                    int offset = rowOffsets_[((a * MAX_N + b) * MAX_N + c) * MAX_N + d];
                     for (int k = 0; k < MAX_K; ++k) {
-                        p_[a][b][c][d][k] = p[a][b][c][d][k];
+                        ownedTable_[offset + k] = p[a][b][c][d][k];
                     }
                 }
             }
         }
     }
+    table_ = ownedTable_.data();
 
     delete[] p;
     delete[] q;
@@ -114,7 +206,9 @@ PuyoSetProbability::PuyoSetProbability()
 
 const PuyoSetProbability* PuyoSetProbability::instanceSlow()
 {
-    static std::unique_ptr<PuyoSetProbability> s_instance(new PuyoSetProbability);
+    static std::unique_ptr<PuyoSetProbability> s_instance(FLAGS_probability_image_dir.empty() ?
+        new PuyoSetProbability :
+        new PuyoSetProbability(file::joinPath(FLAGS_probability_image_dir, "puyo-set-probability.bin")));
     return s_instance.get();
 }
 
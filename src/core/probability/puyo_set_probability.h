@@ -4,7 +4,10 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <string>
+#include <vector>
 
+#include "base/file/binary_image.h"
 #include "base/noncopyable.h"
 #include "core/probability/puyo_set.h"
 
@@ -13,21 +16,24 @@ class KumipuyoSeq;
 class PuyoSetProbability : noncopyable, nonmovable {
 public:
     // Returns PuyoSetProbability instance. This might take time.
+    // The table is mapped from the image in --probability_image_dir, which is the build directory
+    // by default. A missing image is computed and saved there, so it's computed only once.
     static const PuyoSetProbability* instanceSlow();
 
+    // Computes the table.
     PuyoSetProbability();
+    // Maps the table from the image |imageFilename|. When the image doesn't exist or is broken,
+    // the table is computed and saved to |imageFilename|.
+    explicit PuyoSetProbability(const std::string& imageFilename);
+
+    bool saveImage(const std::string& filename) const;
 
     // Returns the possibility that when there are randomly |k| puyos,
     // that set will contain |puyoSet|.
     double possibility(const PuyoSet& puyoSet, int k) const
     {
-        int a = std::min(MAX_N - 1, puyoSet.red());
-        int b = std::min(MAX_N - 1, puyoSet.blue());
-        int c = std::min(MAX_N - 1, puyoSet.yellow());
-        int d = std::min(MAX_N - 1, puyoSet.green());
         int kk = std::min(MAX_K - 1, k);
-
-        return p_[a][b][c][d][kk];
+        return row(puyoSet)[kk];
     }
 
     // Returns how many puyos are required to get |puyoSet| with possibility |threshold|?
@@ -35,12 +41,7 @@ public:
     {
         DCHECK(0 <= threshold && threshold <= 1.0) << threshold;
 
-        int a = std::min(MAX_N - 1, puyoSet.red());
-        int b = std::min(MAX_N - 1, puyoSet.blue());
-        int c = std::min(MAX_N - 1, puyoSet.yellow());
-        int d = std::min(MAX_N - 1, puyoSet.green());
-
-        const double* p = p_[a][b][c][d];
+        const double* p = row(puyoSet);
 
         for (int k = 0; k < MAX_K; ++k) {
             if (p[k] >= threshold)
@@ -58,7 +59,29 @@ private:
     static const int MAX_N = 16;
     static const int MAX_K = 32;
 
-    double p_[MAX_N][MAX_N][MAX_N][MAX_N][MAX_K];
+    // The possibility doesn't change when the colors are permuted, so the table only has
+    // the rows for a >= b >= c >= d. |rowOffsets_| maps any (a, b, c, d) to its row.
+    const double* row(const PuyoSet& puyoSet) const
+    {
+        int a = std::min(MAX_N - 1, puyoSet.red());
+        int b = std::min(MAX_N - 1, puyoSet.blue());
+        int c = std::min(MAX_N - 1, puyoSet.yellow());
+        int d = std::min(MAX_N - 1, puyoSet.green());
+
+        return table_ + rowOffsets_[((a * MAX_N + b) * MAX_N + c) * MAX_N + d];
+    }
+
+    void makeRowOffsets();
+    void makeTable();
+    bool loadImage(const std::string& filename);
+
+    std::vector<int> rowOffsets_;
+    int tableSize_;
+
+    // |table_| points to |ownedTable_| when the table is computed, or to |image_| when it's mapped.
+    const double* table_;
+    std::vector<double> ownedTable_;
+    file::BinaryImageReader image_;
 };
 
 #endif // CORE_PROBABILITY_PUYO_POSSIBILITY_H_
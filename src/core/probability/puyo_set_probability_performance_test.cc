@@ -0,0 +1,34 @@
+#include "core/probability/puyo_set_probability.h"
+
+#include <iostream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "base/file/path.h"
+#include "base/file/temporary_file.h"
+#include "base/time.h"
+
+using namespace std;
+
+TEST(PuyoSetProbabilityPerformanceTest, startup)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    ASSERT_TRUE(file::remove(filename));
+
+    {
+        double beginTime = currentTime();
+        PuyoSetProbability prob;
+        double endTime = currentTime();
+        cout << "compute: " << (endTime - beginTime) * 1000 << " [ms]" << endl;
+        ASSERT_TRUE(prob.saveImage(filename));
+    }
+
+    {
+        double beginTime = currentTime();
+        PuyoSetProbability prob(filename);
+        double endTime = currentTime();
+        cout << "image: " << (endTime - beginTime) * 1000 << " [ms]" << endl;
+    }
+}
@@ -1,11 +1,75 @@
 #include "core/probability/puyo_set_probability.h"
 
+#include <memory>
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include "base/file/path.h"
+#include "base/file/temporary_file.h"
 #include "core/kumipuyo_seq.h"
 
 using namespace std;
 
+namespace {
+
+const int MAX_N = 16;
+const int MAX_K = 32;
+
+typedef double FullTable[MAX_N][MAX_N][MAX_N][MAX_K];
+
+// Computes the full table of the possibilities in the way PuyoSetProbability did
+// before the table was reduced by the symmetry, as a reference.
+unique_ptr<FullTable[]> makeFullTable()
+{
+    unique_ptr<FullTable[]> p(new FullTable[MAX_N]());
+    unique_ptr<FullTable[]> q(new FullTable[MAX_N]());
+
+    p[0][0][0][0][0] = 1;
+    for (int a = 0; a + 1 < MAX_N; ++a) {
+        for (int b = 0; b + 1 < MAX_N && a + b + 1 < MAX_K; ++b) {
+            for (int c = 0; c + 1 < MAX_N && a + b + c + 1 < MAX_K; ++c) {
+                for (int d = 0; d + 1 < MAX_N && a + b + c + d + 1 < MAX_K; ++d) {
+                    int k = a + b + c + d;
+                    p[a+1][b][c][d][k+1] += p[a][b][c][d][k] / 4;
+                    p[a][b+1][c][d][k+1] += p[a][b][c][d][k] / 4;
+                    p[a][b][c+1][d][k+1] += p[a][b][c][d][k] / 4;
+                    p[a][b][c][d+1][k+1] += p[a][b][c][d][k] / 4;
+                }
+            }
+        }
+    }
+
+    // Sums up the possibilities of the sets which contain (a, b, c, d), one color at a time.
+    for (int t = 1; t <= 4; ++t) {
+        swap(p, q);
+        for (int a = MAX_N - 1; a >= 0; --a) {
+            for (int b = MAX_N - 1; b >= 0; --b) {
+                for (int c = MAX_N - 1; c >= 0; --c) {
+                    for (int d = MAX_N - 1; d >= 0; --d) {
+                        for (int k = 0; k < MAX_K; ++k) {
+                            double v = q[a][b][c][d][k];
+                            if (t == 1 && d + 1 < MAX_N)
+                                v += p[a][b][c][d+1][k];
+                            else if (t == 2 && c + 1 < MAX_N)
+                                v += p[a][b][c+1][d][k];
+                            else if (t == 3 && b + 1 < MAX_N)
+                                v += p[a][b+1][c][d][k];
+                            else if (t == 4 && a + 1 < MAX_N)
+                                v += p[a+1][b][c][d][k];
+                            p[a][b][c][d][k] = v;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return p;
+}
+
+} // namespace
+
 TEST(PuyoSetProbabilityTest, possibility)
 {
     const PuyoSetProbability* prob = PuyoSetProbability::instanceSlow();
@@ -96,3 +160,71 @@ TEST(PuyoSetProbabilityTest, necessaryPuyosWithKumipuyoSeq)
 
     EXPECT_EQ(9, prob->necessaryPuyos(PuyoSet(2, 0, 0, 0), KumipuyoSeq("GG"), 0.5));
 }
+
+TEST(PuyoSetProbabilityTest, symmetric)
+{
+    const PuyoSetProbability* prob = PuyoSetProbability::instanceSlow();
+
+    for (int k = 0; k < 20; ++k) {
+        double p = prob->possibility(PuyoSet(3, 2, 1, 0), k);
+        EXPECT_EQ(p, prob->possibility(PuyoSet(0, 1, 2, 3), k));
+        EXPECT_EQ(p, prob->possibility(PuyoSet(2, 0, 3, 1), k));
+        EXPECT_EQ(p, prob->possibility(PuyoSet(1, 3, 0, 2), k));
+    }
+}
+
+TEST(PuyoSetProbabilityTest, sameAsFullTable)
+{
+    unique_ptr<FullTable[]> full = makeFullTable();
+    PuyoSetProbability prob;
+
+    // The reduced table is summed up in another order, so the last bits might differ.
+    for (int a = 0; a < MAX_N; ++a) {
+        for (int b = 0; b < MAX_N; ++b) {
+            for (int c = 0; c < MAX_N; ++c) {
+                for (int d = 0; d < MAX_N; ++d) {
+                    PuyoSet ps(a, b, c, d);
+                    for (int k = 0; k < MAX_K; ++k)
+                        ASSERT_NEAR(full[a][b][c][d][k], prob.possibility(ps, k), 1e-15) << ps.toString() << ' ' << k;
+
+                    for (double threshold : { 0.1, 0.5, 0.9 }) {
+                        int expected = MAX_K;
+                        for (int k = MAX_K - 1; k >= 0; --k) {
+                            if (full[a][b][c][d][k] >= threshold)
+                                expected = k;
+                        }
+                        ASSERT_EQ(expected, prob.necessaryPuyos(ps, threshold)) << ps.toString() << ' ' << threshold;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(PuyoSetProbabilityTest, image)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    ASSERT_TRUE(file::remove(filename));
+
+    PuyoSetProbability computed;
+    // The first one computes the table and saves it, and the second one maps it.
+    PuyoSetProbability saved(filename);
+    PuyoSetProbability loaded(filename);
+
+    // Covers the saturated counts as well.
+    for (int a = 0; a <= 16; ++a) {
+        for (int b = 0; b <= 16; ++b) {
+            for (int c = 0; c <= 16; ++c) {
+                for (int d = 0; d <= 16; ++d) {
+                    PuyoSet ps(a, b, c, d);
+                    for (int k = 0; k <= 32; ++k) {
+                        ASSERT_EQ(computed.possibility(ps, k), saved.possibility(ps, k));
+                        ASSERT_EQ(computed.possibility(ps, k), loaded.possibility(ps, k));
+                    }
+                    ASSERT_EQ(computed.necessaryPuyos(ps, 0.5), loaded.necessaryPuyos(ps, 0.5));
+                }
+            }
+        }
+    }
+}
@@ -76,18 +76,14 @@ const int EXTENTIONS[][3][2] = {
     {{-1, 1}, { 0, 1}, { 0, 2}},
 };
 
-}  // namespace anomymous
-
-// detectByDropStrategy complements puyos in |originalField|, and fires a rensa.
-// The complemented puyos are always grounded (This is the different point of tryFloatFire).
-// For each detected rensa, |callback| is called.
-// static
-void RensaDetector::detectByDropStrategy(const CoreField& originalField,
-                                         const bool prohibits[FieldConstant::MAP_WIDTH],
-                                         PurposeForFindingRensa purpose,
-                                         int maxComplementPuyos,
-                                         int maxPuyoHeight,
-                                         const RensaDetector::ComplementCallback& callback)
+// Iterates the complemented fields of DROP strategy. See RensaDetector::detectByDropStrategy().
+template<typename Callback>
+void iterateDropStrategy(const CoreField& originalField,
+                         const bool prohibits[FieldConstant::MAP_WIDTH],
+                         PurposeForFindingRensa purpose,
+                         int maxComplementPuyos,
+                         int maxPuyoHeight,
+                         const Callback& callback)
 {
     bool visited[FieldConstant::MAP_WIDTH][NUM_PUYO_COLORS] {};
 
@@ -164,6 +160,50 @@ void RensaDetector::detectByDropStrategy(const CoreField& originalField,
     });
 }
 
+}  // namespace anomymous
+
+// detectByDropStrategy complements puyos in |originalField|, and fires a rensa.
+// The complemented puyos are always grounded (This is the different point of tryFloatFire).
+// For each detected rensa, |callback| is called.
+// static
+void RensaDetector::detectByDropStrategy(const CoreField& originalField,
+                                         const bool prohibits[FieldConstant::MAP_WIDTH],
+                                         PurposeForFindingRensa purpose,
+                                         int maxComplementPuyos,
+                                         int maxPuyoHeight,
+                                         const RensaDetector::ComplementCallback& callback)
+{
+    iterateDropStrategy(originalField, prohibits, purpose, maxComplementPuyos, maxPuyoHeight, callback);
+}
+
+// static
+void RensaDetector::detectMaxChainsByDropStrategy(const CoreField* fields,
+                                                  size_t numFields,
+                                                  const bool prohibits[FieldConstant::MAP_WIDTH],
+                                                  PurposeForFindingRensa purpose,
+                                                  int maxComplementPuyos,
+                                                  int maxPuyoHeight,
+                                                  DropStrategyScratch* scratch,
+                                                  int* maxChains)
+{
+    // Makes the complemented fields of all the fields first, and then simulates them in one loop.
+    scratch->complementedFields.clear();
+    scratch->fieldIndices.clear();
+    for (size_t i = 0; i < numFields; ++i) {
+        maxChains[i] = 0;
+        iterateDropStrategy(fields[i], prohibits, purpose, maxComplementPuyos, maxPuyoHeight,
+                            [scratch, i](CoreField&& cf, const ColumnPuyoList&) {
+            scratch->complementedFields.push_back(std::move(cf));
+            scratch->fieldIndices.push_back(static_cast<int>(i));
+        });
+    }
+
+    for (size_t j = 0; j < scratch->complementedFields.size(); ++j) {
+        int* chains = &maxChains[scratch->fieldIndices[j]];
+        *chains = std::max(*chains, scratch->complementedFields[j].simulateFast());
+    }
+}
+
 // static
 void RensaDetector::detectByFloatStrategy(const CoreField& originalField,
                                           const bool prohibits[FieldConstant::MAP_WIDTH],
@@ -1,7 +1,9 @@
 #ifndef CORE_RENSA_RENSA_DETECTOR_H_
 #define CORE_RENSA_RENSA_DETECTOR_H_
 
+#include <cstddef>
 #include <functional>
+#include <vector>
 
 #include "base/base.h"
 #include "core/rensa/rensa_detector_strategy.h"
@@ -21,6 +23,13 @@ enum class PurposeForFindingRensa {
 // Using detectIteratively() is recommended for most cases.
 class RensaDetector {
 public:
+    // The buffers that detectMaxChainsByDropStrategy() shares across the fields of a batch.
+    // Keep one across the batches not to reallocate them.
+    struct DropStrategyScratch {
+        std::vector<CoreField> complementedFields;
+        std::vector<int> fieldIndices;
+    };
+
     typedef std::function<void (CoreField&& complementedField,
                                 const ColumnPuyoList& complementedColumnPuyoList)> ComplementCallback;
 
@@ -58,6 +67,19 @@ public:
                                      int maxComplementPuyos,
                                      int maxPuyoHeight,
                                      const ComplementCallback&);
+    // Detects rensas of each of |fields| by DROP strategy, and simulates them with simulateFast().
+    // |maxChains[i]| will be the max chains of the rensas of |fields[i]|, or 0 if no rensa
+    // is found. |maxChains| should have |numFields| elements.
+    // The max chains are the same as detectByDropStrategy() gives, but the complemented fields
+    // of all |fields| are made in |scratch| first, and simulated in one loop after that.
+    static void detectMaxChainsByDropStrategy(const CoreField* fields,
+                                              size_t numFields,
+                                              const bool prohibits[FieldConstant::MAP_WIDTH],
+                                              PurposeForFindingRensa,
+                                              int maxComplementPuyos,
+                                              int maxPuyoHeight,
+                                              DropStrategyScratch* scratch,
+                                              int* maxChains);
     // Detects rensa by FLOAT strategy.
     static void detectByFloatStrategy(const CoreField&,
                                       const bool prohibits[FieldConstant::MAP_WIDTH],
@@ -2,9 +2,13 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
+#include <random>
+#include <vector>
 
+#include "base/time.h"
 #include "base/time_stamp_counter.h"
 #include "core/core_field.h"
 
@@ -79,3 +83,71 @@ TEST(RensaDetectorPerformanceTest, detectIteratively_Extend)
 
     tsc.showStatistics();
 }
+
+namespace {
+
+// Makes |n| fields by dropping random puyos. The fields don't have a rensa to vanish.
+vector<CoreField> makeRandomFields(int n)
+{
+    mt19937 mt(1);
+    vector<CoreField> fields;
+    while (static_cast<int>(fields.size()) < n) {
+        CoreField cf;
+        int numPuyos = 8 + mt() % 32;
+        for (int i = 0; i < numPuyos; ++i) {
+            int x = 1 + mt() % 6;
+            PuyoColor c = NORMAL_PUYO_COLORS[mt() % 4];
+            if (cf.height(x) >= 12 || !cf.dropPuyoOn(x, c))
+                continue;
+            if (cf.rensaWillOccur())
+                cf.removePuyoFrom(x);
+        }
+        fields.push_back(cf);
+    }
+    return fields;
+}
+
+} // anonymous namespace
+
+TEST(RensaDetectorPerformanceTest, detectMaxChainsByDropStrategy)
+{
+    const vector<CoreField> fields = makeRandomFields(10000);
+    const bool prohibits[FieldConstant::MAP_WIDTH] {};
+    const int numRepeats = 10;
+
+    vector<int> expected(fields.size());
+    double beginTime = currentTime();
+    for (int r = 0; r < numRepeats; ++r) {
+        for (size_t i = 0; i < fields.size(); ++i) {
+            int maxChains = 0;
+            auto callback = [&maxChains](CoreField&& cf, const ColumnPuyoList&) {
+                maxChains = std::max(maxChains, cf.simulateFast());
+            };
+            RensaDetector::detectByDropStrategy(fields[i], prohibits, PurposeForFindingRensa::FOR_FIRE, 2, 13, callback);
+            expected[i] = maxChains;
+        }
+    }
+    double singleTime = currentTime() - beginTime;
+
+    // The fields are given in the batches of 22 fields, as many as the children of a field
+    // in BeamThinker. The output buffer and the scratch are allocated once, and reused.
+    const size_t batchSize = 22;
+    vector<int> actual(fields.size());
+    RensaDetector::DropStrategyScratch scratch;
+    beginTime = currentTime();
+    for (int r = 0; r < numRepeats; ++r) {
+        for (size_t i = 0; i < fields.size(); i += batchSize) {
+            size_t n = std::min(batchSize, fields.size() - i);
+            RensaDetector::detectMaxChainsByDropStrategy(fields.data() + i, n, prohibits,
+                                                         PurposeForFindingRensa::FOR_FIRE, 2, 13,
+                                                         &scratch, actual.data() + i);
+        }
+    }
+    double batchTime = currentTime() - beginTime;
+
+    EXPECT_EQ(expected, actual);
+
+    double numFields = static_cast<double>(fields.size()) * numRepeats;
+    cout << "detectByDropStrategy: " << numFields / singleTime << " fields/sec" << endl
+         << "detectMaxChainsByDropStrategy: " << numFields / batchTime << " fields/sec" << endl;
+}
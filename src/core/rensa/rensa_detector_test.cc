@@ -47,6 +47,46 @@ TEST(RensaDetectorTest, detectByDropStrategy1)
     EXPECT_TRUE(found);
 }
 
+TEST(RensaDetectorTest, detectMaxChainsByDropStrategy)
+{
+    const CoreField fields[] = {
+        CoreField(),
+        CoreField(
+            ".RGYG."
+            "RGYGB."
+            "RGYGB."
+            "RGYGB."),
+        CoreField(
+            "  R G "
+            "R GRBG"
+            "RBGRBG"
+            "RBGRBG"),
+        CoreField(
+            "B     "
+            "RR    "),
+    };
+    const size_t numFields = ARRAY_SIZE(fields);
+
+    const bool noProhibits[FieldConstant::MAP_WIDTH] {};
+    // The scratch is shared by the batches.
+    RensaDetector::DropStrategyScratch scratch;
+    for (int maxComplementPuyos = 1; maxComplementPuyos <= 3; ++maxComplementPuyos) {
+        int maxChains[numFields];
+        RensaDetector::detectMaxChainsByDropStrategy(fields, numFields, noProhibits, PurposeForFindingRensa::FOR_FIRE,
+                                                     maxComplementPuyos, 12, &scratch, maxChains);
+
+        for (size_t i = 0; i < numFields; ++i) {
+            int expected = 0;
+            auto callback = [&](CoreField&& cf, const ColumnPuyoList&) {
+                expected = std::max(expected, cf.simulateFast());
+            };
+            RensaDetector::detectByDropStrategy(fields[i], noProhibits, PurposeForFindingRensa::FOR_FIRE,
+                                                maxComplementPuyos, 12, callback);
+            EXPECT_EQ(expected, maxChains[i]) << i << ' ' << maxComplementPuyos;
+        }
+    }
+}
+
 TEST(RensaDetectorTest, detectByFloatStrategy1)
 {
     const CoreField original(
@@ -0,0 +1,252 @@
+#ifndef CORE_SEARCH_BEAM_SEARCH_H_
+#define CORE_SEARCH_BEAM_SEARCH_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "base/executor.h"
+#include "base/flat_hash_set.h"
+#include "base/noncopyable.h"
+#include "base/time.h"
+#include "base/wait_group.h"
+
+struct BeamSearchOptions {
+    // The number of the states kept in a layer.
+    int beamWidth = 400;
+    // If set, this overrides |beamWidth| for each turn.
+    std::function<int (int turn)> beamWidthAt;
+    // The search doesn't start a new layer after this time [s] has passed. 0 means no limit.
+    double timeLimit = 0.0;
+    // If set, the states in a layer are expanded in parallel on this executor.
+    // Don't run a search in a task of the same executor, since it waits for the tasks.
+    Executor* executor = nullptr;
+};
+
+struct BeamSearchStats {
+    double statesPerSecond() const { return elapsed > 0 ? numGenerated / elapsed : 0.0; }
+
+    int numLayers = 0;
+    // The number of the expanded states, and the generated children.
+    long long numExpanded = 0;
+    long long numGenerated = 0;
+    // The number of the children removed since another child had the same hash.
+    long long numDuplicated = 0;
+    bool timedOut = false;
+    // [s]
+    double elapsed = 0.0;
+};
+
+template<typename State, typename Better> class BeamSearch;
+
+// BeamSearchEmitter receives the children of states. An emitter is used by one worker.
+template<typename State>
+class BeamSearchEmitter : noncopyable {
+public:
+    // Returns false if a child with |hash| has been already visited by this emitter
+    // in this layer. A caller can skip evaluating the child then.
+    bool visit(std::uint64_t hash) { return visited_.insert(hash); }
+
+    // Adds a child. The children which have the same hash are deduplicated.
+    void emit(State&& state, std::uint64_t hash)
+    {
+        states_.push_back(std::move(state));
+        hashes_.push_back(hash);
+    }
+
+private:
+    template<typename S, typename B> friend class BeamSearch;
+
+    void clear()
+    {
+        visited_.clear();
+        states_.clear();
+        hashes_.clear();
+    }
+
+    FlatHashSet visited_;
+    std::vector<State> states_;
+    std::vector<std::uint64_t> hashes_;
+};
+
+// BeamSearch is a beam search engine. For each layer, it expands all the states,
+// removes the duplicated children by their hash, and keeps the best |beamWidth| children.
+// |Better(lhs, rhs)| should return true if |lhs| is better than |rhs|.
+//
+// The buffers of the layers are reused, and only the indices of the children are
+// sorted, so a State is moved only a few times. The states are expanded in chunks
+// on the executor, and the chunks are merged in order. So the result doesn't
+// depend on the number of threads.
+template<typename State, typename Better = std::greater<State>>
+class BeamSearch : noncopyable {
+public:
+    typedef BeamSearchEmitter<State> Emitter;
+
+    explicit BeamSearch(const BeamSearchOptions& options = BeamSearchOptions(), Better better = Better()) :
+        options_(options),
+        better_(better)
+    {
+        int numEmitters = options_.executor ? std::max(1, options_.executor->numThreads()) : 1;
+        for (int i = 0; i < numEmitters; ++i)
+            emitters_.emplace_back(new Emitter);
+    }
+
+    // Runs the search from |initialStates| for at most |maxTurns| layers, and returns
+    // the last layer, best first.
+    //
+    // |expand(turn, parentIndex, parent, emitter)| should emit the children of |parent|.
+    // This is called from the workers of the executor, so this should be thread-safe.
+    // |onLayer(turn, states)| is called with the states of a new layer, best first.
+    // The search stops when this returns false, no child is generated, or the time is up.
+    template<typename Expand, typename OnLayer>
+    const std::vector<State>& run(std::vector<State> initialStates, int maxTurns, Expand expand, OnLayer onLayer)
+    {
+        reset(std::move(initialStates));
+        double beginTime = currentTime();
+
+        for (int turn = 0; turn < maxTurns; ++turn) {
+            if (options_.timeLimit > 0 && currentTime() - beginTime >= options_.timeLimit) {
+                stats_.timedOut = true;
+                break;
+            }
+
+            if (!step(turn, expand))
+                break;
+            if (!onLayer(turn, static_cast<const std::vector<State>&>(current_)))
+                break;
+        }
+
+        stats_.elapsed = currentTime() - beginTime;
+        return current_;
+    }
+
+    template<typename Expand>
+    const std::vector<State>& run(std::vector<State> initialStates, int maxTurns, Expand expand)
+    {
+        return run(std::move(initialStates), maxTurns, expand, [](int, const std::vector<State>&) { return true; });
+    }
+
+    // Starts a search from |initialStates|, and resets the stats. A caller can run the
+    // search layer by layer with step() instead of run(). The buffers are kept, so a
+    // BeamSearch can be reset and reused for many searches.
+    void reset(std::vector<State> initialStates)
+    {
+        stats_ = BeamSearchStats();
+        current_ = std::move(initialStates);
+    }
+
+    // Expands the current layer as |turn|, and replaces it with the best children.
+    // Returns false if no child is generated. The current layer is kept then.
+    template<typename Expand>
+    bool step(int turn, Expand expand)
+    {
+        if (current_.empty())
+            return false;
+
+        double beginTime = currentTime();
+        int numChunks = expandLayer(turn, expand);
+        bool selected = selectLayer(turn, numChunks);
+        if (selected)
+            ++stats_.numLayers;
+        stats_.elapsed += currentTime() - beginTime;
+        return selected;
+    }
+
+    // The current layer, best first.
+    const std::vector<State>& states() const { return current_; }
+    const BeamSearchStats& stats() const { return stats_; }
+
+private:
+    // Returns the number of the chunks.
+    template<typename Expand>
+    int expandLayer(int turn, Expand& expand)
+    {
+        const int size = static_cast<int>(current_.size());
+        const int numChunks = std::min<int>(emitters_.size(), size);
+        stats_.numExpanded += size;
+
+        auto expandChunk = [this, turn, size, numChunks, &expand](int chunk) {
+            Emitter* emitter = emitters_[chunk].get();
+            emitter->clear();
+            int begin = static_cast<long long>(size) * chunk / numChunks;
+            int end = static_cast<long long>(size) * (chunk + 1) / numChunks;
+            for (int i = begin; i < end; ++i)
+                expand(turn, i, static_cast<const State&>(current_[i]), emitter);
+        };
+
+        if (numChunks <= 1) {
+            expandChunk(0);
+            return 1;
+        }
+
+        WaitGroup wg;
+        wg.add(numChunks);
+        for (int chunk = 0; chunk < numChunks; ++chunk) {
+            options_.executor->submit([&expandChunk, &wg, chunk]() {
+                expandChunk(chunk);
+                wg.done();
+            });
+        }
+        wg.waitUntilDone();
+        return numChunks;
+    }
+
+    // Makes the next layer from the children. Returns false if there is no child.
+    bool selectLayer(int turn, int numChunks)
+    {
+        dedup_.clear();
+        next_.clear();
+        for (int chunk = 0; chunk < numChunks; ++chunk) {
+            Emitter* emitter = emitters_[chunk].get();
+            stats_.numGenerated += emitter->states_.size();
+            for (size_t i = 0; i < emitter->states_.size(); ++i) {
+                if (dedup_.insert(emitter->hashes_[i]))
+                    next_.push_back(std::move(emitter->states_[i]));
+                else
+                    ++stats_.numDuplicated;
+            }
+            emitter->clear();
+        }
+
+        if (next_.empty())
+            return false;
+
+        const size_t width = options_.beamWidthAt ? options_.beamWidthAt(turn) : options_.beamWidth;
+
+        // Selects the top |width| children. The index breaks ties, so the order is deterministic.
+        order_.resize(next_.size());
+        for (size_t i = 0; i < order_.size(); ++i)
+            order_[i] = static_cast<std::uint32_t>(i);
+        auto compare = [this](std::uint32_t lhs, std::uint32_t rhs) {
+            if (better_(next_[lhs], next_[rhs]))
+                return true;
+            if (better_(next_[rhs], next_[lhs]))
+                return false;
+            return lhs < rhs;
+        };
+        if (order_.size() > width) {
+            std::nth_element(order_.begin(), order_.begin() + width, order_.end(), compare);
+            order_.resize(width);
+        }
+        std::sort(order_.begin(), order_.end(), compare);
+
+        current_.clear();
+        for (std::uint32_t i : order_)
+            current_.push_back(std::move(next_[i]));
+        return true;
+    }
+
+    const BeamSearchOptions options_;
+    Better better_;
+    BeamSearchStats stats_;
+
+    std::vector<std::unique_ptr<Emitter>> emitters_;
+    std::vector<State> current_;
+    std::vector<State> next_;
+    std::vector<std::uint32_t> order_;
+    FlatHashSet dedup_;
+};
+
+#endif // CORE_SEARCH_BEAM_SEARCH_H_
@@ -0,0 +1,102 @@
+#include "core/search/beam_search.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/executor.h"
+#include "core/core_field.h"
+#include "core/kumipuyo_seq.h"
+#include "core/kumipuyo_seq_generator.h"
+#include "core/plan/plan.h"
+#include "core/rensa/rensa_detector.h"
+
+using namespace std;
+
+namespace {
+
+struct PuyoState {
+    friend bool operator>(const PuyoState& lhs, const PuyoState& rhs)
+    {
+        if (lhs.maxChains != rhs.maxChains)
+            return lhs.maxChains > rhs.maxChains;
+        return lhs.maxScore > rhs.maxScore;
+    }
+
+    CoreField field;
+    Decision firstDecision;
+    int maxChains = 0;
+    int maxScore = 0;
+};
+
+// Runs a beam search like BeamThinker. A state is evaluated by the rensa found by RensaDetector.
+vector<PuyoState> runSearch(Executor* executor, const KumipuyoSeq& seq, int beamWidth)
+{
+    BeamSearchOptions options;
+    options.beamWidth = beamWidth;
+    options.executor = executor;
+    BeamSearch<PuyoState> search(options);
+
+    vector<KumipuyoSeq> layerSeqs;
+    for (int i = 0; i < seq.size(); ++i)
+        layerSeqs.push_back(KumipuyoSeq { seq.get(i) });
+
+    auto expand = [&](int turn, int, const PuyoState& s, BeamSearchEmitter<PuyoState>* emitter) {
+        Plan::iterateAvailablePlans(s.field, layerSeqs[turn], 1, [&](const RefPlan& plan) {
+            // Doesn't fire a rensa.
+            if (plan.isRensaPlan() || !emitter->visit(plan.field().hash()))
+                return;
+
+            PuyoState next;
+            next.field = plan.field();
+            next.firstDecision = turn == 0 ? plan.firstDecision() : s.firstDecision;
+            auto callback = [&next](CoreField&& cf, const ColumnPuyoList&) {
+                RensaResult result = cf.simulate();
+                next.maxChains = max(next.maxChains, result.chains);
+                next.maxScore = max(next.maxScore, result.score);
+            };
+            bool prohibits[FieldConstant::MAP_WIDTH] {};
+            RensaDetector::detectByDropStrategy(next.field, prohibits, PurposeForFindingRensa::FOR_FIRE, 2, 13, callback);
+
+            uint64_t hash = next.field.hash();
+            emitter->emit(std::move(next), hash);
+        });
+    };
+
+    vector<PuyoState> initialStates(1);
+    vector<PuyoState> result = search.run(initialStates, seq.size(), expand);
+
+    const BeamSearchStats& stats = search.stats();
+    cout << "threads=" << (executor ? executor->numThreads() : 1)
+         << " layers=" << stats.numLayers
+         << " expanded=" << stats.numExpanded
+         << " generated=" << stats.numGenerated
+         << " duplicated=" << stats.numDuplicated
+         << " time=" << stats.elapsed << " [s]"
+         << " states/sec=" << stats.statesPerSecond() << endl;
+    return result;
+}
+
+} // namespace
+
+TEST(BeamSearchPerformanceTest, serialAndParallel)
+{
+    const KumipuyoSeq seq = KumipuyoSeqGenerator::generateRandomSequenceWithSeed(12, 1);
+    const int beamWidth = 400;
+
+    vector<PuyoState> serial = runSearch(nullptr, seq, beamWidth);
+
+    Executor executor(4);
+    executor.start();
+    vector<PuyoState> parallel = runSearch(&executor, seq, beamWidth);
+    executor.stop();
+
+    // The result doesn't depend on the number of threads.
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i].field, parallel[i].field);
+        EXPECT_EQ(serial[i].firstDecision, parallel[i].firstDecision);
+    }
+}
@@ -0,0 +1,136 @@
+#include "core/search/beam_search.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/executor.h"
+
+using namespace std;
+
+namespace {
+
+// A state is a number. The children of n are 2n and 2n + 1, and a larger number is better.
+void expandNumber(int /*turn*/, int /*parentIndex*/, const int& n, BeamSearchEmitter<int>* emitter)
+{
+    for (int child : { 2 * n, 2 * n + 1 }) {
+        if (emitter->visit(child))
+            emitter->emit(int(child), child);
+    }
+}
+
+// The children of n are n + 1, ..., n + 5. Many children are duplicated.
+void expandOverlapping(int /*turn*/, int /*parentIndex*/, const int& n, BeamSearchEmitter<int>* emitter)
+{
+    for (int i = 1; i <= 5; ++i)
+        emitter->emit(n + i, n + i);
+}
+
+} // namespace
+
+TEST(BeamSearchTest, keepsBestStates)
+{
+    BeamSearchOptions options;
+    options.beamWidth = 3;
+    BeamSearch<int> search(options);
+
+    const vector<int>& states = search.run(vector<int> { 1 }, 3, expandNumber);
+    EXPECT_EQ((vector<int> { 15, 14, 13 }), states);
+    EXPECT_EQ(3, search.stats().numLayers);
+    EXPECT_EQ(1 + 2 + 3, search.stats().numExpanded);
+    EXPECT_EQ(2 + 4 + 6, search.stats().numGenerated);
+}
+
+TEST(BeamSearchTest, deduplicates)
+{
+    BeamSearchOptions options;
+    options.beamWidth = 100;
+    BeamSearch<int, less<int>> search(options);
+
+    const vector<int>& states = search.run(vector<int> { 0, 1, 2 }, 1, expandOverlapping);
+    EXPECT_EQ((vector<int> { 1, 2, 3, 4, 5, 6, 7 }), states);
+    EXPECT_EQ(15, search.stats().numGenerated);
+    EXPECT_EQ(8, search.stats().numDuplicated);
+}
+
+TEST(BeamSearchTest, beamWidthAt)
+{
+    BeamSearchOptions options;
+    options.beamWidthAt = [](int turn) { return turn + 1; };
+    BeamSearch<int> search(options);
+
+    vector<size_t> sizes;
+    search.run(vector<int> { 1 }, 4, expandNumber, [&](int, const vector<int>& states) {
+        sizes.push_back(states.size());
+        return true;
+    });
+    EXPECT_EQ((vector<size_t> { 1, 2, 3, 4 }), sizes);
+}
+
+TEST(BeamSearchTest, stopsByOnLayer)
+{
+    BeamSearch<int> search;
+    const vector<int>& states = search.run(vector<int> { 1 }, 10, expandNumber, [](int turn, const vector<int>&) {
+        return turn < 1;
+    });
+    EXPECT_EQ((vector<int> { 7, 6, 5, 4 }), states);
+    EXPECT_EQ(2, search.stats().numLayers);
+}
+
+TEST(BeamSearchTest, stopsWithoutChildren)
+{
+    BeamSearch<int> search;
+    auto expand = [](int, int, const int& n, BeamSearchEmitter<int>* emitter) {
+        if (n < 4)
+            emitter->emit(n + 1, n + 1);
+    };
+    const vector<int>& states = search.run(vector<int> { 1 }, 10, expand);
+    EXPECT_EQ((vector<int> { 4 }), states);
+    EXPECT_EQ(3, search.stats().numLayers);
+}
+
+TEST(BeamSearchTest, step)
+{
+    BeamSearchOptions options;
+    options.beamWidth = 3;
+    BeamSearch<int> search(options);
+
+    // The same search as keepsBestStates, layer by layer.
+    search.reset(vector<int> { 1 });
+    for (int turn = 0; turn < 3; ++turn)
+        ASSERT_TRUE(search.step(turn, expandNumber));
+    EXPECT_EQ((vector<int> { 15, 14, 13 }), search.states());
+    EXPECT_EQ(3, search.stats().numLayers);
+
+    // The search can be reused. The layer is kept when no child is generated.
+    search.reset(vector<int> { 4 });
+    EXPECT_EQ(0, search.stats().numLayers);
+    auto expand = [](int, int, const int& n, BeamSearchEmitter<int>* emitter) {
+        if (n < 5)
+            emitter->emit(n + 1, n + 1);
+    };
+    EXPECT_TRUE(search.step(0, expand));
+    EXPECT_FALSE(search.step(1, expand));
+    EXPECT_EQ((vector<int> { 5 }), search.states());
+    EXPECT_EQ(1, search.stats().numLayers);
+    EXPECT_EQ(2, search.stats().numExpanded);
+}
+
+TEST(BeamSearchTest, parallel)
+{
+    Executor executor(4);
+    executor.start();
+
+    BeamSearchOptions options;
+    options.beamWidth = 50;
+    BeamSearch<int, less<int>> serialSearch(options);
+    vector<int> expected = serialSearch.run(vector<int> { 0, 3, 5, 8, 13 }, 20, expandOverlapping);
+
+    options.executor = &executor;
+    BeamSearch<int, less<int>> parallelSearch(options);
+    vector<int> actual = parallelSearch.run(vector<int> { 0, 3, 5, 8, 13 }, 20, expandOverlapping);
+
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(serialSearch.stats().numGenerated, parallelSearch.stats().numGenerated);
+    EXPECT_EQ(serialSearch.stats().numDuplicated, parallelSearch.stats().numDuplicated);
+}
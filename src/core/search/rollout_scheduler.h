@@ -0,0 +1,172 @@
+#ifndef CORE_SEARCH_ROLLOUT_SCHEDULER_H_
+#define CORE_SEARCH_ROLLOUT_SCHEDULER_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "base/executor.h"
+#include "base/noncopyable.h"
+#include "base/time.h"
+#include "base/wait_group.h"
+
+struct RolloutSchedulerStats {
+    long long savedCost() const { return costWithoutSharing - cost; }
+
+    // The number of the steps computed, and the steps which the rollouts
+    // would compute if they were run independently.
+    long long numSteps = 0;
+    long long numStepsWithoutSharing = 0;
+    // The sum of the costs returned by the steps, with and without sharing.
+    long long cost = 0;
+    long long costWithoutSharing = 0;
+    // The number of the times the rollouts diverged.
+    int numForks = 0;
+    // [s]
+    double elapsed = 0.0;
+};
+
+// RolloutScheduler runs rollouts which start from the same node, and go down
+// by a sequence of keys, e.g. the kumipuyo of each turn. The rollouts which have
+// the same prefix of keys share the nodes of the prefix, i.e. a node is computed
+// only once for a prefix. When the keys of the rollouts diverge, the rollouts are
+// forked, and the forks are run in parallel on the executor.
+//
+// The result of a rollout is the same as the one of the rollout run independently,
+// as long as |step| is deterministic.
+template<typename Node, typename Key>
+class RolloutScheduler : noncopyable {
+public:
+    // Computes |child| of |parent| with |key|, and returns the cost, e.g. the number of
+    // the expanded states. This is called from the workers of the executor.
+    typedef std::function<long long (int depth, const Node& parent, const Key& key, Node* child)> Step;
+    // Called with the last node of the |rollout|-th rollout. This is called from the workers
+    // of the executor.
+    typedef std::function<void (int rollout, const Node& leaf)> Finish;
+
+    // If |executor| is nullptr, the rollouts are run in the caller thread.
+    // Don't run the scheduler in a task of the same executor, since it waits for the tasks.
+    explicit RolloutScheduler(Executor* executor = nullptr) : executor_(executor) {}
+
+    // Runs the rollouts from |root|. |rollouts[i]| is the keys of the i-th rollout.
+    void run(Node root, const std::vector<std::vector<Key>>& rollouts, Step step, Finish finish)
+    {
+        double beginTime = currentTime();
+
+        rollouts_ = &rollouts;
+        step_ = std::move(step);
+        finish_ = std::move(finish);
+        numSteps_ = 0;
+        numStepsWithoutSharing_ = 0;
+        cost_ = 0;
+        costWithoutSharing_ = 0;
+        numForks_ = 0;
+
+        std::vector<int> indices(rollouts.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+            indices[i] = static_cast<int>(i);
+
+        std::shared_ptr<const Node> rootNode(new Node(std::move(root)));
+        std::vector<std::vector<int>> groups = split(*rootNode, 0, indices);
+        if (!groups.empty())
+            numForks_ += static_cast<int>(groups.size()) - 1;
+
+        WaitGroup wg;
+        for (auto& group : groups)
+            spawn(rootNode, 0, std::move(group), &wg);
+        wg.waitUntilDone();
+
+        stats_.numSteps = numSteps_;
+        stats_.numStepsWithoutSharing = numStepsWithoutSharing_;
+        stats_.cost = cost_;
+        stats_.costWithoutSharing = costWithoutSharing_;
+        stats_.numForks = numForks_;
+        stats_.elapsed = currentTime() - beginTime;
+    }
+
+    const RolloutSchedulerStats& stats() const { return stats_; }
+
+private:
+    void spawn(std::shared_ptr<const Node> parent, int depth, std::vector<int> indices, WaitGroup* wg)
+    {
+        if (!executor_) {
+            expand(std::move(parent), depth, std::move(indices), wg);
+            return;
+        }
+
+        wg->add(1);
+        executor_->submit([this, parent, depth, indices, wg]() {
+            expand(parent, depth, indices, wg);
+            wg->done();
+        });
+    }
+
+    // Computes the child of |parent| for the rollouts in |indices|, which have the same key
+    // at |depth|, and goes down until the rollouts diverge or finish.
+    void expand(std::shared_ptr<const Node> parent, int depth, std::vector<int> indices, WaitGroup* wg)
+    {
+        while (true) {
+            std::shared_ptr<Node> child(new Node);
+            long long cost = step_(depth, *parent, (*rollouts_)[indices.front()][depth], child.get());
+            ++depth;
+            parent = child;
+
+            numSteps_ += 1;
+            numStepsWithoutSharing_ += indices.size();
+            cost_ += cost;
+            costWithoutSharing_ += cost * static_cast<long long>(indices.size());
+
+            std::vector<std::vector<int>> groups = split(*parent, depth, indices);
+            if (groups.empty())
+                return;
+
+            numForks_ += static_cast<int>(groups.size()) - 1;
+            for (size_t i = 1; i < groups.size(); ++i)
+                spawn(parent, depth, std::move(groups[i]), wg);
+            indices = std::move(groups.front());
+        }
+    }
+
+    // Finishes the rollouts which end at |node|, and groups the others by the key at |depth|.
+    // The groups are in the order of their first rollouts.
+    std::vector<std::vector<int>> split(const Node& node, int depth, const std::vector<int>& indices)
+    {
+        const std::vector<std::vector<Key>>& rollouts = *rollouts_;
+        std::vector<std::vector<int>> groups;
+        for (int i : indices) {
+            if (static_cast<int>(rollouts[i].size()) <= depth) {
+                finish_(i, node);
+                continue;
+            }
+
+            bool found = false;
+            for (auto& group : groups) {
+                if (rollouts[group.front()][depth] == rollouts[i][depth]) {
+                    group.push_back(i);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                groups.push_back(std::vector<int> { i });
+        }
+        return groups;
+    }
+
+    Executor* executor_;
+
+    const std::vector<std::vector<Key>>* rollouts_ = nullptr;
+    Step step_;
+    Finish finish_;
+
+    std::atomic<long long> numSteps_ { 0 };
+    std::atomic<long long> numStepsWithoutSharing_ { 0 };
+    std::atomic<long long> cost_ { 0 };
+    std::atomic<long long> costWithoutSharing_ { 0 };
+    std::atomic<int> numForks_ { 0 };
+
+    RolloutSchedulerStats stats_;
+};
+
+#endif // CORE_SEARCH_ROLLOUT_SCHEDULER_H_
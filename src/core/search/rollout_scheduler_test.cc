@@ -0,0 +1,90 @@
+#include "core/search/rollout_scheduler.h"
+
+#include <mutex>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/executor.h"
+
+using namespace std;
+
+namespace {
+
+// A node is the digits of the keys, e.g. the keys { 1, 2, 3 } make 123.
+long long appendDigit(int /*depth*/, const long long& parent, const int& key, long long* child)
+{
+    *child = parent * 10 + key;
+    return 1;
+}
+
+vector<long long> runRollouts(Executor* executor, const vector<vector<int>>& rollouts, RolloutSchedulerStats* stats)
+{
+    mutex mu;
+    vector<long long> leaves(rollouts.size(), -1);
+    RolloutScheduler<long long, int> scheduler(executor);
+    scheduler.run(0, rollouts, appendDigit, [&](int rollout, const long long& leaf) {
+        lock_guard<mutex> lock(mu);
+        leaves[rollout] = leaf;
+    });
+    *stats = scheduler.stats();
+    return leaves;
+}
+
+} // namespace
+
+TEST(RolloutSchedulerTest, sharesPrefixes)
+{
+    const vector<vector<int>> rollouts {
+        { 1, 2, 3 },
+        { 1, 2, 4 },
+        { 1, 5 },
+        { },
+        { 1, 2, 3 },
+    };
+
+    RolloutSchedulerStats stats;
+    EXPECT_EQ((vector<long long> { 123, 124, 15, 0, 123 }), runRollouts(nullptr, rollouts, &stats));
+
+    // 1, 12, 123, 124 and 15 are computed.
+    EXPECT_EQ(5, stats.numSteps);
+    EXPECT_EQ(11, stats.numStepsWithoutSharing);
+    EXPECT_EQ(5, stats.cost);
+    EXPECT_EQ(11, stats.costWithoutSharing);
+    EXPECT_EQ(6, stats.savedCost());
+    EXPECT_EQ(2, stats.numForks);
+}
+
+TEST(RolloutSchedulerTest, parallel)
+{
+    // 100 rollouts of 8 keys in [1, 4]. The leaves are unique for the keys.
+    mt19937 rnd(1);
+    vector<vector<int>> rollouts(100);
+    for (auto& keys : rollouts) {
+        for (int i = 0; i < 8; ++i)
+            keys.push_back(rnd() % 4 + 1);
+    }
+
+    RolloutSchedulerStats serialStats;
+    vector<long long> serial = runRollouts(nullptr, rollouts, &serialStats);
+
+    Executor executor(4);
+    executor.start();
+    RolloutSchedulerStats parallelStats;
+    vector<long long> parallel = runRollouts(&executor, rollouts, &parallelStats);
+    executor.stop();
+
+    EXPECT_EQ(serial, parallel);
+    EXPECT_EQ(serialStats.numSteps, parallelStats.numSteps);
+    EXPECT_EQ(800, parallelStats.numStepsWithoutSharing);
+    EXPECT_LT(parallelStats.numSteps, 800);
+    EXPECT_EQ(serialStats.numForks, parallelStats.numForks);
+
+    for (size_t i = 0; i < rollouts.size(); ++i) {
+        long long expected = 0;
+        for (int key : rollouts[i])
+            expected = expected * 10 + key;
+        EXPECT_EQ(expected, parallel[i]);
+    }
+}
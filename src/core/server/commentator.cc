@@ -8,17 +8,17 @@
 #include <stdlib.h>
 
 #include <algorithm>
-#include <chrono>
 #include <map>
 #include <memory>
 #include <set>
-#include <thread>
 #include <vector>
 
 #include <glog/logging.h>
 
 #include "base/base.h"
+#include "base/executor.h"
 #include "base/strings.h"
+#include "base/time.h"
 #include "core/plan/plan.h"
 #include "core/rensa/rensa_detector.h"
 #include "core/server/game_state.h"
@@ -26,17 +26,18 @@
 using namespace std;
 
 Commentator::Commentator() :
-    shouldStop_(false)
+    shouldStop_(false),
+    generation_(0)
 {
-    needsUpdate_[0] = needsUpdate_[1] = false;
+    for (int pi = 0; pi < 2; ++pi) {
+        needsUpdate_[pi] = false;
+        running_[pi] = false;
+    }
 }
 
 Commentator::~Commentator()
 {
-    // TODO(mayah): Why don't we have stop() instead of calling pthread_join() here?
-    shouldStop_ = true;
-    if (th_.joinable())
-        th_.join();
+    stop();
 }
 
 void Commentator::addCommentatorObserver(CommentatorObserver* observer)
@@ -54,99 +55,125 @@ void Commentator::newGameWillStart()
 
 void Commentator::onUpdate(const GameState& gameState)
 {
-    lock_guard<mutex> lock(mu_);
+    lock_guard<mutex> lock(inputMu_);
 
     for (int i = 0; i < 2; ++i) {
         const PlayerGameState& pgs = gameState.playerGameState(i);
+        if (!pgs.message.empty())
+            inputs_[i].message = pgs.message;
+
         if (pgs.event.grounded) {
-            frameId_[i] = gameState.frameId();
+            inputs_[i].generation = generation_;
+            inputs_[i].frameId = gameState.frameId();
             // When chigiri is used, some puyo exists in the air. So we need to drop.
-            field_[i] = CoreField::fromPlainFieldWithDrop(pgs.field);
-            kumipuyoSeq_[i] = pgs.kumipuyoSeq;
+            inputs_[i].field = CoreField::fromPlainFieldWithDrop(pgs.field);
+            inputs_[i].kumipuyoSeq = pgs.kumipuyoSeq;
+            inputs_[i].updatedTime = currentTime();
             needsUpdate_[i] = true;
+            submitUpdate(i);
         }
-
-        if (!pgs.message.empty())
-            message_[i] = pgs.message;
     }
 }
 
 CommentatorResult Commentator::result() const
 {
-    lock_guard<mutex> lock(mu_);
-    CommentatorResult r;
-    for (int pi = 0; pi < 2; ++pi) {
-        r.frameId[pi] = frameId_[pi];
-        if (fireableMainChain_[pi].get()) {
-            r.fireableMainChain[pi] = *fireableMainChain_[pi];
-        }
-        if (fireableTsubushiChain_[pi].get()) {
-            r.fireableTsubushiChain[pi] = *fireableTsubushiChain_[pi];
-        }
-        if (firingChain_[pi].get()) {
-            r.firingChain[pi] = *firingChain_[pi];
-        }
-        r.message[pi] = message_[pi];
-        r.events[pi] = events_[pi];
-    }
-    return r;
+    lock_guard<mutex> lock(resultMu_);
+    return results_[front_];
+}
+
+CommentatorStats Commentator::stats() const
+{
+    lock_guard<mutex> lock(resultMu_);
+    return stats_;
 }
 
 bool Commentator::start()
 {
-    th_ = thread([this]() {
-        this->runLoop();
-    });
+    CHECK(!hasStarted_);
 
+    // A worker for each player.
+    shouldStop_ = false;
+    executor_.reset(new Executor(2));
+    executor_->start();
+
+    // Analyzes the fields given before start().
+    lock_guard<mutex> lock(inputMu_);
     hasStarted_ = true;
+    for (int pi = 0; pi < 2; ++pi)
+        submitUpdate(pi);
     return true;
 }
 
 void Commentator::stop()
 {
-    shouldStop_ = true;
-    if (th_.joinable()) {
-        th_.join();
+    {
+        lock_guard<mutex> lock(inputMu_);
+        if (!hasStarted_)
+            return;
+        shouldStop_ = true;
+        hasStarted_ = false;
     }
 
-    hasStarted_ = false;
+    // The pending analysis is skipped since |shouldStop_| is set.
+    executor_->stop();
+    executor_.reset();
+
+    lock_guard<mutex> lock(inputMu_);
+    for (int pi = 0; pi < 2; ++pi)
+        running_[pi] = false;
+}
+
+void Commentator::submitUpdate(int pi)
+{
+    if (!hasStarted_ || !needsUpdate_[pi] || running_[pi])
+        return;
+
+    running_[pi] = true;
+    executor_->submit([this, pi]() { runUpdate(pi); });
 }
 
-void Commentator::runLoop()
+void Commentator::runUpdate(int pi)
 {
+    // Analyzes the latest input until no input is given during the analysis.
+    // The inputs given during the analysis are coalesced.
     while (!shouldStop_) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
-
-        bool updated = false;
-        for (int pi = 0; pi < 2; ++pi) {
-            // Since we don't want to lock for long, copy field and kumipuyo.
-            CoreField field;
-            KumipuyoSeq kumipuyoSeq;
-            {
-                lock_guard<mutex> lock(mu_);
-                if (!needsUpdate_[pi])
-                    continue;
-
-                field = field_[pi];
-                kumipuyoSeq = kumipuyoSeq_[pi];
-                needsUpdate_[pi] = false;
+        Input input;
+        {
+            lock_guard<mutex> lock(inputMu_);
+            if (!needsUpdate_[pi]) {
+                running_[pi] = false;
+                return;
             }
+            input = inputs_[pi];
+            needsUpdate_[pi] = false;
+        }
 
-            update(pi, field, kumipuyoSeq);
-            updated = true;
+        Analysis* analysis = &analyses_[pi];
+        if (analysis->generation != input.generation) {
+            *analysis = Analysis();
+            analysis->generation = input.generation;
         }
 
-        if (updated) {
-            CommentatorResult r = result();
-            for (auto observer : observers_) {
-                observer->onCommentatorResultUpdate(r);
-            }
+        // The player's pair might be grounded again without any change, e.g. when a replay
+        // is played again. The analysis is reused then, not to add the same events again.
+        if (analysis->hasAnalyzed && analysis->field == input.field && analysis->kumipuyoSeq == input.kumipuyoSeq) {
+            publish(pi, input, *analysis, true);
+            continue;
         }
+
+        update(input, analysis);
+        analysis->hasAnalyzed = true;
+        analysis->field = input.field;
+        analysis->kumipuyoSeq = input.kumipuyoSeq;
+        publish(pi, input, *analysis, false);
     }
 }
 
-void Commentator::update(int pi, const CoreField& field, const KumipuyoSeq& kumipuyoSeq)
+void Commentator::update(const Input& input, Analysis* analysis)
 {
+    const CoreField& field = input.field;
+    const KumipuyoSeq& kumipuyoSeq = input.kumipuyoSeq;
+
     // 1. Check field is firing a rensa.
     {
         CoreField f(field);
@@ -154,17 +181,15 @@ void Commentator::update(int pi, const CoreField& field, const KumipuyoSeq& kumi
         RensaChainPointerTracker tracker(&track->trackResult);
         track->rensaResult = f.simulate(&tracker);
         if (track->rensaResult.score > 0) {
-            lock_guard<mutex> lock(mu_);
             string msg = std::to_string(track->rensaResult.chains) + "連鎖発火: " + std::to_string(track->rensaResult.score) + "点";
-            addEventMessage(pi, msg);
-            firingChain_[pi] = move(track);
-            fireableMainChain_[pi].reset();
-            fireableTsubushiChain_[pi].reset();
+            addEventMessage(analysis, msg);
+            analysis->firingChain = move(track);
+            analysis->fireableMainChain.reset();
+            analysis->fireableTsubushiChain.reset();
             return;
         }
 
-        lock_guard<mutex> lock(mu_);
-        firingChain_[pi].reset();
+        analysis->firingChain.reset();
     }
 
     // 2. Check Tsubushi chain
@@ -195,10 +220,8 @@ void Commentator::update(int pi, const CoreField& field, const KumipuyoSeq& kumi
             }
         });
 
-        if (bestTsubushiScore.first < 100) {
-            lock_guard<mutex> lock(mu_);
-            fireableTsubushiChain_[pi].reset(new IgnitionRensaResult(ignitionRensaResult));
-        }
+        if (bestTsubushiScore.first < 100)
+            analysis->fireableTsubushiChain.reset(new IgnitionRensaResult(ignitionRensaResult));
     }
 
     // 3. Check Main chain
@@ -218,30 +241,67 @@ void Commentator::update(int pi, const CoreField& field, const KumipuyoSeq& kumi
 
         RensaDetector::detectIteratively(field, RensaDetectorStrategy::defaultFloatStrategy(), 3, callback);
 
-        if (bestRensa != nullptr) {
-            lock_guard<mutex> lock(mu_);
-            fireableMainChain_[pi] = move(bestRensa);
-        }
+        if (bestRensa != nullptr)
+            analysis->fireableMainChain = move(bestRensa);
     }
 }
 
+void Commentator::publish(int pi, const Input& input, const Analysis& analysis, bool reused)
+{
+    lock_guard<mutex> lock(publishMu_);
+    // The game has been reset during the analysis.
+    if (input.generation != generation_)
+        return;
+
+    // |results_[1 - front_]| is not read by result(), since only publish() flips |front_|.
+    CommentatorResult& r = results_[1 - front_];
+    r = results_[front_];
+    r.frameId[pi] = input.frameId;
+    r.fireableMainChain[pi] = analysis.fireableMainChain ? *analysis.fireableMainChain : TrackedPossibleRensaInfo();
+    r.fireableTsubushiChain[pi] = analysis.fireableTsubushiChain ? *analysis.fireableTsubushiChain : IgnitionRensaResult();
+    r.firingChain[pi] = analysis.firingChain ? *analysis.firingChain : TrackedPossibleRensaInfo();
+    r.message[pi] = input.message;
+    r.events[pi] = analysis.events;
+
+    double latency = currentTime() - input.updatedTime;
+    r.analysisLatency[pi] = latency;
+
+    {
+        lock_guard<mutex> resultLock(resultMu_);
+        front_ = 1 - front_;
+        ++stats_.numUpdates;
+        if (reused)
+            ++stats_.numReusedAnalyses;
+        stats_.totalLatency += latency;
+        stats_.maxLatency = max(stats_.maxLatency, latency);
+    }
+
+    for (auto observer : observers_)
+        observer->onCommentatorResultUpdate(results_[front_]);
+}
+
 void Commentator::reset()
 {
-    lock_guard<mutex> lock(mu_);
-    for (int i = 0; i < 2; i++) {
-        needsUpdate_[i] = false;
-        fireableMainChain_[i].reset();
-        fireableTsubushiChain_[i].reset();
-        firingChain_[i].reset();
-        message_[i].clear();
-        events_[i].clear();
+    {
+        lock_guard<mutex> lock(inputMu_);
+        ++generation_;
+        for (int i = 0; i < 2; i++) {
+            needsUpdate_[i] = false;
+            inputs_[i] = Input();
+            inputs_[i].generation = generation_;
+        }
     }
+
+    // The analyses are reset by the workers, since they see the new generation.
+    lock_guard<mutex> lock(publishMu_);
+    lock_guard<mutex> resultLock(resultMu_);
+    results_[0] = results_[1] = CommentatorResult();
 }
 
-void Commentator::addEventMessage(int pi, const string& msg)
+// static
+void Commentator::addEventMessage(Analysis* analysis, const string& msg)
 {
-    // TODO(mayah): Assert locked.
-    events_[pi].push_front(msg);
-    while (events_[pi].size() > 3)
-        events_[pi].pop_back();
+    analysis->events.push_front(msg);
+    while (analysis->events.size() > 3)
+        analysis->events.pop_back();
 }
@@ -1,15 +1,13 @@
 #ifndef GUI_COMMENTATOR_H_
 #define GUI_COMMENTATOR_H_
 
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
-#include <thread>
 #include <vector>
 
-#include <gtest/gtest.h>
-
 #include "core/column_puyo_list.h"
 #include "core/core_field.h"
 #include "core/kumipuyo_seq.h"
@@ -17,6 +15,8 @@
 #include "core/rensa_tracker/rensa_chain_tracker.h"
 #include "core/server/game_state_observer.h"
 
+class Executor;
+
 struct TrackedPossibleRensaInfo {
     TrackedPossibleRensaInfo() {}
     TrackedPossibleRensaInfo(const RensaResult& rensaResult,
@@ -34,13 +34,26 @@ struct TrackedPossibleRensaInfo {
 };
 
 struct CommentatorResult {
-    int frameId[2];
+    int frameId[2] {};
     TrackedPossibleRensaInfo fireableMainChain[2];
     IgnitionRensaResult fireableTsubushiChain[2];
     TrackedPossibleRensaInfo firingChain[2];
     std::string message[2];
 
     std::deque<std::string> events[2];
+
+    // The time from onUpdate() to the result of the last analysis [s].
+    double analysisLatency[2] {};
+};
+
+struct CommentatorStats {
+    int numUpdates = 0;
+    // The number of the updates that reused the analysis of the player,
+    // since the field and the next puyos were not changed.
+    int numReusedAnalyses = 0;
+    // [s]
+    double totalLatency = 0.0;
+    double maxLatency = 0.0;
 };
 
 class CommentatorObserver {
@@ -49,6 +62,9 @@ public:
     virtual void onCommentatorResultUpdate(const CommentatorResult& result) = 0;
 };
 
+// Commentator analyzes the fields of the players when a puyo is grounded.
+// onUpdate() only copies the field, and the analysis runs on a worker of each player.
+// The results are double-buffered, so result() never waits for the analysis.
 class Commentator : public GameStateObserver {
 public:
     Commentator();
@@ -62,37 +78,70 @@ public:
 
     bool start();
     void stop();
-    void runLoop();
+
+    // Returns the latest result.
+    CommentatorResult result() const;
+    CommentatorStats stats() const;
 
 private:
+    // The input of the analysis for a player.
+    struct Input {
+        int generation = 0;
+        int frameId = 0;
+        CoreField field;
+        KumipuyoSeq kumipuyoSeq;
+        std::string message;
+        double updatedTime = 0.0;
+    };
+
+    // The analysis of a player. This is touched only by the worker of the player.
+    struct Analysis {
+        int generation = 0;
+        std::unique_ptr<TrackedPossibleRensaInfo> fireableMainChain;
+        std::unique_ptr<IgnitionRensaResult> fireableTsubushiChain;
+        std::unique_ptr<TrackedPossibleRensaInfo> firingChain;
+        std::deque<std::string> events;
+
+        // The field and the next puyos of the last analysis.
+        bool hasAnalyzed = false;
+        CoreField field;
+        KumipuyoSeq kumipuyoSeq;
+    };
+
     // reset() should be called when a new game has started.
     void reset();
 
-    void update(int pi, const CoreField&, const KumipuyoSeq&);
+    // Submits the analysis of |pi| unless it's running. |inputMu_| should be locked.
+    void submitUpdate(int pi);
+    void runUpdate(int pi);
+    void update(const Input&, Analysis*);
+    void publish(int pi, const Input&, const Analysis&, bool reused);
 
-    void addEventMessage(int pi, const std::string&);
-    CommentatorResult result() const;
+    static void addEventMessage(Analysis*, const std::string&);
 
-    std::thread th_;
-    volatile bool shouldStop_;
-    volatile bool hasStarted_ = false;
-    volatile bool needsUpdate_[2];
+    std::unique_ptr<Executor> executor_;
+    std::atomic<bool> shouldStop_;
+    bool hasStarted_ = false;
 
     std::vector<CommentatorObserver*> observers_;
 
-    mutable std::mutex mu_;
-    CoreField field_[2];
-    KumipuyoSeq kumipuyoSeq_[2];
-    std::string message_[2];
-
-    int frameId_[2];
-    std::unique_ptr<TrackedPossibleRensaInfo> fireableMainChain_[2];
-    std::unique_ptr<IgnitionRensaResult> fireableTsubushiChain_[2];
-    std::unique_ptr<TrackedPossibleRensaInfo> firingChain_[2];
-
-    std::deque<std::string> events_[2];
-
-    FRIEND_TEST(CommentatorTest, getPotentialMaxChain);
+    // Protects the inputs. This is locked by the duel thread, but only for a copy.
+    std::mutex inputMu_;
+    std::atomic<int> generation_;
+    Input inputs_[2];
+    bool needsUpdate_[2];
+    bool running_[2];
+
+    Analysis analyses_[2];
+
+    // Serializes publish() and reset().
+    std::mutex publishMu_;
+    // Protects |front_| and |stats_|. |results_[front_]| is the latest result.
+    // publish() writes the other buffer, and flips |front_|.
+    mutable std::mutex resultMu_;
+    CommentatorResult results_[2];
+    int front_ = 0;
+    CommentatorStats stats_;
 };
 
 #endif
@@ -1,17 +1,181 @@
 #include "core/server/commentator.h"
 
-#include <stdio.h>
-#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
-#include <memory>
-#include <vector>
-
-#include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
-#include "base/base.h"
+#include "core/server/game_state.h"
 
 using namespace std;
 
-class CommentatorTest : public testing::Test {
+namespace {
+
+GameState makeGroundedState(int frameId, const string& field, const string& kumipuyoSeq)
+{
+    GameState state(frameId);
+    for (int pi = 0; pi < 2; ++pi) {
+        PlayerGameState* pgs = state.mutablePlayerGameState(pi);
+        pgs->dead = false;
+        pgs->playable = true;
+        pgs->score = 0;
+        pgs->pendingOjama = 0;
+        pgs->fixedOjama = 0;
+    }
+
+    PlayerGameState* pgs = state.mutablePlayerGameState(0);
+    pgs->field = PlainField(field);
+    pgs->kumipuyoSeq = KumipuyoSeq(kumipuyoSeq);
+    pgs->event.grounded = true;
+    pgs->message = "message " + to_string(frameId);
+    return state;
+}
+
+void waitForUpdates(const Commentator& commentator, int numUpdates)
+{
+    for (int i = 0; i < 10000 && commentator.stats().numUpdates < numUpdates; ++i)
+        this_thread::sleep_for(chrono::milliseconds(1));
+    ASSERT_EQ(numUpdates, commentator.stats().numUpdates);
+}
+
+class CountingObserver : public CommentatorObserver {
+public:
+    void onCommentatorResultUpdate(const CommentatorResult&) override { ++count; }
+
+    atomic<int> count { 0 };
 };
+
+} // namespace
+
+TEST(CommentatorTest, firingChain)
+{
+    Commentator commentator;
+    CountingObserver observer;
+    commentator.addCommentatorObserver(&observer);
+    ASSERT_TRUE(commentator.start());
+
+    commentator.newGameWillStart();
+    commentator.onUpdate(makeGroundedState(10,
+        "B....."
+        "RRRR.."
+        "BBBY..", "RRBB"));
+    waitForUpdates(commentator, 1);
+
+    CommentatorResult result = commentator.result();
+    EXPECT_EQ(10, result.frameId[0]);
+    EXPECT_EQ(2, result.firingChain[0].chains());
+    EXPECT_EQ("message 10", result.message[0]);
+    ASSERT_EQ(1U, result.events[0].size());
+    EXPECT_GE(result.analysisLatency[0], 0.0);
+    EXPECT_EQ(0, result.firingChain[1].chains());
+
+    // The observers are notified on the worker.
+    commentator.stop();
+    EXPECT_EQ(1, observer.count);
+}
+
+TEST(CommentatorTest, mainChain)
+{
+    Commentator commentator;
+    ASSERT_TRUE(commentator.start());
+
+    const string field =
+        "B....."
+        "RRB..."
+        "BBR...";
+
+    commentator.newGameWillStart();
+    commentator.onUpdate(makeGroundedState(10, field, "RRBB"));
+    waitForUpdates(commentator, 1);
+    CommentatorResult result = commentator.result();
+    EXPECT_EQ(0, result.firingChain[0].chains());
+    EXPECT_LT(0, result.fireableMainChain[0].chains());
+
+    // The same field with different next puyos has the same main chain.
+    commentator.onUpdate(makeGroundedState(20, field, "YYGG"));
+    waitForUpdates(commentator, 2);
+    CommentatorResult updated = commentator.result();
+    EXPECT_EQ(20, updated.frameId[0]);
+    EXPECT_EQ(result.fireableMainChain[0].chains(), updated.fireableMainChain[0].chains());
+    EXPECT_EQ(result.fireableMainChain[0].score(), updated.fireableMainChain[0].score());
+
+    CommentatorStats stats = commentator.stats();
+    EXPECT_EQ(2, stats.numUpdates);
+    EXPECT_LE(stats.maxLatency, stats.totalLatency);
+
+    // A new game resets the result.
+    commentator.newGameWillStart();
+    EXPECT_EQ(0, commentator.result().fireableMainChain[0].chains());
+
+    commentator.stop();
+}
+
+TEST(CommentatorTest, unchangedPlayerIsReused)
+{
+    Commentator commentator;
+    ASSERT_TRUE(commentator.start());
+
+    const string firingField =
+        "B....."
+        "RRRR.."
+        "BBBY..";
+
+    // Both players' pairs are grounded, and the second player is firing a rensa.
+    commentator.newGameWillStart();
+    GameState state = makeGroundedState(10, "RRB...", "RRBB");
+    PlayerGameState* pgs = state.mutablePlayerGameState(1);
+    pgs->field = PlainField(firingField);
+    pgs->kumipuyoSeq = KumipuyoSeq("YYGG");
+    pgs->event.grounded = true;
+    commentator.onUpdate(state);
+    waitForUpdates(commentator, 2);
+    EXPECT_EQ(0, commentator.stats().numReusedAnalyses);
+    ASSERT_EQ(1U, commentator.result().events[1].size());
+
+    // The same frames are given again, e.g. by a replay. The analyses are reused,
+    // so the event is not added again.
+    commentator.onUpdate(state);
+    waitForUpdates(commentator, 4);
+    CommentatorResult result = commentator.result();
+    EXPECT_EQ(2, commentator.stats().numReusedAnalyses);
+    EXPECT_EQ(2, result.firingChain[1].chains());
+    EXPECT_EQ(1U, result.events[1].size());
+
+    // Only the first player's field is changed.
+    state = makeGroundedState(20, "RRB..."
+                                  "RRB...", "BBYY");
+    pgs = state.mutablePlayerGameState(1);
+    pgs->field = PlainField(firingField);
+    pgs->kumipuyoSeq = KumipuyoSeq("YYGG");
+    pgs->event.grounded = true;
+    commentator.onUpdate(state);
+    waitForUpdates(commentator, 6);
+    result = commentator.result();
+    EXPECT_EQ(3, commentator.stats().numReusedAnalyses);
+    EXPECT_EQ(20, result.frameId[0]);
+    EXPECT_EQ(20, result.frameId[1]);
+    EXPECT_EQ("message 20", result.message[0]);
+    EXPECT_EQ(2, result.firingChain[1].chains());
+    EXPECT_EQ(1U, result.events[1].size());
+
+    // A new game doesn't reuse the analysis of the last game.
+    commentator.newGameWillStart();
+    commentator.onUpdate(state);
+    waitForUpdates(commentator, 8);
+    EXPECT_EQ(3, commentator.stats().numReusedAnalyses);
+
+    commentator.stop();
+}
+
+TEST(CommentatorTest, updateBeforeStart)
+{
+    Commentator commentator;
+    commentator.newGameWillStart();
+    commentator.onUpdate(makeGroundedState(10,
+        "RRR...", "RRBB"));
+
+    ASSERT_TRUE(commentator.start());
+    waitForUpdates(commentator, 1);
+    EXPECT_EQ(10, commentator.result().frameId[0]);
+}
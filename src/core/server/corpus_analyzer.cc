@@ -0,0 +1,369 @@
+#include "core/server/corpus_analyzer.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+
+#include <glog/logging.h>
+#include <json/json.h>
+
+#include "base/executor.h"
+#include "base/file/mapped_file.h"
+#include "base/wait_group.h"
+#include "core/field_constant.h"
+#include "core/kumipuyo_seq.h"
+#include "core/plain_field.h"
+#include "core/server/game_state.h"
+#include "core/server/game_state_log.h"
+
+using namespace std;
+
+namespace {
+
+bool hasSuffix(const string& s, const string& suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+long long fileSize(const string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) < 0)
+        return 0;
+    return st.st_size;
+}
+
+GameResult gameResultFromString(const string& s)
+{
+    const GameResult results[] = {
+        GameResult::PLAYING,
+        GameResult::DRAW,
+        GameResult::P1_WIN,
+        GameResult::P2_WIN,
+        GameResult::P1_WIN_WITH_CONNECTION_ERROR,
+        GameResult::P2_WIN_WITH_CONNECTION_ERROR,
+        GameResult::GAME_HAS_STOPPED,
+    };
+
+    for (GameResult result : results) {
+        if (toString(result) == s)
+            return result;
+    }
+    return GameResult::PLAYING;
+}
+
+// Reads a line from [*p, end) without the line break, and moves |*p| to the next line.
+bool nextLine(const char** p, const char* end, string* line)
+{
+    if (*p == end)
+        return false;
+
+    const char* q = find(*p, end, '\n');
+    line->assign(*p, q);
+    if (!line->empty() && line->back() == '\r')
+        line->pop_back();
+    *p = q == end ? end : q + 1;
+    return true;
+}
+
+// Parses the rows of CoreField::toDebugString(), which include the walls.
+bool parseDebugStringRows(const vector<string>& rows, PlainField* field)
+{
+    if (rows.size() != static_cast<size_t>(FieldConstant::MAP_HEIGHT))
+        return false;
+
+    *field = PlainField();
+    for (int i = 0; i < FieldConstant::MAP_HEIGHT; ++i) {
+        const string& row = rows[i];
+        if (row.size() < static_cast<size_t>(2 * FieldConstant::MAP_WIDTH - 1))
+            return false;
+        int y = FieldConstant::MAP_HEIGHT - 1 - i;
+        if (y < 1 || FieldConstant::MAP_HEIGHT - 1 <= y)
+            continue;
+        for (int x = 1; x <= FieldConstant::WIDTH; ++x)
+            field->setColor(x, y, toPuyoColor(row[2 * x]));
+    }
+    return true;
+}
+
+} // namespace
+
+CorpusAnalyzer::CorpusAnalyzer(Executor* executor) :
+    executor_(executor)
+{
+}
+
+CorpusAnalyzer::~CorpusAnalyzer()
+{
+}
+
+void CorpusAnalyzer::addAnalyzer(const string& name, Factory factory)
+{
+    Entry entry;
+    entry.name = name;
+    entry.factory = std::move(factory);
+    entries_.push_back(std::move(entry));
+}
+
+bool CorpusAnalyzer::analyze(const vector<string>& paths)
+{
+    // Larger logs are analyzed first, so that a large log won't be left at the end.
+    vector<long long> sizes;
+    sizes.reserve(paths.size());
+    for (const string& path : paths)
+        sizes.push_back(fileSize(path));
+
+    vector<size_t> order(paths.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) { return sizes[lhs] > sizes[rhs]; });
+
+    // Each worker takes the next log until all the logs are taken.
+    int numShards = executor_ ? max(1, min<int>(executor_->numThreads(), paths.size())) : 1;
+    vector<Shard> shards(numShards);
+    for (Shard& shard : shards) {
+        for (const Entry& entry : entries_)
+            shard.analyzers.push_back(entry.factory());
+    }
+
+    atomic<size_t> next(0);
+    if (executor_) {
+        WaitGroup wg;
+        wg.add(numShards);
+        for (Shard& shard : shards) {
+            Shard* s = &shard;
+            executor_->submit([this, &paths, &order, &next, s, &wg]() {
+                runShard(paths, order, &next, s);
+                wg.done();
+            });
+        }
+        wg.waitUntilDone();
+    } else {
+        runShard(paths, order, &next, &shards.front());
+    }
+
+    // Reduces the results of the shards.
+    numGames_ = 0;
+    numFrames_ = 0;
+    failedPaths_.clear();
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        entries_[i].result = std::move(shards.front().analyzers[i]);
+        for (size_t j = 1; j < shards.size(); ++j)
+            entries_[i].result->merge(*shards[j].analyzers[i]);
+    }
+    for (const Shard& shard : shards) {
+        numGames_ += shard.numGames;
+        numFrames_ += shard.numFrames;
+        failedPaths_.insert(failedPaths_.end(), shard.failedPaths.begin(), shard.failedPaths.end());
+    }
+    sort(failedPaths_.begin(), failedPaths_.end());
+
+    return failedPaths_.empty();
+}
+
+void CorpusAnalyzer::runShard(const vector<string>& paths,
+                              const vector<size_t>& order,
+                              atomic<size_t>* next,
+                              Shard* shard)
+{
+    while (true) {
+        size_t i = next->fetch_add(1);
+        if (i >= order.size())
+            return;
+
+        const string& path = paths[order[i]];
+        int numGames = 0;
+        long long numFrames = analyzeLog(path, shard->analyzers, &numGames);
+        if (numFrames < 0) {
+            shard->failedPaths.push_back(path);
+            continue;
+        }
+
+        shard->numGames += numGames;
+        shard->numFrames += numFrames;
+    }
+}
+
+// static
+long long CorpusAnalyzer::analyzeLog(const string& path, const vector<unique_ptr<GameAnalyzer>>& analyzers,
+                                     int* numGames)
+{
+    file::MappedFile mapped;
+    if (!mapped.open(path))
+        return -1;
+
+    if (hasSuffix(path, ".txt"))
+        return analyzePuyofuLog(mapped.data(), mapped.size(), analyzers, numGames);
+
+    *numGames = 1;
+    if (hasSuffix(path, ".json"))
+        return analyzeJsonLog(mapped.data(), mapped.size(), analyzers);
+    return analyzeGameStateLog(mapped.data(), mapped.size(), analyzers);
+}
+
+// static
+long long CorpusAnalyzer::analyzeGameStateLog(const char* data, size_t size,
+                                              const vector<unique_ptr<GameAnalyzer>>& analyzers)
+{
+    GameStateLogReader reader;
+    if (!reader.open(data, size))
+        return -1;
+
+    for (const auto& analyzer : analyzers)
+        analyzer->newGameWillStart();
+
+    long long numFrames = 0;
+    GameState state(0);
+    GameResult gameResult = GameResult::PLAYING;
+    while (reader.next(&state)) {
+        for (const auto& analyzer : analyzers)
+            analyzer->onUpdate(state);
+        gameResult = state.gameResult();
+        ++numFrames;
+    }
+
+    // A broken log is analyzed up to the broken record, but it's reported as failed.
+    for (const auto& analyzer : analyzers)
+        analyzer->gameHasDone(gameResult);
+
+    return reader.hasError() ? -1 : numFrames;
+}
+
+// static
+long long CorpusAnalyzer::analyzeJsonLog(const char* data, size_t size,
+                                         const vector<unique_ptr<GameAnalyzer>>& analyzers)
+{
+    Json::Value root;
+    Json::Reader jsonReader;
+    if (!jsonReader.parse(data, data + size, root, false) || !root.isArray()) {
+        LOG(ERROR) << "broken json log: " << jsonReader.getFormattedErrorMessages();
+        return -1;
+    }
+
+    for (const auto& analyzer : analyzers)
+        analyzer->newGameWillStart();
+
+    // The JSON logs don't have frame ids, so the index is used instead.
+    GameResult gameResult = GameResult::PLAYING;
+    for (unsigned int i = 0; i < root.size(); ++i) {
+        const Json::Value& value = root[i];
+        GameState state(i + 1);
+        for (int pi = 0; pi < 2; ++pi) {
+            const string suffix = pi == 0 ? "1" : "2";
+            PlayerGameState* pgs = state.mutablePlayerGameState(pi);
+            pgs->field = PlainField(value["p" + suffix].asString());
+            pgs->kumipuyoSeq = KumipuyoSeq(value["n" + suffix].asString());
+            // The moving puyos are already in the field.
+            pgs->playable = false;
+            pgs->dead = false;
+            pgs->score = value["s" + suffix].asInt();
+            pgs->pendingOjama = value["o" + suffix].asInt();
+            pgs->fixedOjama = 0;
+            pgs->message = value["m" + suffix].asString();
+        }
+
+        gameResult = gameResultFromString(value["result"].asString());
+        for (const auto& analyzer : analyzers)
+            analyzer->onUpdate(state);
+    }
+
+    for (const auto& analyzer : analyzers)
+        analyzer->gameHasDone(gameResult);
+
+    return root.size();
+}
+
+// static
+long long CorpusAnalyzer::analyzePuyofuLog(const char* data, size_t size,
+                                           const vector<unique_ptr<GameAnalyzer>>& analyzers,
+                                           int* numGames)
+{
+    // A move is a line of TRANSITION_LOG, i.e. "<field before> <nexts> <field after>",
+    // or CoreField::toDebugString() and a line of the nexts in FIELD_LOG.
+    // Each game ends with "=== end ===".
+    *numGames = 0;
+    long long numFrames = 0;
+    int frameId = 0;
+    bool inGame = false;
+
+    auto startGame = [&]() {
+        if (inGame)
+            return;
+        inGame = true;
+        frameId = 0;
+        for (const auto& analyzer : analyzers)
+            analyzer->newGameWillStart();
+    };
+    // The results are not recorded.
+    auto endGame = [&]() {
+        if (!inGame)
+            return;
+        inGame = false;
+        ++*numGames;
+        for (const auto& analyzer : analyzers)
+            analyzer->gameHasDone(GameResult::GAME_HAS_STOPPED);
+    };
+    auto onMove = [&](const PlainField& field, const string& nexts) {
+        GameState state(++frameId);
+        for (int pi = 0; pi < 2; ++pi) {
+            PlayerGameState* pgs = state.mutablePlayerGameState(pi);
+            pgs->playable = false;
+            pgs->dead = false;
+            pgs->score = 0;
+            pgs->pendingOjama = 0;
+            pgs->fixedOjama = 0;
+        }
+        state.mutablePlayerGameState(0)->field = field;
+        state.mutablePlayerGameState(0)->kumipuyoSeq = KumipuyoSeq(nexts);
+        for (const auto& analyzer : analyzers)
+            analyzer->onUpdate(state);
+        ++numFrames;
+    };
+    // A broken log is analyzed up to the broken move, but it's reported as failed.
+    auto fail = [&](const char* reason) {
+        LOG(ERROR) << "broken puyofu log: " << reason;
+        endGame();
+        return -1LL;
+    };
+
+    const char* p = data;
+    const char* end = data + size;
+    string line;
+    while (nextLine(&p, end, &line)) {
+        if (line == "=== end ===") {
+            startGame();
+            endGame();
+            continue;
+        }
+        if (line.empty())
+            continue;
+
+        startGame();
+        if (line[0] == '#') {
+            vector<string> rows { line };
+            while (rows.size() < static_cast<size_t>(FieldConstant::MAP_HEIGHT) && nextLine(&p, end, &line))
+                rows.push_back(line);
+            PlainField field;
+            if (!parseDebugStringRows(rows, &field))
+                return fail("broken field");
+            // The heights, and the nexts. toDebugString() ends with a newline,
+            // so an empty line comes before the nexts.
+            string nexts;
+            if (!nextLine(&p, end, &line) || !nextLine(&p, end, &line) || !line.empty() ||
+                !nextLine(&p, end, &nexts))
+                return fail("no nexts");
+            onMove(field, nexts);
+            continue;
+        }
+
+        size_t first = line.find(' ');
+        size_t last = line.rfind(' ');
+        if (first == string::npos || first == last)
+            return fail("broken transition");
+        onMove(PlainField(line.substr(last + 1)), line.substr(first + 1, last - first - 1));
+    }
+
+    if (inGame)
+        return fail("no end of the game");
+    return numFrames;
+}
@@ -0,0 +1,103 @@
+#ifndef CORE_SERVER_CORPUS_ANALYZER_H_
+#define CORE_SERVER_CORPUS_ANALYZER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/noncopyable.h"
+#include "core/server/game_state_observer.h"
+
+class Executor;
+class GameState;
+
+// GameAnalyzer computes statistics of games. A game is given as
+// newGameWillStart(), onUpdate() for each frame, and gameHasDone().
+//
+// CorpusAnalyzer makes an analyzer for each worker with a factory, so
+// an analyzer doesn't need to be thread-safe. The results of the workers
+// are reduced into one with merge().
+class GameAnalyzer : public GameStateObserver {
+public:
+    virtual ~GameAnalyzer() {}
+
+    // Merges the result of |other|, which is made by the same factory.
+    virtual void merge(const GameAnalyzer& other) = 0;
+    virtual std::string toString() const = 0;
+};
+
+// CorpusAnalyzer runs GameAnalyzers on a corpus of game logs.
+// The logs are memory-mapped, and sharded across the threads of an executor.
+// Game state logs (.bin), the JSON logs written by the old GameStateRecorder, and
+// the text logs written by PuyofuRecorder (.txt) are supported.
+// The JSON logs have only fields, scores, ojama, nexts and messages.
+// A text log has the games of one player, which are given as the first player.
+// They have only the fields after each move and the nexts, and no game results.
+class CorpusAnalyzer : noncopyable {
+public:
+    typedef std::function<std::unique_ptr<GameAnalyzer> ()> Factory;
+
+    // If |executor| is nullptr, the logs are analyzed in the caller thread.
+    explicit CorpusAnalyzer(Executor* executor = nullptr);
+    ~CorpusAnalyzer();
+
+    void addAnalyzer(const std::string& name, Factory);
+
+    // Analyzes the logs in |paths|, and replaces the results.
+    // Returns false if some logs couldn't be read. The other logs are still analyzed.
+    bool analyze(const std::vector<std::string>& paths);
+
+    int numAnalyzers() const { return static_cast<int>(entries_.size()); }
+    const std::string& name(int i) const { return entries_[i].name; }
+    // The merged result of the i-th analyzer. analyze() should be called before this.
+    const GameAnalyzer& result(int i) const { return *entries_[i].result; }
+
+    int numGames() const { return numGames_; }
+    long long numFrames() const { return numFrames_; }
+    const std::vector<std::string>& failedPaths() const { return failedPaths_; }
+
+private:
+    struct Entry {
+        std::string name;
+        Factory factory;
+        std::unique_ptr<GameAnalyzer> result;
+    };
+
+    // The result of a worker.
+    struct Shard {
+        std::vector<std::unique_ptr<GameAnalyzer>> analyzers;
+        int numGames = 0;
+        long long numFrames = 0;
+        std::vector<std::string> failedPaths;
+    };
+
+    void runShard(const std::vector<std::string>& paths,
+                  const std::vector<std::size_t>& order,
+                  std::atomic<std::size_t>* next,
+                  Shard*);
+
+    // Gives the games in |path| to |analyzers|, and sets the number of games to |numGames|.
+    // Returns the number of frames, or -1 on error.
+    static long long analyzeLog(const std::string& path,
+                                const std::vector<std::unique_ptr<GameAnalyzer>>& analyzers,
+                                int* numGames);
+    static long long analyzeGameStateLog(const char* data, std::size_t size,
+                                         const std::vector<std::unique_ptr<GameAnalyzer>>& analyzers);
+    static long long analyzeJsonLog(const char* data, std::size_t size,
+                                    const std::vector<std::unique_ptr<GameAnalyzer>>& analyzers);
+    static long long analyzePuyofuLog(const char* data, std::size_t size,
+                                      const std::vector<std::unique_ptr<GameAnalyzer>>& analyzers,
+                                      int* numGames);
+
+    Executor* executor_;
+    std::vector<Entry> entries_;
+
+    int numGames_ = 0;
+    long long numFrames_ = 0;
+    std::vector<std::string> failedPaths_;
+};
+
+#endif // CORE_SERVER_CORPUS_ANALYZER_H_
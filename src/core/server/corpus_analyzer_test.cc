@@ -0,0 +1,278 @@
+#include "core/server/corpus_analyzer.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/executor.h"
+#include "base/file/file.h"
+#include "base/file/temporary_file.h"
+#include "core/core_field.h"
+#include "core/plain_field.h"
+#include "core/server/game_state.h"
+#include "core/server/game_state_log_test_util.h"
+
+using namespace std;
+using game_state_log_test::initialPlayerGameState;
+using game_state_log_test::writeGameStateLog;
+
+namespace {
+
+// Makes a game whose final score of the first player is |score|.
+vector<GameState> makeGame(int numFrames, int score)
+{
+    vector<GameState> states;
+    for (int frameId = 1; frameId <= numFrames; ++frameId) {
+        GameState state(frameId);
+        for (int pi = 0; pi < 2; ++pi) {
+            PlayerGameState* pgs = state.mutablePlayerGameState(pi);
+            *pgs = initialPlayerGameState();
+            pgs->dead = pi == 1 && frameId == numFrames;
+            pgs->score = pi == 0 ? score * frameId / numFrames : 0;
+        }
+        states.push_back(state);
+    }
+    return states;
+}
+
+void writeJsonLog(const string& filename, const vector<GameState>& states)
+{
+    ostringstream ss;
+    ss << "[";
+    for (size_t i = 0; i < states.size(); ++i) {
+        if (i > 0)
+            ss << "," << endl;
+        ss << states[i].toJson();
+    }
+    ss << "]";
+
+    CHECK(file::writeFile(filename, ss.str()));
+}
+
+// Counts the games and the frames, and sums up the final scores of the first player.
+class ScoreAnalyzer : public GameAnalyzer {
+public:
+    void newGameWillStart() override { lastScore_ = 0; }
+    void onUpdate(const GameState& state) override
+    {
+        ++numFrames_;
+        lastScore_ = state.playerGameState(0).score;
+    }
+    void gameHasDone(GameResult result) override
+    {
+        ++numGames_;
+        totalScore_ += lastScore_;
+        if (result == GameResult::P1_WIN)
+            ++numWins_;
+    }
+
+    void merge(const GameAnalyzer& other) override
+    {
+        const ScoreAnalyzer& analyzer = static_cast<const ScoreAnalyzer&>(other);
+        numGames_ += analyzer.numGames_;
+        numFrames_ += analyzer.numFrames_;
+        numWins_ += analyzer.numWins_;
+        totalScore_ += analyzer.totalScore_;
+    }
+
+    string toString() const override
+    {
+        ostringstream ss;
+        ss << numGames_ << " " << numFrames_ << " " << numWins_ << " " << totalScore_;
+        return ss.str();
+    }
+
+private:
+    int numGames_ = 0;
+    int numFrames_ = 0;
+    int numWins_ = 0;
+    int totalScore_ = 0;
+    int lastScore_ = 0;
+};
+
+// Records the field and the nexts of the first player in each frame.
+class MoveAnalyzer : public GameAnalyzer {
+public:
+    void newGameWillStart() override { moves_.push_back(vector<string>()); }
+    void onUpdate(const GameState& state) override
+    {
+        const PlayerGameState& pgs = state.playerGameState(0);
+        moves_.back().push_back(pgs.field.toString('.') + " " + pgs.kumipuyoSeq.toString());
+    }
+    void gameHasDone(GameResult) override {}
+
+    void merge(const GameAnalyzer& other) override
+    {
+        const MoveAnalyzer& analyzer = static_cast<const MoveAnalyzer&>(other);
+        moves_.insert(moves_.end(), analyzer.moves_.begin(), analyzer.moves_.end());
+    }
+
+    string toString() const override { return string(); }
+
+    const vector<vector<string>>& moves() const { return moves_; }
+
+private:
+    vector<vector<string>> moves_;
+};
+
+const PlainField PUYOFU_FIELDS[] = {
+    PlainField("RB...."),
+    PlainField("RB...."
+               "RBYY.."),
+    PlainField("RB...G"
+               "RBYYGG"),
+};
+const char* const PUYOFU_NEXTS[] = { "RBYYGG", "YYGGRR", "GGRRBB" };
+
+// Writes a log as PuyofuRecorder does, which has 2 games: the moves in PUYOFU_FIELDS,
+// and the first 2 of them.
+void writePuyofuLog(const string& filename, bool fieldLog)
+{
+    ostringstream ss;
+    for (int numMoves : { 3, 2 }) {
+        PlainField before;
+        for (int i = 0; i < numMoves; ++i) {
+            if (fieldLog) {
+                // PuyofuRecorder::emitFieldLog()
+                ss << CoreField(PUYOFU_FIELDS[i]).toDebugString() << "\n" << PUYOFU_NEXTS[i] << "\n";
+            } else {
+                // PuyofuRecorder::emitTransitionLog()
+                string beforeString = before.toString('0');
+                if (beforeString.empty())
+                    beforeString = "0";
+                ss << beforeString << " " << PUYOFU_NEXTS[i] << " " << PUYOFU_FIELDS[i].toString('0') << "\n";
+            }
+            before = PUYOFU_FIELDS[i];
+        }
+        ss << "=== end ===\n";
+    }
+    CHECK(file::writeFile(filename, ss.str()));
+}
+
+void expectPuyofuMoves(const MoveAnalyzer& analyzer)
+{
+    ASSERT_EQ(2U, analyzer.moves().size());
+    for (size_t game = 0; game < analyzer.moves().size(); ++game) {
+        const vector<string>& moves = analyzer.moves()[game];
+        ASSERT_EQ(game == 0 ? 3U : 2U, moves.size());
+        for (size_t i = 0; i < moves.size(); ++i)
+            EXPECT_EQ(PUYOFU_FIELDS[i].toString('.') + " " + PUYOFU_NEXTS[i], moves[i]);
+    }
+}
+
+class CorpusAnalyzerTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        // 10 game state logs and 2 JSON logs.
+        for (int i = 1; i <= 10; ++i) {
+            files_.emplace_back(".bin");
+            writeGameStateLog(files_.back().path(), makeGame(i * 50, i * 100));
+        }
+        for (int i = 1; i <= 2; ++i) {
+            files_.emplace_back(".json");
+            writeJsonLog(files_.back().path(), makeGame(i * 10, i * 1000));
+        }
+        for (const file::TemporaryFile& f : files_)
+            paths_.push_back(f.path());
+    }
+
+    vector<file::TemporaryFile> files_;
+    vector<string> paths_;
+};
+
+} // namespace
+
+TEST_F(CorpusAnalyzerTest, analyze)
+{
+    CorpusAnalyzer analyzer;
+    analyzer.addAnalyzer("score", []() { return unique_ptr<GameAnalyzer>(new ScoreAnalyzer); });
+    ASSERT_TRUE(analyzer.analyze(paths_));
+
+    EXPECT_EQ(12, analyzer.numGames());
+    EXPECT_EQ(2750 + 30, analyzer.numFrames());
+    ASSERT_EQ(1, analyzer.numAnalyzers());
+    EXPECT_EQ("score", analyzer.name(0));
+    EXPECT_EQ("12 2780 12 8500", analyzer.result(0).toString());
+}
+
+TEST_F(CorpusAnalyzerTest, analyzeInParallel)
+{
+    Executor executor(4);
+    executor.start();
+
+    CorpusAnalyzer analyzer(&executor);
+    analyzer.addAnalyzer("score", []() { return unique_ptr<GameAnalyzer>(new ScoreAnalyzer); });
+    analyzer.addAnalyzer("score2", []() { return unique_ptr<GameAnalyzer>(new ScoreAnalyzer); });
+    ASSERT_TRUE(analyzer.analyze(paths_));
+
+    EXPECT_EQ(12, analyzer.numGames());
+    EXPECT_EQ(2780, analyzer.numFrames());
+    ASSERT_EQ(2, analyzer.numAnalyzers());
+    EXPECT_EQ("12 2780 12 8500", analyzer.result(0).toString());
+    EXPECT_EQ("12 2780 12 8500", analyzer.result(1).toString());
+}
+
+TEST_F(CorpusAnalyzerTest, brokenLogs)
+{
+    string content;
+    ASSERT_TRUE(file::readFile(paths_[0], &content));
+    content.resize(content.size() - 1);
+    ASSERT_TRUE(file::writeFile(paths_[0], content));
+
+    vector<string> paths(paths_);
+    paths.push_back("/nonexistent/corpus_analyzer_test.bin");
+
+    CorpusAnalyzer analyzer;
+    analyzer.addAnalyzer("score", []() { return unique_ptr<GameAnalyzer>(new ScoreAnalyzer); });
+    EXPECT_FALSE(analyzer.analyze(paths));
+
+    EXPECT_EQ(11, analyzer.numGames());
+    EXPECT_EQ((vector<string> { "/nonexistent/corpus_analyzer_test.bin", paths_[0] }), analyzer.failedPaths());
+}
+
+TEST(CorpusAnalyzerPuyofuLogTest, transitionLog)
+{
+    file::TemporaryFile tmp(".txt");
+    writePuyofuLog(tmp.path(), false);
+
+    CorpusAnalyzer analyzer;
+    analyzer.addAnalyzer("move", []() { return unique_ptr<GameAnalyzer>(new MoveAnalyzer); });
+    ASSERT_TRUE(analyzer.analyze(vector<string> { tmp.path() }));
+
+    EXPECT_EQ(2, analyzer.numGames());
+    EXPECT_EQ(5, analyzer.numFrames());
+    expectPuyofuMoves(static_cast<const MoveAnalyzer&>(analyzer.result(0)));
+}
+
+TEST(CorpusAnalyzerPuyofuLogTest, fieldLog)
+{
+    file::TemporaryFile tmp(".txt");
+    writePuyofuLog(tmp.path(), true);
+
+    CorpusAnalyzer analyzer;
+    analyzer.addAnalyzer("move", []() { return unique_ptr<GameAnalyzer>(new MoveAnalyzer); });
+    ASSERT_TRUE(analyzer.analyze(vector<string> { tmp.path() }));
+
+    EXPECT_EQ(2, analyzer.numGames());
+    EXPECT_EQ(5, analyzer.numFrames());
+    expectPuyofuMoves(static_cast<const MoveAnalyzer&>(analyzer.result(0)));
+}
+
+TEST(CorpusAnalyzerPuyofuLogTest, brokenLog)
+{
+    file::TemporaryFile tmp(".txt");
+    writePuyofuLog(tmp.path(), false);
+    string content;
+    ASSERT_TRUE(file::readFile(tmp.path(), &content));
+    // Drops "=== end ===" of the last game.
+    content.resize(content.size() - string("=== end ===\n").size());
+    ASSERT_TRUE(file::writeFile(tmp.path(), content));
+
+    CorpusAnalyzer analyzer;
+    analyzer.addAnalyzer("move", []() { return unique_ptr<GameAnalyzer>(new MoveAnalyzer); });
+    EXPECT_FALSE(analyzer.analyze(vector<string> { tmp.path() }));
+    EXPECT_EQ(vector<string> { tmp.path() }, analyzer.failedPaths());
+}
@@ -0,0 +1,219 @@
+#include "core/server/game_analyzers.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "core/core_field.h"
+#include "core/rensa/rensa_detector.h"
+
+using namespace std;
+
+void IntHistogram::merge(const IntHistogram& other)
+{
+    for (const auto& entry : other.counts_)
+        counts_[entry.first] += entry.second;
+}
+
+int IntHistogram::count(int value) const
+{
+    auto it = counts_.find(value);
+    return it == counts_.end() ? 0 : it->second;
+}
+
+string IntHistogram::toString() const
+{
+    ostringstream ss;
+    for (const auto& entry : counts_)
+        ss << "  " << entry.first << ": " << entry.second << endl;
+    return ss.str();
+}
+
+void IntSummary::add(long long value)
+{
+    ++count_;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void IntSummary::merge(const IntSummary& other)
+{
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+string IntSummary::toString() const
+{
+    if (count_ == 0)
+        return "count=0";
+
+    ostringstream ss;
+    ss << "count=" << count_
+       << " average=" << static_cast<double>(sum_) / count_
+       << " min=" << min_
+       << " max=" << max_;
+    return ss.str();
+}
+
+void MaxChainAnalyzer::newGameWillStart()
+{
+    FieldAnalyzer::newGameWillStart();
+    for (int pi = 0; pi < 2; ++pi) {
+        inRensa_[pi] = false;
+        maxChains_[pi] = 0;
+    }
+}
+
+void MaxChainAnalyzer::gameHasDone(GameResult)
+{
+    for (int pi = 0; pi < 2; ++pi)
+        maxChainHistogram_.add(maxChains_[pi]);
+}
+
+void MaxChainAnalyzer::onFieldChanged(int pi, const PlainField& field)
+{
+    CoreField cf(CoreField::fromPlainFieldWithDrop(field));
+    if (!cf.rensaWillOccur()) {
+        inRensa_[pi] = false;
+        return;
+    }
+
+    // The rest of a rensa is on the field until the rensa finishes.
+    if (inRensa_[pi])
+        return;
+    inRensa_[pi] = true;
+
+    int chains = cf.simulate().chains;
+    chainHistogram_.add(chains);
+    maxChains_[pi] = max(maxChains_[pi], chains);
+}
+
+void MaxChainAnalyzer::mergeFrom(const MaxChainAnalyzer& other)
+{
+    chainHistogram_.merge(other.chainHistogram_);
+    maxChainHistogram_.merge(other.maxChainHistogram_);
+}
+
+string MaxChainAnalyzer::toString() const
+{
+    return "fired chains:\n" + chainHistogram_.toString() +
+        "max chain of a player in a game:\n" + maxChainHistogram_.toString();
+}
+
+void OjamaAnalyzer::newGameWillStart()
+{
+    FieldAnalyzer::newGameWillStart();
+    for (int pi = 0; pi < 2; ++pi) {
+        numOjama_[pi] = 0;
+        received_[pi] = 0;
+    }
+}
+
+void OjamaAnalyzer::gameHasDone(GameResult)
+{
+    exchanged_.add(received_[0] + received_[1]);
+    for (int pi = 0; pi < 2; ++pi)
+        receivedByPlayer_.add(received_[pi]);
+}
+
+void OjamaAnalyzer::onFieldChanged(int pi, const PlainField& field)
+{
+    int numOjama = 0;
+    for (int x = 1; x <= PlainField::WIDTH; ++x) {
+        for (int y = 1; y <= PlainField::HEIGHT + 1; ++y) {
+            if (field.color(x, y) == PuyoColor::OJAMA)
+                ++numOjama;
+        }
+    }
+
+    if (numOjama > numOjama_[pi])
+        received_[pi] += numOjama - numOjama_[pi];
+    numOjama_[pi] = numOjama;
+}
+
+void OjamaAnalyzer::mergeFrom(const OjamaAnalyzer& other)
+{
+    exchanged_.merge(other.exchanged_);
+    receivedByPlayer_.merge(other.receivedByPlayer_);
+}
+
+string OjamaAnalyzer::toString() const
+{
+    return "exchanged in a game: " + exchanged_.toString() + "\n" +
+        "received by a player in a game: " + receivedByPlayer_.toString() + "\n";
+}
+
+void DecisionTimingAnalyzer::newGameWillStart()
+{
+    for (int pi = 0; pi < 2; ++pi)
+        requestedFrameIds_[pi] = -1;
+}
+
+void DecisionTimingAnalyzer::onUpdate(const GameState& state)
+{
+    for (int pi = 0; pi < 2; ++pi) {
+        const UserEvent& event = state.playerGameState(pi).event;
+        if (event.decisionRequest) {
+            requestedFrameIds_[pi] = state.frameId();
+        } else if (event.grounded && requestedFrameIds_[pi] >= 0) {
+            frames_.add(state.frameId() - requestedFrameIds_[pi]);
+            requestedFrameIds_[pi] = -1;
+        }
+    }
+}
+
+void DecisionTimingAnalyzer::merge(const GameAnalyzer& other)
+{
+    frames_.merge(static_cast<const DecisionTimingAnalyzer&>(other).frames_);
+}
+
+string DecisionTimingAnalyzer::toString() const
+{
+    return "frames to ground: " + frames_.toString() + "\n";
+}
+
+void RensaPotentialAnalyzer::newGameWillStart()
+{
+    FieldAnalyzer::newGameWillStart();
+    for (int pi = 0; pi < 2; ++pi)
+        maxPotentials_[pi] = 0;
+}
+
+void RensaPotentialAnalyzer::gameHasDone(GameResult)
+{
+    for (int pi = 0; pi < 2; ++pi)
+        maxPotentialHistogram_.add(maxPotentials_[pi]);
+}
+
+void RensaPotentialAnalyzer::onFieldChanged(int pi, const PlainField& field)
+{
+    // Skips the fields in a rensa or in falling.
+    CoreField cf(CoreField::fromPlainFieldWithDrop(field));
+    if (cf.rensaWillOccur() || !(cf.toPlainField() == field))
+        return;
+
+    int maxChains = 0;
+    auto callback = [&maxChains](CoreField&& complementedField, const ColumnPuyoList&) -> RensaResult {
+        RensaResult result = complementedField.simulate();
+        maxChains = max(maxChains, result.chains);
+        return result;
+    };
+    RensaDetector::detectIteratively(cf, RensaDetectorStrategy::defaultDropStrategy(), maxIteration_, callback);
+
+    potentials_.add(maxChains);
+    maxPotentials_[pi] = max(maxPotentials_[pi], maxChains);
+}
+
+void RensaPotentialAnalyzer::mergeFrom(const RensaPotentialAnalyzer& other)
+{
+    potentials_.merge(other.potentials_);
+    maxPotentialHistogram_.merge(other.maxPotentialHistogram_);
+}
+
+string RensaPotentialAnalyzer::toString() const
+{
+    return "potential of a field: " + potentials_.toString() + "\n" +
+        "max potential of a player in a game:\n" + maxPotentialHistogram_.toString();
+}
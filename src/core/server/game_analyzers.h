@@ -0,0 +1,163 @@
+#ifndef CORE_SERVER_GAME_ANALYZERS_H_
+#define CORE_SERVER_GAME_ANALYZERS_H_
+
+#include <climits>
+#include <map>
+#include <string>
+
+#include "core/plain_field.h"
+#include "core/server/corpus_analyzer.h"
+#include "core/server/game_state.h"
+
+// The GameAnalyzers which the corpus_analyzer tool runs.
+
+// Histogram of integer values, e.g. chains.
+class IntHistogram {
+public:
+    void add(int value) { ++counts_[value]; }
+    void merge(const IntHistogram&);
+
+    // Returns how many times |value| is added.
+    int count(int value) const;
+    std::string toString() const;
+
+private:
+    std::map<int, int> counts_;
+};
+
+// Count, sum, min and max of values.
+class IntSummary {
+public:
+    void add(long long value);
+    void merge(const IntSummary&);
+
+    long long count() const { return count_; }
+    long long sum() const { return sum_; }
+    long long min() const { return min_; }
+    long long max() const { return max_; }
+    std::string toString() const;
+
+private:
+    long long count_ = 0;
+    long long sum_ = 0;
+    long long min_ = LLONG_MAX;
+    long long max_ = LLONG_MIN;
+};
+
+// Base of the analyzers that look at the fields. Derived::onFieldChanged() is called
+// when the field of a player is changed, and Derived::mergeFrom() from merge().
+template<typename Derived>
+class FieldAnalyzer : public GameAnalyzer {
+public:
+    void newGameWillStart() override
+    {
+        for (int pi = 0; pi < 2; ++pi)
+            fields_[pi] = PlainField();
+    }
+
+    void onUpdate(const GameState& state) override
+    {
+        for (int pi = 0; pi < 2; ++pi) {
+            const PlainField& field = state.playerGameState(pi).field;
+            if (field == fields_[pi])
+                continue;
+            fields_[pi] = field;
+            static_cast<Derived*>(this)->onFieldChanged(pi, field);
+        }
+    }
+
+    void merge(const GameAnalyzer& other) override
+    {
+        static_cast<Derived*>(this)->mergeFrom(static_cast<const Derived&>(other));
+    }
+
+private:
+    PlainField fields_[2];
+};
+
+// The chains fired in the games, and the max chain of each player in a game.
+class MaxChainAnalyzer : public FieldAnalyzer<MaxChainAnalyzer> {
+public:
+    void newGameWillStart() override;
+    void gameHasDone(GameResult) override;
+    std::string toString() const override;
+
+    const IntHistogram& chainHistogram() const { return chainHistogram_; }
+    const IntHistogram& maxChainHistogram() const { return maxChainHistogram_; }
+
+private:
+    friend class FieldAnalyzer<MaxChainAnalyzer>;
+    void onFieldChanged(int pi, const PlainField&);
+    void mergeFrom(const MaxChainAnalyzer&);
+
+    bool inRensa_[2];
+    int maxChains_[2];
+    IntHistogram chainHistogram_;
+    IntHistogram maxChainHistogram_;
+};
+
+// The ojama puyos dropped on the fields.
+class OjamaAnalyzer : public FieldAnalyzer<OjamaAnalyzer> {
+public:
+    void newGameWillStart() override;
+    void gameHasDone(GameResult) override;
+    std::string toString() const override;
+
+    // The ojama puyos received by both players in a game.
+    const IntSummary& exchanged() const { return exchanged_; }
+    // The ojama puyos received by a player in a game.
+    const IntSummary& receivedByPlayer() const { return receivedByPlayer_; }
+
+private:
+    friend class FieldAnalyzer<OjamaAnalyzer>;
+    void onFieldChanged(int pi, const PlainField&);
+    void mergeFrom(const OjamaAnalyzer&);
+
+    int numOjama_[2];
+    int received_[2];
+    IntSummary exchanged_;
+    IntSummary receivedByPlayer_;
+};
+
+// The frames from a decision request to the grounding of the kumipuyo.
+// JSON logs don't have events, so they are not counted.
+class DecisionTimingAnalyzer : public GameAnalyzer {
+public:
+    void newGameWillStart() override;
+    void onUpdate(const GameState&) override;
+    void gameHasDone(GameResult) override {}
+    void merge(const GameAnalyzer&) override;
+    std::string toString() const override;
+
+    const IntSummary& frames() const { return frames_; }
+
+private:
+    int requestedFrameIds_[2];
+    IntSummary frames_;
+};
+
+// The max chain which RensaDetector finds on each stable field, i.e. the potential of the fields.
+class RensaPotentialAnalyzer : public FieldAnalyzer<RensaPotentialAnalyzer> {
+public:
+    // |maxIteration| is passed to RensaDetector::detectIteratively().
+    explicit RensaPotentialAnalyzer(int maxIteration) : maxIteration_(maxIteration) {}
+
+    void newGameWillStart() override;
+    void gameHasDone(GameResult) override;
+    std::string toString() const override;
+
+    const IntSummary& potentials() const { return potentials_; }
+    const IntHistogram& maxPotentialHistogram() const { return maxPotentialHistogram_; }
+
+private:
+    friend class FieldAnalyzer<RensaPotentialAnalyzer>;
+    void onFieldChanged(int pi, const PlainField&);
+    void mergeFrom(const RensaPotentialAnalyzer&);
+
+    const int maxIteration_;
+    int maxPotentials_[2];
+    IntSummary potentials_;
+    IntHistogram maxPotentialHistogram_;
+};
+
+#endif // CORE_SERVER_GAME_ANALYZERS_H_
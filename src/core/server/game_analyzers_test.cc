@@ -0,0 +1,173 @@
+#include "core/server/game_analyzers.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/executor.h"
+#include "base/file/temporary_file.h"
+#include "core/plain_field.h"
+#include "core/server/corpus_analyzer.h"
+#include "core/server/game_state.h"
+#include "core/server/game_state_log_test_util.h"
+
+using namespace std;
+using game_state_log_test::initialPlayerGameState;
+using game_state_log_test::writeGameStateLog;
+
+namespace {
+
+// A frame of a game. An empty string is an empty field.
+struct Frame {
+    int frameId;
+    const char* fields[2];
+    // The player who gets a decision request, or -1.
+    int requested;
+    // The player whose kumipuyo is grounded, or -1.
+    int grounded;
+};
+
+// The first player fires a 2 rensa, and the second player receives 6 ojama.
+// The frames to ground are 1 and 3. The stable fields have potentials 1, 0 and 1.
+const Frame GAME1[] = {
+    { 1, { "", "" }, 0, -1 },
+    { 2, { "B....."
+           "RBB..."
+           "RRRBBY", "" }, -1, 0 },
+    { 3, { "BBBBBY", "" }, -1, -1 },
+    { 4, { ".....Y", "OOOOOO" }, 1, -1 },
+    { 7, { ".....Y", "RRR..."
+                     "OOOOOO" }, -1, 1 },
+};
+
+// The first player receives 6 ojama. The frames to ground is 2.
+// The stable field has potential 1.
+const Frame GAME2[] = {
+    { 1, { "", "" }, 0, -1 },
+    { 3, { "RRR..."
+           "OOOOOO", "" }, -1, 0 },
+};
+
+template<size_t N>
+void writeGame(const string& filename, const Frame (&frames)[N])
+{
+    vector<GameState> states;
+    for (const Frame& frame : frames) {
+        GameState state(frame.frameId);
+        for (int pi = 0; pi < 2; ++pi) {
+            PlayerGameState* pgs = state.mutablePlayerGameState(pi);
+            *pgs = initialPlayerGameState();
+            pgs->field = PlainField(frame.fields[pi]);
+            pgs->event.decisionRequest = frame.requested == pi;
+            pgs->event.grounded = frame.grounded == pi;
+        }
+        states.push_back(state);
+    }
+    writeGameStateLog(filename, states);
+}
+
+class GameAnalyzersTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        files_.emplace_back(".bin");
+        writeGame(files_.back().path(), GAME1);
+        files_.emplace_back(".bin");
+        writeGame(files_.back().path(), GAME2);
+        for (const file::TemporaryFile& f : files_)
+            paths_.push_back(f.path());
+    }
+
+    // Analyzes the corpus on 2 workers, so the results of the games are merged.
+    template<typename T>
+    void analyze(CorpusAnalyzer::Factory factory, T* result)
+    {
+        Executor executor(2);
+        executor.start();
+
+        CorpusAnalyzer analyzer(&executor);
+        analyzer.addAnalyzer("test", factory);
+        ASSERT_TRUE(analyzer.analyze(paths_));
+
+        EXPECT_EQ(2, analyzer.numGames());
+        result->merge(analyzer.result(0));
+    }
+
+    vector<file::TemporaryFile> files_;
+    vector<string> paths_;
+};
+
+} // namespace
+
+TEST_F(GameAnalyzersTest, maxChain)
+{
+    MaxChainAnalyzer result;
+    analyze([]() { return unique_ptr<GameAnalyzer>(new MaxChainAnalyzer); }, &result);
+
+    // The rest of the rensa in frame 3 isn't counted again.
+    EXPECT_EQ(1, result.chainHistogram().count(2));
+    EXPECT_EQ(0, result.chainHistogram().count(1));
+    EXPECT_EQ(1, result.maxChainHistogram().count(2));
+    EXPECT_EQ(3, result.maxChainHistogram().count(0));
+}
+
+TEST_F(GameAnalyzersTest, ojama)
+{
+    OjamaAnalyzer result;
+    analyze([]() { return unique_ptr<GameAnalyzer>(new OjamaAnalyzer); }, &result);
+
+    EXPECT_EQ(2, result.exchanged().count());
+    EXPECT_EQ(12, result.exchanged().sum());
+    EXPECT_EQ(6, result.exchanged().min());
+    EXPECT_EQ(6, result.exchanged().max());
+
+    EXPECT_EQ(4, result.receivedByPlayer().count());
+    EXPECT_EQ(12, result.receivedByPlayer().sum());
+    EXPECT_EQ(0, result.receivedByPlayer().min());
+    EXPECT_EQ(6, result.receivedByPlayer().max());
+}
+
+TEST_F(GameAnalyzersTest, decisionTiming)
+{
+    DecisionTimingAnalyzer result;
+    analyze([]() { return unique_ptr<GameAnalyzer>(new DecisionTimingAnalyzer); }, &result);
+
+    EXPECT_EQ(3, result.frames().count());
+    EXPECT_EQ(1 + 3 + 2, result.frames().sum());
+    EXPECT_EQ(1, result.frames().min());
+    EXPECT_EQ(3, result.frames().max());
+}
+
+TEST_F(GameAnalyzersTest, rensaPotential)
+{
+    RensaPotentialAnalyzer result(2);
+    analyze([]() { return unique_ptr<GameAnalyzer>(new RensaPotentialAnalyzer(2)); }, &result);
+
+    // The fields in the rensa are skipped.
+    EXPECT_EQ(4, result.potentials().count());
+    EXPECT_EQ(3, result.potentials().sum());
+    EXPECT_EQ(0, result.potentials().min());
+    EXPECT_EQ(1, result.potentials().max());
+
+    EXPECT_EQ(3, result.maxPotentialHistogram().count(1));
+    EXPECT_EQ(1, result.maxPotentialHistogram().count(0));
+}
+
+TEST(IntSummaryTest, merge)
+{
+    IntSummary a;
+    a.add(3);
+    a.add(-1);
+    IntSummary b;
+    EXPECT_EQ("count=0", b.toString());
+    b.add(10);
+    a.merge(b);
+
+    EXPECT_EQ(3, a.count());
+    EXPECT_EQ(12, a.sum());
+    EXPECT_EQ(-1, a.min());
+    EXPECT_EQ(10, a.max());
+    EXPECT_EQ("count=3 average=4 min=-1 max=10", a.toString());
+}
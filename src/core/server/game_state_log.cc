@@ -0,0 +1,625 @@
+#include "core/server/game_state_log.h"
+
+#include <fstream>
+
+#include <glog/logging.h>
+
+#include "core/field_constant.h"
+
+using namespace std;
+using game_state_log::RecordType;
+
+namespace {
+
+const int NUM_CELLS = FieldConstant::MAP_WIDTH * FieldConstant::MAP_HEIGHT;
+
+// The bits of the values in a player record.
+enum PlayerValue {
+    FIELD = 1 << 0,
+    KUMIPUYO_SEQ = 1 << 1,
+    KUMIPUYO_POS = 1 << 2,
+    EVENT = 1 << 3,
+    FLAGS = 1 << 4,
+    SCORE = 1 << 5,
+    OJAMA = 1 << 6,
+    DECISION = 1 << 7,
+    MESSAGE = 1 << 8,
+    ALL_VALUES = (1 << 9) - 1,
+};
+
+PuyoColor cellColor(const PlainField& field, int cell)
+{
+    return field.color(cell / FieldConstant::MAP_HEIGHT, cell % FieldConstant::MAP_HEIGHT);
+}
+
+int encodeEvent(const UserEvent& event)
+{
+    return (event.wnextAppeared << 0) |
+        (event.grounded << 1) |
+        (event.preDecisionRequest << 2) |
+        (event.decisionRequest << 3) |
+        (event.decisionRequestAgain << 4) |
+        (event.ojamaDropped << 5) |
+        (event.puyoErased << 6);
+}
+
+UserEvent decodeEvent(int bits)
+{
+    UserEvent event;
+    event.wnextAppeared = bits & (1 << 0);
+    event.grounded = bits & (1 << 1);
+    event.preDecisionRequest = bits & (1 << 2);
+    event.decisionRequest = bits & (1 << 3);
+    event.decisionRequestAgain = bits & (1 << 4);
+    event.ojamaDropped = bits & (1 << 5);
+    event.puyoErased = bits & (1 << 6);
+    return event;
+}
+
+int encodeFlags(const PlayerGameState& pgs)
+{
+    return (pgs.dead << 0) | (pgs.playable << 1);
+}
+
+class Encoder {
+public:
+    explicit Encoder(string* buf) : buf_(buf) {}
+
+    void putByte(int v) { buf_->push_back(static_cast<char>(v)); }
+    void putVarint(uint64_t v)
+    {
+        while (v >= 0x80) {
+            putByte(static_cast<int>(v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        putByte(static_cast<int>(v));
+    }
+    // Zigzag encoding, so small negative values are also short.
+    void putSignedVarint(int64_t v) { putVarint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+    void putString(const string& s)
+    {
+        putVarint(s.size());
+        buf_->append(s);
+    }
+
+private:
+    string* buf_;
+};
+
+class Decoder {
+public:
+    Decoder(const char* data, size_t size) : p_(data), end_(data + size) {}
+
+    bool ok() const { return ok_; }
+    bool isEnd() const { return p_ == end_; }
+    size_t rest() const { return end_ - p_; }
+
+    int getByte()
+    {
+        if (p_ == end_) {
+            ok_ = false;
+            return 0;
+        }
+        return static_cast<uint8_t>(*p_++);
+    }
+    uint64_t getVarint()
+    {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int b = getByte();
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return v;
+        }
+        ok_ = false;
+        return 0;
+    }
+    int64_t getSignedVarint()
+    {
+        uint64_t v = getVarint();
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+    string getString()
+    {
+        uint64_t size = getVarint();
+        if (!ok_ || size > static_cast<uint64_t>(end_ - p_)) {
+            ok_ = false;
+            return string();
+        }
+        string s(p_, size);
+        p_ += size;
+        return s;
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+    bool ok_ = true;
+};
+
+void encodePlayer(const PlayerGameState& pgs, const PlayerGameState* prev, Encoder* enc)
+{
+    int values = ALL_VALUES;
+    if (prev) {
+        values = 0;
+        for (int i = 0; i < NUM_CELLS; ++i) {
+            if (cellColor(pgs.field, i) != cellColor(prev->field, i)) {
+                values |= FIELD;
+                break;
+            }
+        }
+        if (!(pgs.kumipuyoSeq == prev->kumipuyoSeq))
+            values |= KUMIPUYO_SEQ;
+        if (pgs.kumipuyoPos != prev->kumipuyoPos)
+            values |= KUMIPUYO_POS;
+        if (encodeEvent(pgs.event) != encodeEvent(prev->event))
+            values |= EVENT;
+        if (encodeFlags(pgs) != encodeFlags(*prev))
+            values |= FLAGS;
+        if (pgs.score != prev->score)
+            values |= SCORE;
+        if (pgs.pendingOjama != prev->pendingOjama || pgs.fixedOjama != prev->fixedOjama)
+            values |= OJAMA;
+        if (!(pgs.decision == prev->decision))
+            values |= DECISION;
+        if (pgs.message != prev->message)
+            values |= MESSAGE;
+    }
+
+    enc->putVarint(values);
+    if (values & FIELD) {
+        if (prev) {
+            // The changed cells only.
+            int numChanged = 0;
+            for (int i = 0; i < NUM_CELLS; ++i) {
+                if (cellColor(pgs.field, i) != cellColor(prev->field, i))
+                    ++numChanged;
+            }
+            enc->putVarint(numChanged);
+            for (int i = 0; i < NUM_CELLS; ++i) {
+                if (cellColor(pgs.field, i) != cellColor(prev->field, i)) {
+                    enc->putByte(i);
+                    enc->putByte(static_cast<int>(cellColor(pgs.field, i)));
+                }
+            }
+        } else {
+            for (int i = 0; i < NUM_CELLS; ++i)
+                enc->putByte(static_cast<int>(cellColor(pgs.field, i)));
+        }
+    }
+    if (values & KUMIPUYO_SEQ) {
+        enc->putVarint(pgs.kumipuyoSeq.size());
+        for (int i = 0; i < pgs.kumipuyoSeq.size(); ++i) {
+            enc->putByte(static_cast<int>(pgs.kumipuyoSeq.axis(i)));
+            enc->putByte(static_cast<int>(pgs.kumipuyoSeq.child(i)));
+        }
+    }
+    if (values & KUMIPUYO_POS) {
+        enc->putSignedVarint(pgs.kumipuyoPos.x);
+        enc->putSignedVarint(pgs.kumipuyoPos.y);
+        enc->putSignedVarint(pgs.kumipuyoPos.r);
+    }
+    if (values & EVENT)
+        enc->putByte(encodeEvent(pgs.event));
+    if (values & FLAGS)
+        enc->putByte(encodeFlags(pgs));
+    if (values & SCORE)
+        enc->putSignedVarint(pgs.score);
+    if (values & OJAMA) {
+        enc->putSignedVarint(pgs.pendingOjama);
+        enc->putSignedVarint(pgs.fixedOjama);
+    }
+    if (values & DECISION) {
+        enc->putSignedVarint(pgs.decision.x);
+        enc->putSignedVarint(pgs.decision.r);
+    }
+    if (values & MESSAGE)
+        enc->putString(pgs.message);
+}
+
+bool decodePlayer(bool isKeyframe, Decoder* dec, PlayerGameState* pgs)
+{
+    uint64_t values = dec->getVarint();
+    if (!dec->ok() || values > ALL_VALUES)
+        return false;
+    if (isKeyframe && values != ALL_VALUES)
+        return false;
+
+    if (values & FIELD) {
+        uint64_t numCells = isKeyframe ? NUM_CELLS : dec->getVarint();
+        if (!dec->ok() || numCells > NUM_CELLS)
+            return false;
+        for (int i = 0; i < static_cast<int>(numCells); ++i) {
+            int cell = isKeyframe ? i : dec->getByte();
+            int c = dec->getByte();
+            if (!dec->ok() || cell >= NUM_CELLS || c >= NUM_PUYO_COLORS)
+                return false;
+            pgs->field.setColor(cell / FieldConstant::MAP_HEIGHT, cell % FieldConstant::MAP_HEIGHT,
+                                static_cast<PuyoColor>(c));
+        }
+    }
+    if (values & KUMIPUYO_SEQ) {
+        // Each kumipuyo takes 2 bytes, so a valid size can't exceed the rest of the payload.
+        uint64_t size = dec->getVarint();
+        if (!dec->ok() || size > dec->rest() / 2)
+            return false;
+        vector<Kumipuyo> seq;
+        for (int i = 0; i < static_cast<int>(size); ++i) {
+            int axis = dec->getByte();
+            int child = dec->getByte();
+            if (axis >= NUM_PUYO_COLORS || child >= NUM_PUYO_COLORS)
+                return false;
+            seq.push_back(Kumipuyo(static_cast<PuyoColor>(axis), static_cast<PuyoColor>(child)));
+        }
+        pgs->kumipuyoSeq = KumipuyoSeq(seq);
+    }
+    if (values & KUMIPUYO_POS) {
+        pgs->kumipuyoPos.x = dec->getSignedVarint();
+        pgs->kumipuyoPos.y = dec->getSignedVarint();
+        pgs->kumipuyoPos.r = dec->getSignedVarint();
+    }
+    if (values & EVENT)
+        pgs->event = decodeEvent(dec->getByte());
+    if (values & FLAGS) {
+        int flags = dec->getByte();
+        pgs->dead = flags & (1 << 0);
+        pgs->playable = flags & (1 << 1);
+    }
+    if (values & SCORE)
+        pgs->score = dec->getSignedVarint();
+    if (values & OJAMA) {
+        pgs->pendingOjama = dec->getSignedVarint();
+        pgs->fixedOjama = dec->getSignedVarint();
+    }
+    if (values & DECISION) {
+        int x = dec->getSignedVarint();
+        int r = dec->getSignedVarint();
+        pgs->decision = Decision(x, r);
+    }
+    if (values & MESSAGE)
+        pgs->message = dec->getString();
+
+    return dec->ok();
+}
+
+bool writeAll(FILE* fp, const string& buf)
+{
+    return fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------
+
+GameStateLogWriter::GameStateLogWriter(int keyframeInterval) :
+    keyframeInterval_(keyframeInterval)
+{
+    CHECK_GT(keyframeInterval, 0);
+}
+
+GameStateLogWriter::~GameStateLogWriter()
+{
+    if (isOpen())
+        close();
+}
+
+bool GameStateLogWriter::open(const string& path)
+{
+    CHECK(!isOpen());
+
+    fp_ = fopen(path.c_str(), "wb");
+    if (!fp_) {
+        PLOG(ERROR) << "couldn't open game state log: " << path;
+        return false;
+    }
+
+    buf_.clear();
+    Encoder enc(&buf_);
+    for (int i = 0; i < 4; ++i)
+        enc.putByte((game_state_log::MAGIC >> (i * 8)) & 0xff);
+    for (int i = 0; i < 4; ++i)
+        enc.putByte((game_state_log::VERSION >> (i * 8)) & 0xff);
+
+    last_.reset();
+    numRecordsSinceKeyframe_ = 0;
+    return writeAll(fp_, buf_);
+}
+
+bool GameStateLogWriter::append(const GameState& state)
+{
+    CHECK(isOpen());
+
+    bool isKeyframe = !last_ || numRecordsSinceKeyframe_ >= keyframeInterval_;
+
+    string payload;
+    Encoder payloadEnc(&payload);
+    if (isKeyframe)
+        payloadEnc.putVarint(state.frameId());
+    else
+        payloadEnc.putSignedVarint(state.frameId() - last_->frameId());
+    for (int i = 0; i < 2; ++i) {
+        encodePlayer(state.playerGameState(i),
+                     isKeyframe ? nullptr : &last_->playerGameState(i),
+                     &payloadEnc);
+    }
+
+    buf_.clear();
+    Encoder enc(&buf_);
+    enc.putByte(static_cast<int>(isKeyframe ? RecordType::KEYFRAME : RecordType::DELTA));
+    enc.putString(payload);
+
+    numRecordsSinceKeyframe_ = isKeyframe ? 1 : numRecordsSinceKeyframe_ + 1;
+    if (last_)
+        *last_ = state;
+    else
+        last_.reset(new GameState(state));
+
+    return writeAll(fp_, buf_);
+}
+
+bool GameStateLogWriter::close()
+{
+    CHECK(isOpen());
+
+    bool ok = fclose(fp_) == 0;
+    fp_ = nullptr;
+    last_.reset();
+    return ok;
+}
+
+// ----------------------------------------------------------------------
+
+GameStateLogReader::~GameStateLogReader()
+{
+    close();
+}
+
+bool GameStateLogReader::open(const string& path)
+{
+    close();
+
+    fp_ = fopen(path.c_str(), "rb");
+    if (!fp_) {
+        PLOG(ERROR) << "couldn't open game state log: " << path;
+        return false;
+    }
+
+    // The file size bounds the record sizes, so a broken size isn't allocated.
+    off_t fileSize = -1;
+    if (fseeko(fp_, 0, SEEK_END) == 0)
+        fileSize = ftello(fp_);
+    if (fileSize < 0 || fseeko(fp_, 0, SEEK_SET) != 0) {
+        PLOG(ERROR) << "couldn't get the size of game state log: " << path;
+        close();
+        return false;
+    }
+    size_ = fileSize;
+
+    return readHeader(path);
+}
+
+bool GameStateLogReader::open(const char* data, size_t size)
+{
+    close();
+
+    data_ = data;
+    size_ = size;
+    pos_ = 0;
+    return readHeader("<memory>");
+}
+
+int GameStateLogReader::getByte()
+{
+    if (fp_)
+        return fgetc(fp_);
+    if (pos_ >= size_)
+        return EOF;
+    return static_cast<uint8_t>(data_[pos_++]);
+}
+
+bool GameStateLogReader::getBytes(size_t size, const char** p)
+{
+    if (fp_) {
+        off_t pos = ftello(fp_);
+        if (pos < 0 || static_cast<size_t>(pos) > size_ || size > size_ - pos)
+            return false;
+        buf_.resize(size);
+        if (size > 0 && fread(&buf_[0], 1, size, fp_) != size)
+            return false;
+        *p = buf_.data();
+        return true;
+    }
+
+    if (size > size_ - pos_)
+        return false;
+    *p = data_ + pos_;
+    pos_ += size;
+    return true;
+}
+
+bool GameStateLogReader::readHeader(const string& name)
+{
+    const char* p;
+    if (!getBytes(game_state_log::HEADER_SIZE, &p)) {
+        LOG(ERROR) << "broken game state log: " << name;
+        close();
+        return false;
+    }
+
+    const uint8_t* header = reinterpret_cast<const uint8_t*>(p);
+    uint32_t magic = header[0] | header[1] << 8 | header[2] << 16 | static_cast<uint32_t>(header[3]) << 24;
+    uint32_t version = header[4] | header[5] << 8 | header[6] << 16 | static_cast<uint32_t>(header[7]) << 24;
+    if (magic != game_state_log::MAGIC || version != game_state_log::VERSION) {
+        LOG(ERROR) << "not a game state log or unsupported version: " << name;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void GameStateLogReader::close()
+{
+    if (fp_)
+        fclose(fp_);
+    fp_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+    pos_ = 0;
+    hasError_ = false;
+    lastFrameId_ = -1;
+    state_.reset();
+    payload_ = nullptr;
+    payloadSize_ = 0;
+}
+
+bool GameStateLogReader::readRecord(int* type)
+{
+    CHECK(isOpen());
+
+    *type = getByte();
+    if (*type == EOF)
+        return false;
+
+    // The payload size.
+    uint64_t size = 0;
+    for (int shift = 0; ; shift += 7) {
+        int b = getByte();
+        if (b == EOF || shift >= 64) {
+            hasError_ = true;
+            return false;
+        }
+        size |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            break;
+    }
+
+    if (!getBytes(size, &payload_)) {
+        hasError_ = true;
+        return false;
+    }
+    payloadSize_ = size;
+
+    if (*type != static_cast<int>(RecordType::KEYFRAME) && *type != static_cast<int>(RecordType::DELTA)) {
+        hasError_ = true;
+        return false;
+    }
+    return true;
+}
+
+bool GameStateLogReader::next(GameState* state)
+{
+    int type;
+    if (!readRecord(&type))
+        return false;
+
+    bool isKeyframe = type == static_cast<int>(RecordType::KEYFRAME);
+    if (!isKeyframe && !state_) {
+        hasError_ = true;
+        return false;
+    }
+
+    Decoder dec(payload_, payloadSize_);
+    int frameId = isKeyframe ? dec.getVarint() : state_->frameId() + dec.getSignedVarint();
+    GameState decoded(frameId);
+    for (int i = 0; i < 2; ++i) {
+        PlayerGameState* pgs = decoded.mutablePlayerGameState(i);
+        if (!isKeyframe)
+            *pgs = state_->playerGameState(i);
+        if (!decodePlayer(isKeyframe, &dec, pgs)) {
+            hasError_ = true;
+            return false;
+        }
+    }
+    if (!dec.isEnd()) {
+        hasError_ = true;
+        return false;
+    }
+
+    if (state_)
+        *state_ = decoded;
+    else
+        state_.reset(new GameState(decoded));
+    lastFrameId_ = frameId;
+    *state = decoded;
+    return true;
+}
+
+bool GameStateLogReader::nextFrameId(bool* isKeyframe, int* frameId)
+{
+    int type;
+    if (!readRecord(&type))
+        return false;
+
+    *isKeyframe = type == static_cast<int>(RecordType::KEYFRAME);
+    if (!*isKeyframe && lastFrameId_ < 0) {
+        hasError_ = true;
+        return false;
+    }
+
+    Decoder dec(payload_, payloadSize_);
+    *frameId = *isKeyframe ? dec.getVarint() : lastFrameId_ + dec.getSignedVarint();
+    if (!dec.ok()) {
+        hasError_ = true;
+        return false;
+    }
+
+    lastFrameId_ = *frameId;
+    state_.reset();
+    return true;
+}
+
+bool GameStateLogReader::seek(int64_t offset)
+{
+    CHECK(isOpen());
+
+    hasError_ = false;
+    lastFrameId_ = -1;
+    state_.reset();
+    if (fp_)
+        return fseeko(fp_, offset, SEEK_SET) == 0;
+
+    if (offset < 0 || static_cast<uint64_t>(offset) > size_)
+        return false;
+    pos_ = offset;
+    return true;
+}
+
+int64_t GameStateLogReader::tell() const
+{
+    CHECK(isOpen());
+    if (fp_)
+        return ftello(fp_);
+    return pos_;
+}
+
+// ----------------------------------------------------------------------
+
+bool convertGameStateLogToJson(const string& logPath, const string& jsonPath)
+{
+    GameStateLogReader reader;
+    if (!reader.open(logPath))
+        return false;
+
+    ofstream fs(jsonPath);
+    if (!fs) {
+        PLOG(ERROR) << "couldn't open json path: " << jsonPath;
+        return false;
+    }
+
+    fs << "[";
+    GameState state(0);
+    for (int i = 0; reader.next(&state); ++i) {
+        if (i > 0) {
+            fs << "," << endl;
+        }
+        fs << state.toJson();
+    }
+    fs << "]";
+
+    if (reader.hasError()) {
+        LOG(ERROR) << "broken game state log: " << logPath;
+        return false;
+    }
+    return static_cast<bool>(fs);
+}
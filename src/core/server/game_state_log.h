@@ -0,0 +1,117 @@
+#ifndef CORE_SERVER_GAME_STATE_LOG_H_
+#define CORE_SERVER_GAME_STATE_LOG_H_
+
+#include <stdio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "base/noncopyable.h"
+#include "core/server/game_state.h"
+
+// A game state log is a compact binary log of GameStates.
+//
+// The log is a header followed by records. Each record is
+//   [type (1 byte)] [payload size (varint)] [payload]
+// A KEYFRAME record has the whole GameState, and a DELTA record has only
+// the values changed from the previous record (e.g. the changed cells of
+// the fields). A keyframe is written every |keyframeInterval| records, so
+// a reader can start from any keyframe.
+namespace game_state_log {
+
+const std::uint32_t MAGIC = 0x4c534750; // "PGSL"
+const std::uint32_t VERSION = 1;
+const int HEADER_SIZE = 8;
+
+enum class RecordType : std::uint8_t {
+    KEYFRAME = 1,
+    DELTA = 2,
+};
+
+} // namespace game_state_log
+
+// GameStateLogWriter appends GameStates to a game state log as they arrive.
+// Only the last GameState is kept in memory.
+class GameStateLogWriter : noncopyable {
+public:
+    static const int DEFAULT_KEYFRAME_INTERVAL = 300;
+
+    explicit GameStateLogWriter(int keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+    ~GameStateLogWriter();
+
+    bool open(const std::string& path);
+    bool append(const GameState&);
+    bool close();
+
+    bool isOpen() const { return fp_ != nullptr; }
+
+private:
+    FILE* fp_ = nullptr;
+    const int keyframeInterval_;
+    int numRecordsSinceKeyframe_ = 0;
+    std::unique_ptr<GameState> last_;
+    std::string buf_;
+};
+
+// GameStateLogReader reads GameStates from a game state log in order.
+class GameStateLogReader : noncopyable {
+public:
+    GameStateLogReader() {}
+    ~GameStateLogReader();
+
+    bool open(const std::string& path);
+    // Reads a log in |data|, e.g. a mapped file. The records are decoded in place
+    // without copying, so |data| should outlive the reader.
+    bool open(const char* data, std::size_t size);
+    void close();
+
+    // Reads the next GameState into |state|. Returns false at the end of the log
+    // or when the log is broken. hasError() tells which.
+    bool next(GameState* state);
+    bool hasError() const { return hasError_; }
+
+    // Reads the next record without decoding the players, and sets its frame id.
+    // This is much faster than next(), and is used to index a log. After this,
+    // next() can be used only after seeking to a keyframe.
+    bool nextFrameId(bool* isKeyframe, int* frameId);
+
+    // Moves to the record at |offset|. The record should be a keyframe.
+    bool seek(std::int64_t offset);
+    // Returns the offset of the next record.
+    std::int64_t tell() const;
+
+private:
+    bool isOpen() const { return fp_ || data_; }
+    // Returns the next byte, or EOF at the end of the log.
+    int getByte();
+    // Makes |*p| point to the next |size| bytes. The bytes are copied to |buf_|
+    // only when the log is a file.
+    bool getBytes(std::size_t size, const char** p);
+    bool readHeader(const std::string& name);
+    bool readRecord(int* type);
+
+    // Either |fp_| or |data_| is used. A log in memory is decoded in place.
+    FILE* fp_ = nullptr;
+    const char* data_ = nullptr;
+    // The size of the log, either the file or |data_|.
+    std::size_t size_ = 0;
+    // The position in |data_|.
+    std::size_t pos_ = 0;
+
+    bool hasError_ = false;
+    // The frame id of the last record. -1 after seek().
+    int lastFrameId_ = -1;
+    std::unique_ptr<GameState> state_;
+    std::string buf_;
+    // The payload of the last record.
+    const char* payload_ = nullptr;
+    std::size_t payloadSize_ = 0;
+};
+
+// Converts a game state log to the JSON written by the old GameStateRecorder,
+// i.e. an array of GameState::toJson().
+bool convertGameStateLogToJson(const std::string& logPath, const std::string& jsonPath);
+
+#endif // CORE_SERVER_GAME_STATE_LOG_H_
@@ -0,0 +1,246 @@
+#include "core/server/game_state_log.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/file/file.h"
+#include "base/file/temporary_file.h"
+#include "core/server/game_state_log_test_util.h"
+
+using namespace std;
+using game_state_log_test::initialPlayerGameState;
+using game_state_log_test::writeGameStateLog;
+
+namespace {
+
+// Makes a game where the players drop puyos one by one.
+vector<GameState> makeGameStates(int numFrames)
+{
+    vector<GameState> states;
+    PlayerGameState pgs[2] { initialPlayerGameState(), initialPlayerGameState() };
+    for (int i = 0; i < 2; ++i) {
+        pgs[i].kumipuyoSeq = KumipuyoSeq("RRBBYY");
+        pgs[i].kumipuyoPos = KumipuyoPos::initialPos();
+    }
+
+    for (int frameId = 1; frameId <= numFrames; ++frameId) {
+        for (int i = 0; i < 2; ++i) {
+            pgs[i].event.clear();
+            if ((frameId + i) % 10 == 0) {
+                int n = (frameId + i) / 10;
+                pgs[i].field.setColor(n % 6 + 1, n / 6 % 12 + 1, NORMAL_PUYO_COLORS[n % 4]);
+                pgs[i].kumipuyoSeq.dropFront();
+                pgs[i].kumipuyoSeq.add(Kumipuyo(NORMAL_PUYO_COLORS[n % 4], NORMAL_PUYO_COLORS[(n + i) % 4]));
+                pgs[i].kumipuyoPos = KumipuyoPos::initialPos();
+                pgs[i].event.grounded = true;
+                pgs[i].score += 40 * i;
+                pgs[i].pendingOjama = n % 3 - 1;
+                pgs[i].decision = Decision(n % 6 + 1, n % 4);
+                ostringstream ss;
+                ss << "message " << n;
+                pgs[i].message = ss.str();
+            } else {
+                pgs[i].kumipuyoPos.y = 12 - (frameId + i) % 10;
+            }
+        }
+        pgs[1].dead = frameId == numFrames;
+
+        GameState state(frameId);
+        *state.mutablePlayerGameState(0) = pgs[0];
+        *state.mutablePlayerGameState(1) = pgs[1];
+        states.push_back(state);
+    }
+    return states;
+}
+
+void expectSamePlayerGameState(const PlayerGameState& expected, const PlayerGameState& actual)
+{
+    EXPECT_EQ(expected.field, actual.field);
+    EXPECT_EQ(expected.kumipuyoSeq, actual.kumipuyoSeq);
+    EXPECT_EQ(expected.kumipuyoPos, actual.kumipuyoPos);
+    EXPECT_EQ(expected.event.toString(), actual.event.toString());
+    EXPECT_EQ(expected.dead, actual.dead);
+    EXPECT_EQ(expected.playable, actual.playable);
+    EXPECT_EQ(expected.score, actual.score);
+    EXPECT_EQ(expected.pendingOjama, actual.pendingOjama);
+    EXPECT_EQ(expected.fixedOjama, actual.fixedOjama);
+    EXPECT_EQ(expected.decision, actual.decision);
+    EXPECT_EQ(expected.message, actual.message);
+}
+
+} // namespace
+
+TEST(GameStateLogTest, writeAndRead)
+{
+    const vector<GameState> states = makeGameStates(100);
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    writeGameStateLog(filename, states, 7);
+
+    GameStateLogReader reader;
+    ASSERT_TRUE(reader.open(filename));
+    GameState state(0);
+    for (const GameState& expected : states) {
+        ASSERT_TRUE(reader.next(&state));
+        EXPECT_EQ(expected.frameId(), state.frameId());
+        for (int i = 0; i < 2; ++i)
+            expectSamePlayerGameState(expected.playerGameState(i), state.playerGameState(i));
+    }
+    EXPECT_FALSE(reader.next(&state));
+    EXPECT_FALSE(reader.hasError());
+}
+
+TEST(GameStateLogTest, brokenLog)
+{
+    const vector<GameState> states = makeGameStates(10);
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    writeGameStateLog(filename, states);
+
+    string content;
+    ASSERT_TRUE(file::readFile(filename, &content));
+    content.resize(content.size() - 1);
+    ASSERT_TRUE(file::writeFile(filename, content));
+
+    GameStateLogReader reader;
+    ASSERT_TRUE(reader.open(filename));
+    GameState state(0);
+    for (size_t i = 0; i + 1 < states.size(); ++i)
+        ASSERT_TRUE(reader.next(&state));
+    EXPECT_FALSE(reader.next(&state));
+    EXPECT_TRUE(reader.hasError());
+}
+
+TEST(GameStateLogTest, convertToJson)
+{
+    const vector<GameState> states = makeGameStates(1000);
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    file::TemporaryFile jsonTmp(".json");
+    const string& jsonFilename = jsonTmp.path();
+
+    writeGameStateLog(filename, states);
+
+    ASSERT_TRUE(convertGameStateLogToJson(filename, jsonFilename));
+
+    ostringstream expected;
+    expected << "[";
+    for (size_t i = 0; i < states.size(); ++i) {
+        if (i > 0)
+            expected << "," << endl;
+        expected << states[i].toJson();
+    }
+    expected << "]";
+
+    string json;
+    ASSERT_TRUE(file::readFile(jsonFilename, &json));
+    EXPECT_EQ(expected.str(), json);
+
+    string log;
+    ASSERT_TRUE(file::readFile(filename, &log));
+    EXPECT_LT(log.size() * 10, json.size());
+}
+
+TEST(GameStateLogTest, readFromMemory)
+{
+    const vector<GameState> states = makeGameStates(100);
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    writeGameStateLog(filename, states, 7);
+
+    string content;
+    ASSERT_TRUE(file::readFile(filename, &content));
+
+    GameStateLogReader reader;
+    ASSERT_TRUE(reader.open(content.data(), content.size()));
+    GameState state(0);
+    int64_t keyframeOffset = -1;
+    for (size_t i = 0; i < states.size(); ++i) {
+        if (i == 14)
+            keyframeOffset = reader.tell();
+        ASSERT_TRUE(reader.next(&state));
+        EXPECT_EQ(states[i].frameId(), state.frameId());
+        for (int pi = 0; pi < 2; ++pi)
+            expectSamePlayerGameState(states[i].playerGameState(pi), state.playerGameState(pi));
+    }
+    EXPECT_FALSE(reader.next(&state));
+    EXPECT_FALSE(reader.hasError());
+
+    // The 15th record is a keyframe.
+    ASSERT_TRUE(reader.seek(keyframeOffset));
+    ASSERT_TRUE(reader.next(&state));
+    EXPECT_EQ(states[14].frameId(), state.frameId());
+
+    // A truncated log.
+    ASSERT_TRUE(reader.open(content.data(), content.size() - 1));
+    while (reader.next(&state)) {}
+    EXPECT_TRUE(reader.hasError());
+
+    EXPECT_FALSE(reader.open(content.data(), 4));
+}
+
+TEST(GameStateLogTest, corruptSizes)
+{
+    const vector<GameState> states = makeGameStates(1);
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    writeGameStateLog(filename, states);
+
+    string keyframeLog;
+    ASSERT_TRUE(file::readFile(filename, &keyframeLog));
+
+    // Corrupt delta records. The reader should fail without looping over the sizes.
+    const string corruptPayloads[] = {
+        // frame delta, the field, the number of the changed cells (2^31 - 1).
+        string("\x02\x01\xff\xff\xff\xff\x07", 7),
+        // frame delta, KUMIPUYO_SEQ, the size of the seq (2^31 - 1), one kumipuyo.
+        string("\x02\x02\xff\xff\xff\xff\x07\x04\x05", 9),
+        // frame delta, the field, the number of the changed cells is truncated.
+        string("\x02\x01\xff", 3),
+    };
+    for (const string& payload : corruptPayloads) {
+        string content = keyframeLog;
+        content.push_back(static_cast<char>(game_state_log::RecordType::DELTA));
+        content.push_back(static_cast<char>(payload.size()));
+        content += payload;
+
+        GameStateLogReader reader;
+        ASSERT_TRUE(reader.open(content.data(), content.size()));
+        GameState state(0);
+        ASSERT_TRUE(reader.next(&state));
+        EXPECT_FALSE(reader.next(&state));
+        EXPECT_TRUE(reader.hasError());
+    }
+}
+
+TEST(GameStateLogTest, truncatedLogFile)
+{
+    const vector<GameState> states = makeGameStates(1);
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+
+    writeGameStateLog(filename, states);
+
+    string content;
+    ASSERT_TRUE(file::readFile(filename, &content));
+
+    // A delta record whose size (2^48 - 1) is larger than the rest of the file.
+    content.push_back(static_cast<char>(game_state_log::RecordType::DELTA));
+    content += string("\xff\xff\xff\xff\xff\xff\x3f", 7);
+    content += string("\x02\x01\x00", 3);
+    ASSERT_TRUE(file::writeFile(filename, content));
+
+    GameStateLogReader reader;
+    ASSERT_TRUE(reader.open(filename));
+    GameState state(0);
+    ASSERT_TRUE(reader.next(&state));
+    EXPECT_FALSE(reader.next(&state));
+    EXPECT_TRUE(reader.hasError());
+}
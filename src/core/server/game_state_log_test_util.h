@@ -0,0 +1,41 @@
+#ifndef CORE_SERVER_GAME_STATE_LOG_TEST_UTIL_H_
+#define CORE_SERVER_GAME_STATE_LOG_TEST_UTIL_H_
+
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "core/server/game_state.h"
+#include "core/server/game_state_log.h"
+
+// Helpers to make game state logs in tests.
+namespace game_state_log_test {
+
+// Returns the state of a player at the beginning of a game: alive, playable,
+// and no score nor ojama.
+inline PlayerGameState initialPlayerGameState()
+{
+    PlayerGameState pgs;
+    pgs.dead = false;
+    pgs.playable = true;
+    pgs.score = 0;
+    pgs.pendingOjama = 0;
+    pgs.fixedOjama = 0;
+    return pgs;
+}
+
+// Writes |states| to a game state log at |filename|.
+inline void writeGameStateLog(const std::string& filename, const std::vector<GameState>& states,
+                              int keyframeInterval = GameStateLogWriter::DEFAULT_KEYFRAME_INTERVAL)
+{
+    GameStateLogWriter writer(keyframeInterval);
+    CHECK(writer.open(filename));
+    for (const GameState& state : states)
+        CHECK(writer.append(state));
+    CHECK(writer.close());
+}
+
+} // namespace game_state_log_test
+
+#endif // CORE_SERVER_GAME_STATE_LOG_TEST_UTIL_H_
@@ -1,7 +1,6 @@
 #include "core/server/game_state_recorder.h"
 
 #include <chrono>
-#include <fstream>
 #include <iomanip>
 #include <sstream>
 
@@ -26,7 +25,7 @@ void GameStateRecorder::newGameWillStart()
 
 #if defined(_MSC_VER)
     ostringstream oss;
-    oss << std::put_time(std::localtime(&now), "puyoai.gamestate.%Y%m%d-%H%M%S.json");
+    oss << std::put_time(std::localtime(&now), "puyoai.gamestate.%Y%m%d-%H%M%S.bin");
 
     filename_ = oss.str();
 #else
@@ -36,13 +35,15 @@ void GameStateRecorder::newGameWillStart()
     localtime_r(&now, &ltm);
 
     char buf[1024];
-    strftime(buf, 1024, "puyoai.gamestate.%Y%m%d-%H%M%S.json", &ltm);
+    strftime(buf, 1024, "puyoai.gamestate.%Y%m%d-%H%M%S.bin", &ltm);
 
     filename_ = buf;
 #endif
-    recording_ = true;
+    if (writer_.isOpen())
+        writer_.close();
 
     LOG(INFO) << "will start game state logging to " << filename_;
+    recording_ = writer_.open(file::joinPath(dirPath_, filename_));
 }
 
 void GameStateRecorder::onUpdate(const GameState& gameState)
@@ -50,38 +51,27 @@ void GameStateRecorder::onUpdate(const GameState& gameState)
     if (!recording_)
         return;
 
-    gameStates_.push_back(gameState);
+    if (!writer_.append(gameState)) {
+        LOG(ERROR) << "couldn't write game state to " << filename_;
+        recording_ = false;
+    }
 }
 
 void GameStateRecorder::gameHasDone(GameResult gameResult)
 {
     recording_ = false;
-    vector<GameState> gs(std::move(gameStates_));
-    gameStates_.clear();
+    if (!writer_.isOpen())
+        return;
+    writer_.close();
 
+    const string path = file::joinPath(dirPath_, filename_);
     if (record_only_p1_win_) {
         if (gameResult != GameResult::P1_WIN) {
             LOG(INFO) << "game state won't be emitted since P1 didn't win";
+            file::remove(path);
             return;
         }
     }
 
-    LOG(INFO) << "will emit game state to " << filename_;
-
-    // emits json here.
-    const string path = file::joinPath(dirPath_, filename_);
-    ofstream fs(path);
-    if (!fs) {
-        PLOG(ERROR) << "couldn't open game state record path: " << path;
-        return;
-    }
-
-    fs << "[";
-    for (size_t i = 0; i < gs.size(); ++i) {
-        if (i > 0) {
-            fs << "," << endl;
-        }
-        fs << gs[i].toJson();
-    }
-    fs << "]";
+    LOG(INFO) << "emitted game state to " << path;
 }
@@ -2,13 +2,13 @@
 #define CORE_SERVER_GAME_STATE_RECORDER_H_
 
 #include <string>
-#include <vector>
 
 #include "core/server/game_state.h"
+#include "core/server/game_state_log.h"
 #include "core/server/game_state_observer.h"
 
-// GameStateRecorder records GameState, and emits as json for each game.
-//
+// GameStateRecorder records GameState, and streams it to a game state log for each game.
+// Use game_state_log_to_json to convert the log to json.
 class GameStateRecorder : public GameStateObserver {
 public:
     explicit GameStateRecorder(const std::string& dirPath,
@@ -23,7 +23,7 @@ private:
     bool recording_;
     std::string dirPath_;
     std::string filename_;
-    std::vector<GameState> gameStates_;
+    GameStateLogWriter writer_;
 };
 
 #endif // CORE_SERVER_GAME_STATE_RECORDER_H_
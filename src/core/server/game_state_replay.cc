@@ -0,0 +1,107 @@
+#include "core/server/game_state_replay.h"
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+#include "core/server/game_state_observer.h"
+
+using namespace std;
+
+bool GameStateReplay::open(const string& path)
+{
+    keyframes_.clear();
+    lastFrameId_ = -1;
+    numFrames_ = 0;
+    current_.reset();
+    lookahead_.reset();
+
+    if (!reader_.open(path))
+        return false;
+
+    while (true) {
+        int64_t offset = reader_.tell();
+        bool isKeyframe;
+        int frameId;
+        if (!reader_.nextFrameId(&isKeyframe, &frameId))
+            break;
+        if (isKeyframe)
+            keyframes_.push_back(Keyframe { frameId, offset });
+        lastFrameId_ = frameId;
+        ++numFrames_;
+    }
+
+    if (reader_.hasError()) {
+        LOG(ERROR) << "broken game state log: " << path;
+        return false;
+    }
+
+    return true;
+}
+
+bool GameStateReplay::stateAt(int frameId, GameState* state)
+{
+    if (keyframes_.empty() || frameId < keyframes_.front().frameId)
+        return false;
+
+    auto it = upper_bound(keyframes_.begin(), keyframes_.end(), frameId,
+                          [](int f, const Keyframe& keyframe) { return f < keyframe.frameId; });
+    --it;
+
+    // Seeks unless |frameId| is reachable from the current state without passing a keyframe.
+    if (!current_ || frameId < current_->frameId() || current_->frameId() < it->frameId) {
+        if (!seekToKeyframe(*it))
+            return false;
+    }
+
+    while (readAhead() && lookahead_->frameId() <= frameId)
+        current_ = std::move(lookahead_);
+    if (reader_.hasError())
+        return false;
+
+    *state = *current_;
+    return true;
+}
+
+bool GameStateReplay::play(int fromFrameId, int toFrameId, GameStateObserver* observer)
+{
+    GameState state(fromFrameId);
+    if (!stateAt(fromFrameId, &state))
+        return false;
+
+    observer->onUpdate(state);
+    while (readAhead() && lookahead_->frameId() <= toFrameId) {
+        current_ = std::move(lookahead_);
+        observer->onUpdate(*current_);
+    }
+
+    return !reader_.hasError();
+}
+
+bool GameStateReplay::seekToKeyframe(const Keyframe& keyframe)
+{
+    current_.reset();
+    lookahead_.reset();
+    if (!reader_.seek(keyframe.offset))
+        return false;
+
+    GameState state(keyframe.frameId);
+    if (!reader_.next(&state))
+        return false;
+
+    current_.reset(new GameState(state));
+    return true;
+}
+
+bool GameStateReplay::readAhead()
+{
+    if (lookahead_)
+        return true;
+
+    GameState state(0);
+    if (!reader_.next(&state))
+        return false;
+
+    lookahead_.reset(new GameState(state));
+    return true;
+}
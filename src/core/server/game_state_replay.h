@@ -0,0 +1,58 @@
+#ifndef CORE_SERVER_GAME_STATE_REPLAY_H_
+#define CORE_SERVER_GAME_STATE_REPLAY_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/noncopyable.h"
+#include "core/server/game_state.h"
+#include "core/server/game_state_log.h"
+
+class GameStateObserver;
+
+// GameStateReplay gives random access to the frames of a game state log.
+// The offsets of the keyframes are indexed when the log is opened, so the GameState
+// at any frame is reconstructed by decoding at most one keyframe interval of records.
+// Moving forward from the last frame doesn't seek, so playing a replay is sequential.
+class GameStateReplay : noncopyable {
+public:
+    GameStateReplay() {}
+
+    bool open(const std::string& path);
+
+    int firstFrameId() const { return keyframes_.empty() ? -1 : keyframes_.front().frameId; }
+    int lastFrameId() const { return lastFrameId_; }
+    int numFrames() const { return numFrames_; }
+    int numKeyframes() const { return keyframes_.size(); }
+
+    // Sets the GameState at |frameId|, i.e. the last recorded state whose frame id is
+    // less than or equal to |frameId|. Returns false if there is no such state.
+    bool stateAt(int frameId, GameState* state);
+
+    // Gives the state at |fromFrameId| and the following states up to |toFrameId|
+    // to |observer|, e.g. drawers of the GUI.
+    bool play(int fromFrameId, int toFrameId, GameStateObserver* observer);
+
+private:
+    struct Keyframe {
+        int frameId;
+        std::int64_t offset;
+    };
+
+    bool seekToKeyframe(const Keyframe&);
+    // Reads the next state into |lookahead_| unless it's already read.
+    bool readAhead();
+
+    GameStateLogReader reader_;
+    std::vector<Keyframe> keyframes_;
+    int lastFrameId_ = -1;
+    int numFrames_ = 0;
+
+    // The last state given by stateAt(), and the state after that.
+    std::unique_ptr<GameState> current_;
+    std::unique_ptr<GameState> lookahead_;
+};
+
+#endif // CORE_SERVER_GAME_STATE_REPLAY_H_
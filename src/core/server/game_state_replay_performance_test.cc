@@ -0,0 +1,96 @@
+#include "core/server/game_state_replay.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/file/temporary_file.h"
+#include "base/time_stamp_counter.h"
+#include "core/server/game_state_log_test_util.h"
+
+using namespace std;
+using game_state_log_test::initialPlayerGameState;
+using game_state_log_test::writeGameStateLog;
+
+namespace {
+
+const int NUM_GAMES = 20;
+const int NUM_FRAMES = 5000;
+
+// Writes a game where a puyo is dropped every 20 frames.
+void writeGame(const string& filename, int seed)
+{
+    mt19937 mt(seed);
+
+    vector<GameState> states;
+    PlayerGameState pgs[2] { initialPlayerGameState(), initialPlayerGameState() };
+    int heights[2][8] {};
+    for (int frameId = 1; frameId <= NUM_FRAMES; ++frameId) {
+        for (int pi = 0; pi < 2; ++pi) {
+            if (frameId % 20 == 0) {
+                int x = mt() % 6 + 1;
+                if (heights[pi][x] == 12) {
+                    pgs[pi].field = PlainField();
+                    fill(heights[pi], heights[pi] + 8, 0);
+                }
+                pgs[pi].field.setColor(x, ++heights[pi][x], NORMAL_PUYO_COLORS[mt() % 4]);
+                pgs[pi].score += 40;
+            }
+            pgs[pi].kumipuyoPos.y = 12 - frameId % 20 / 2;
+        }
+
+        GameState state(frameId);
+        *state.mutablePlayerGameState(0) = pgs[0];
+        *state.mutablePlayerGameState(1) = pgs[1];
+        states.push_back(state);
+    }
+    writeGameStateLog(filename, states);
+}
+
+} // namespace
+
+TEST(GameStateReplayPerformanceTest, randomSeek)
+{
+    vector<file::TemporaryFile> files;
+    vector<unique_ptr<GameStateReplay>> replays;
+    for (int i = 0; i < NUM_GAMES; ++i) {
+        files.emplace_back();
+        writeGame(files.back().path(), i);
+        replays.emplace_back(new GameStateReplay);
+        ASSERT_TRUE(replays.back()->open(files.back().path()));
+    }
+
+    mt19937 mt(1);
+    TimeStampCounterData tsc;
+    GameState state(0);
+    for (int i = 0; i < 10000; ++i) {
+        GameStateReplay* replay = replays[mt() % NUM_GAMES].get();
+        int frameId = mt() % NUM_FRAMES + 1;
+        ScopedTimeStampCounter stsc(&tsc);
+        ASSERT_TRUE(replay->stateAt(frameId, &state));
+        ASSERT_EQ(frameId, state.frameId());
+    }
+    tsc.showStatistics();
+}
+
+TEST(GameStateReplayPerformanceTest, sequential)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    writeGame(filename, 0);
+
+    GameStateReplay replay;
+    ASSERT_TRUE(replay.open(filename));
+
+    TimeStampCounterData tsc;
+    GameState state(0);
+    for (int frameId = 1; frameId <= NUM_FRAMES; ++frameId) {
+        ScopedTimeStampCounter stsc(&tsc);
+        ASSERT_TRUE(replay.stateAt(frameId, &state));
+    }
+    tsc.showStatistics();
+}
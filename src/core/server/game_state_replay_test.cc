@@ -0,0 +1,120 @@
+#include "core/server/game_state_replay.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/file/temporary_file.h"
+#include "core/server/game_state_log.h"
+#include "core/server/game_state_log_test_util.h"
+#include "core/server/game_state_observer.h"
+
+using namespace std;
+using game_state_log_test::initialPlayerGameState;
+using game_state_log_test::writeGameStateLog;
+
+namespace {
+
+// Writes a game whose frame ids are 2, 4, ..., 2 * |numFrames|.
+// The score of the players is the frame id, so a state tells its frame.
+void writeGame(const string& filename, int numFrames, int keyframeInterval)
+{
+    vector<GameState> states;
+    PlayerGameState pgs[2] { initialPlayerGameState(), initialPlayerGameState() };
+    for (int i = 1; i <= numFrames; ++i) {
+        for (int pi = 0; pi < 2; ++pi) {
+            pgs[pi].field.setColor((i + pi) % 6 + 1, (i / 6) % 12 + 1, NORMAL_PUYO_COLORS[(i + pi) % 4]);
+            pgs[pi].score = i * 2;
+        }
+
+        GameState state(i * 2);
+        *state.mutablePlayerGameState(0) = pgs[0];
+        *state.mutablePlayerGameState(1) = pgs[1];
+        states.push_back(state);
+    }
+    writeGameStateLog(filename, states, keyframeInterval);
+}
+
+vector<GameState> readAll(const string& filename)
+{
+    GameStateLogReader reader;
+    CHECK(reader.open(filename));
+
+    vector<GameState> states;
+    GameState state(0);
+    while (reader.next(&state))
+        states.push_back(state);
+    CHECK(!reader.hasError());
+    return states;
+}
+
+class CollectingObserver : public GameStateObserver {
+public:
+    void onUpdate(const GameState& state) override { frameIds.push_back(state.frameId()); }
+
+    vector<int> frameIds;
+};
+
+} // namespace
+
+TEST(GameStateReplayTest, index)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    writeGame(filename, 100, 30);
+
+    GameStateReplay replay;
+    ASSERT_TRUE(replay.open(filename));
+    EXPECT_EQ(2, replay.firstFrameId());
+    EXPECT_EQ(200, replay.lastFrameId());
+    EXPECT_EQ(100, replay.numFrames());
+    EXPECT_EQ(4, replay.numKeyframes());
+}
+
+TEST(GameStateReplayTest, stateAt)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    writeGame(filename, 100, 30);
+    const vector<GameState> states = readAll(filename);
+
+    GameStateReplay replay;
+    ASSERT_TRUE(replay.open(filename));
+
+    GameState state(0);
+    EXPECT_FALSE(replay.stateAt(1, &state));
+
+    // Forward, backward, and jumping across keyframes in both directions.
+    const int frameIds[] = { 2, 3, 10, 60, 61, 62, 199, 200, 250, 120, 59, 58, 2, 150, 30 };
+    for (int frameId : frameIds) {
+        SCOPED_TRACE(frameId);
+        const GameState& expected = states[min(frameId, 200) / 2 - 1];
+        ASSERT_TRUE(replay.stateAt(frameId, &state));
+        EXPECT_EQ(expected.frameId(), state.frameId());
+        for (int pi = 0; pi < 2; ++pi) {
+            EXPECT_EQ(expected.playerGameState(pi).field, state.playerGameState(pi).field);
+            EXPECT_EQ(expected.playerGameState(pi).score, state.playerGameState(pi).score);
+        }
+    }
+}
+
+TEST(GameStateReplayTest, play)
+{
+    file::TemporaryFile tmp;
+    const string& filename = tmp.path();
+    writeGame(filename, 100, 30);
+
+    GameStateReplay replay;
+    ASSERT_TRUE(replay.open(filename));
+
+    GameState state(0);
+    ASSERT_TRUE(replay.stateAt(150, &state));
+
+    CollectingObserver observer;
+    ASSERT_TRUE(replay.play(51, 60, &observer));
+    EXPECT_EQ((vector<int> { 50, 52, 54, 56, 58, 60 }), observer.frameIds);
+
+    ASSERT_TRUE(replay.stateAt(61, &state));
+    EXPECT_EQ(60, state.frameId());
+}
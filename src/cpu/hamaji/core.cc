@@ -16,6 +16,8 @@ DEFINE_int32(immediate_fire_score, 40000, "");
 DEFINE_bool(use_next_next, true, "");
 DEFINE_bool(eval2, false, "");
 
+static const size_t kEvalBatchSize = 64;
+
 Core::Core(bool is_solo)
   : is_solo_(is_solo),
     best_chain_(0),
@@ -29,15 +31,29 @@ Core::~Core() {
   delete eval2_;
 }
 
-int numTurns(const LP& r) {
-  const LP* p = r.parent;
-  int n = 0;
-  while (p) {
-    p = p->parent;
-    n++;
+namespace {
+
+// The plans given by LF::IterateAvailablePlans are reused, so the values of
+// a candidate plan are copied.
+struct CandidatePlan {
+  CandidatePlan() : found(false), score(0), chain_cnt(0) {}
+
+  void set(const LP& plan) {
+    found = true;
+    first_decision = plan.getFirstDecision();
+    score = plan.score;
+    chain_cnt = plan.chain_cnt;
+    field = plan.field;
   }
-  return n;
-}
+
+  bool found;
+  Decision first_decision;
+  int score;
+  int chain_cnt;
+  LF field;
+};
+
+}  // namespace
 
 Decision Core::decide(Game* game) {
   LOG(INFO) << game->getDebugOutput();
@@ -46,24 +62,138 @@ Decision Core::decide(Game* game) {
     msg_.clear();
   }
 
-  vector<LP> plans;
-  game->p[0].f.FindAvailablePlans(game->p[0].next, &plans);
+  int obest_score = 0;
+  if (game->p[1].event.grounded) {
+    game->p[1].f.IterateAvailablePlans(
+        game->p[1].next.subsequence(2), 2, [&](LP* p) {
+          if (obest_score < p->score)
+            obest_score = p->score;
+        });
+    obest_score += game->p[1].expected_ojama * 70;
+  }
 
-  if (game->p[1].expected_ojama > 3) {
-    int best_score = 400;
-    const LP* best_plan = NULL;
-    // TODO(hamaji): Adjust timing.
-    for (size_t i = 0; i < plans.size(); i++) {
-      int t = numTurns(plans[i]);
-      if (t != 0 && (t - 1) * 70 + 20 > game->p[1].expected_frame)
-        continue;
-      if (best_score < plans[i].score) {
-        best_score = plans[i].score;
-        best_plan = &plans[i];
+  int ojama = game->p[1].expected_ojama;
+  int ojama_height = 0;
+  if (ojama > 3) {
+    ojama_height = (ojama + 5) / 6;
+    if (ojama_height >= 12 || game->p[0].f.Get(3, 12-ojama_height) != PuyoColor::EMPTY)
+      ojama_height = 0;
+  }
+
+  eval_->setIsEmergency(game->p[1].expected_ojama > 15);
+  double best_value = -1e9;
+  CandidatePlan best_plan;
+  string best_eval_string;
+  // The plans are evaluated by Eval in batches. The i-th plan in |batch| is
+  // the i-th row of the batch of |eval_|.
+  vector<CandidatePlan> batch;
+  batch.reserve(kEvalBatchSize);
+  auto flushBatch = [&]() {
+    if (batch.empty())
+      return;
+    const vector<double>& values = eval_->evalBatch();
+    for (size_t i = 0; i < batch.size(); i++) {
+      if (best_value < values[i]) {
+        best_value = values[i];
+        best_plan = batch[i];
+        best_eval_string = eval_->getBatchEvalString(i);
       }
     }
-    int my_ojama = best_plan ? best_score / 70 : 0;
-    if (best_plan) {
+    eval_->clearBatch();
+    batch.clear();
+  };
+  // Evaluates |p| with ojama puyos. This should be the last use of |p|,
+  // since |p| is modified.
+  auto evaluate = [&](LP* p) {
+    if (!FLAGS_use_next_next && p->parent && p->parent->parent)
+      return;
+    if (ojama_height) {
+      for (int x = 1; x <= 6; x++) {
+        for (int y = 1; y <= 13; y++) {
+          if (p->field.Get(x, y) == PuyoColor::EMPTY) {
+            for (int j = 0; j < ojama_height && y + j <= 13; j++) {
+              p->field.Set(x, y + j, PuyoColor::OJAMA);
+            }
+            break;
+          }
+        }
+      }
+    }
+    if (FLAGS_eval2) {
+      double value = eval2_->eval(p);
+      if (best_value < value) {
+        best_value = value;
+        best_plan.set(*p);
+        best_eval_string = getEvalString(*p);
+      }
+      return;
+    }
+    eval_->addToBatch(*p);
+    batch.push_back(CandidatePlan());
+    batch.back().set(*p);
+    if (batch.size() == kEvalBatchSize)
+      flushBatch();
+  };
+
+  // All the plans are visited only once. The candidates of each strategy
+  // are collected, and the strategies are tried in order after that.
+  int counter_score = 400;
+  CandidatePlan counter_plan;
+  int immediate_score = 0;
+  CandidatePlan immediate_plan;
+  int tsubushi_score = 0;
+  CandidatePlan tsubushi_plan;
+  game->p[0].f.IterateAvailablePlans(game->p[0].next, 3, [&](LP* p) {
+    if (game->p[1].expected_ojama > 3) {
+      // TODO(hamaji): Adjust timing.
+      int t = p->depth();
+      if (!(t != 0 && (t - 1) * 70 + 20 > game->p[1].expected_frame) &&
+          counter_score < p->score) {
+        counter_score = p->score;
+        counter_plan.set(*p);
+      }
+    }
+
+    if (!is_solo_) {
+      int score = p->score;
+      if (p->chain_cnt < 4 && !p->field.hasPuyo())
+        score += 2100;
+      if (immediate_score < score) {
+        immediate_score = score;
+        immediate_plan.set(*p);
+      }
+    } else {
+      for (const LP* q = p; q; q = q->parent) {
+        int score = q->score - (q->parent ? q->parent->score : 0);
+        if (best_score_ < score)
+          best_score_ = score;
+        int chain_cnt = q->chain_cnt - (q->parent ? q->parent->chain_cnt : 0);
+        if (best_chain_ < chain_cnt) {
+          best_chain_ = chain_cnt;
+          if (is_solo_) {
+            printf("Got the best chain: %d score=%d\n",
+                   best_chain_, best_score_);
+          } else {
+            LOG(INFO) << "Got the best chain: " << best_chain_
+                      << " score=" << best_score_;
+          }
+        }
+      }
+    }
+
+    if (game->p[1].event.grounded && !p->parent &&
+        p->chain_cnt <= 2 && p->score - obest_score > 1200) {
+      tsubushi_score = p->score;
+      tsubushi_plan.set(*p);
+    }
+
+    evaluate(p);
+  });
+  flushBatch();
+
+  if (game->p[1].expected_ojama > 3) {
+    int my_ojama = counter_plan.found ? counter_score / 70 : 0;
+    if (counter_plan.found) {
       if ((game->p[1].expected_frame < 100 &&
            my_ojama + 50 > game->p[1].expected_ojama) ||
           (game->p[1].expected_frame < 500 &&
@@ -72,12 +202,12 @@ Decision Core::decide(Game* game) {
         msg_ = ssprintf("COUNTER_%d_vs_%d_in_%d",
                         my_ojama, game->p[1].expected_ojama,
                         game->p[1].expected_frame);
-        LOG(INFO) << "Found a neat counter! score=" << best_score
+        LOG(INFO) << "Found a neat counter! score=" << counter_score
                   << " ojama=" << game->p[1].expected_ojama
                   << " frames=" << game->p[1].expected_frame
                   << " my_ojama=" << my_ojama
-                  << '\n' << best_plan->field.GetDebugOutput();
-        return best_plan->getFirstDecision();
+                  << '\n' << counter_plan.field.GetDebugOutput();
+        return counter_plan.first_decision;
       }
     }
     LOG(INFO) << "No counter..."
@@ -87,181 +217,88 @@ Decision Core::decide(Game* game) {
   }
 
   if (!is_solo_) {
-    int best_score = 0;
-    const LP* best_plan = NULL;
-    for (size_t i = 0; i < plans.size(); i++) {
-      int score = plans[i].score;
-      if (plans[i].chain_cnt < 4 && !plans[i].field.hasPuyo())
-        score += 2100;
-      if (best_score < score) {
-        best_score = score;
-        best_plan = &plans[i];
-      }
-    }
-    if (best_plan &&
-        best_score / 70 - 30 > game->p[1].expected_ojama &&
+    if (immediate_plan.found &&
+        immediate_score / 70 - 30 > game->p[1].expected_ojama &&
         (game->p[0].f.Get(3, 11) != PuyoColor::EMPTY ||
          (game->p[0].f.Get(2, 12) != PuyoColor::EMPTY && game->p[0].f.Get(4, 11) != PuyoColor::EMPTY) ||
          (game->p[0].f.Get(2, 11) != PuyoColor::EMPTY && game->p[0].f.Get(4, 12) != PuyoColor::EMPTY) ||
-         best_score > FLAGS_immediate_fire_score)) {
-      msg_ = ssprintf("IMMEDIATE_%d", best_score);
-      LOG(INFO) << "Immediate fire! score=" << best_score
-                << '\n' << best_plan->field.GetDebugOutput();
-      return best_plan->getFirstDecision();
+         immediate_score > FLAGS_immediate_fire_score)) {
+      msg_ = ssprintf("IMMEDIATE_%d", immediate_score);
+      LOG(INFO) << "Immediate fire! score=" << immediate_score
+                << '\n' << immediate_plan.field.GetDebugOutput();
+      return immediate_plan.first_decision;
     }
 
-    if (best_plan && best_score > 1000) {
+    if (immediate_plan.found && immediate_score > 1000) {
       int puyo_cnt = game->p[1].f.countColorPuyo();
       int max_chain_cnt =
-          min((puyo_cnt + best_plan->chain_cnt * 2 + 3) / 4, 19);
+          min((puyo_cnt + immediate_plan.chain_cnt * 2 + 3) / 4, 19);
       int max_score = 0;
       for (int i = 2; i <= max_chain_cnt; i++) {
         max_score += chainBonus(i);
       }
       max_score *= 40;
       max_score += game->p[1].score - game->p[1].spent_score;
-      LOG(INFO) << "Kill move? best_score=" << best_score
-                << " chain_cnt=" << best_plan->chain_cnt
+      LOG(INFO) << "Kill move? best_score=" << immediate_score
+                << " chain_cnt=" << immediate_plan.chain_cnt
                 << " opp_max_score=" << max_score
                 << " opp_chain_cnt=" << max_chain_cnt
                 << " opp_puyo_cnt=" << puyo_cnt;
-      if (best_score > max_score + game->p[1].expected_ojama * 70) {
-        msg_ = ssprintf("KILL_%d", best_score);
-        LOG(INFO) << "Kill move! score=" << best_score
+      if (immediate_score > max_score + game->p[1].expected_ojama * 70) {
+        msg_ = ssprintf("KILL_%d", immediate_score);
+        LOG(INFO) << "Kill move! score=" << immediate_score
                   << " vs " << max_score
-                  << '\n' << best_plan->field.GetDebugOutput();
-        return best_plan->getFirstDecision();
+                  << '\n' << immediate_plan.field.GetDebugOutput();
+        return immediate_plan.first_decision;
       }
     }
 
     // TODO(hamaji): Maybe better not to take zenkeshi when the
     //               opponent has a lot of puyos or firing big chain.
 #if 0
-    if (best_plan)
-      LOG(INFO) << "ZENKESHI??? best_score=" << best_score
-                << " chain_cnt=" << best_plan->chain_cnt;
+    if (immediate_plan.found)
+      LOG(INFO) << "ZENKESHI??? best_score=" << immediate_score
+                << " chain_cnt=" << immediate_plan.chain_cnt;
 #endif
-    if (best_plan && best_plan->chain_cnt < 4 &&
-        !best_plan->field.hasPuyo()) {
-      LOG(INFO) << "ZENKESHI! best_score=" << best_score
-                << " chain_cnt=" << best_plan->chain_cnt;
-      return best_plan->getFirstDecision();
-    }
-  } else {
-    for (size_t i = 0; i < plans.size(); i++) {
-      for (const LP* p = &plans[i]; p; p = p->parent) {
-        int score = p->score - (p->parent ? p->parent->score : 0);
-        if (best_score_ < score)
-          best_score_ = score;
-        int chain_cnt = p->chain_cnt - (p->parent ? p->parent->chain_cnt : 0);
-        if (best_chain_ < chain_cnt) {
-          best_chain_ = chain_cnt;
-          if (is_solo_) {
-            printf("Got the best chain: %d score=%d\n",
-                   best_chain_, best_score_);
-          } else {
-            LOG(INFO) << "Got the best chain: " << best_chain_
-                      << " score=" << best_score_;
-          }
-        }
-      }
+    if (immediate_plan.found && immediate_plan.chain_cnt < 4 &&
+        !immediate_plan.field.hasPuyo()) {
+      LOG(INFO) << "ZENKESHI! best_score=" << immediate_score
+                << " chain_cnt=" << immediate_plan.chain_cnt;
+      return immediate_plan.first_decision;
     }
   }
 
-  if (game->p[1].event.grounded) {
-    vector<LP> oplans;
-    game->p[1].f.FindAvailablePlans(game->p[1].next.subsequence(2), 2, &oplans);
-    int obest_score = 0;
-    for (size_t i = 0; i < oplans.size(); i++) {
-      if (obest_score < oplans[i].score)
-        obest_score = oplans[i].score;
-    }
-    obest_score += game->p[1].expected_ojama * 70;
-
-    const LP* best_plan = NULL;
-    int best_score = 0;
-    for (size_t i = 0; i < plans.size(); i++) {
-      const LP* p = &plans[i];
-      if (p->parent) {
-        continue;
-      }
-
-      if (p->chain_cnt <= 2 && p->score - obest_score > 1200) {
-        best_score = p->score;
-        best_plan = p;
-      }
-    }
-
-    if (best_plan) {
-      msg_ = ssprintf("TSUBUSHI_%d", best_score);
-      LOG(INFO) << "Tsubushi! score=" << best_score
-                << '\n' << best_plan->field.GetDebugOutput();
-      return best_plan->getFirstDecision();
-    }
+  if (tsubushi_plan.found) {
+    msg_ = ssprintf("TSUBUSHI_%d", tsubushi_score);
+    LOG(INFO) << "Tsubushi! score=" << tsubushi_score
+              << '\n' << tsubushi_plan.field.GetDebugOutput();
+    return tsubushi_plan.first_decision;
   }
 
-  int ojama = game->p[1].expected_ojama;
-  int ojama_height = 0;
-  if (ojama > 3) {
-    ojama_height = (ojama + 5) / 6;
-    if (ojama_height >= 12 || game->p[0].f.Get(3, 12-ojama_height) != PuyoColor::EMPTY)
-      ojama_height = 0;
+  if (!best_plan.found && ojama_height) {
+    LOG(INFO) << "I may die due to ojama, but retrying...";
+    ojama_height = 0;
+    game->p[0].f.IterateAvailablePlans(game->p[0].next, 3, evaluate);
+    flushBatch();
   }
 
- retry:
-  double best_value = -1e9;
-  const LP* best_plan = NULL;
-  for (size_t i = 0; i < plans.size(); i++) {
-    LP* p = &plans[i];
-    if (!FLAGS_use_next_next && p->parent && p->parent->parent)
-      continue;
-    if (ojama_height) {
-      for (int x = 1; x <= 6; x++) {
-        for (int y = 1; y <= 13; y++) {
-          if (p->field.Get(x, y) == PuyoColor::EMPTY) {
-            for (int j = 0; j < ojama_height && y + j <= 13; j++) {
-              p->field.Set(x, y + j, PuyoColor::OJAMA);
-            }
-            break;
-          }
-        }
-      }
-    }
-    double value;
-    if (FLAGS_eval2) {
-      value = eval2_->eval(p);
-    } else {
-      eval_->setIsEmergency(game->p[1].expected_ojama > 15);
-      value = eval_->eval(p);
-    }
-    if (best_value < value) {
-      best_value = value;
-      best_plan = &plans[i];
-    }
-  }
-
-  if (!best_plan) {
-    if (ojama_height) {
-      LOG(INFO) << "I may die due to ojama, but retrying...";
-      ojama_height = 0;
-      goto retry;
-    }
+  if (!best_plan.found) {
     LOG(WARNING) << "I have no choice";
     return Decision();
   }
 
   if (is_solo_) {
-    msg_ = getEvalString(*best_plan);
+    msg_ = best_eval_string;
   }
 
   LOG(INFO) << "best_value=" << best_value
-            << " score=" << (best_plan ? best_plan->score : -1)
+            << " score=" << best_plan.score
             << " ojama=" << ojama
             << " ojama_height=" << ojama_height
-            << ' ' << getEvalString(*best_plan)
-            << '\n' << best_plan->field.GetDebugOutput();
+            << ' ' << best_eval_string
+            << '\n' << best_plan.field.GetDebugOutput();
 
-  return best_plan->getFirstDecision();
+  return best_plan.first_decision;
 }
 
 string Core::getEvalString(const LP& plan) const {
@@ -214,6 +214,33 @@ string normalizeSeq(const string& seq, bool* swapped) {
   return out;
 }
 
+void normalizeMatch(const Match& match, Match* normalized) {
+  CHECK_EQ(match.seq.size(), match.decisions.size() * 3);
+  bool* swapped = new bool[match.seq.size() / 3];
+  normalized->seq = normalizeSeq(match.seq, swapped);
+  normalized->decisions.clear();
+  for (size_t i = 0; i < match.decisions.size(); i++) {
+    Decision decision = match.decisions[i];
+    CHECK(decision.isValid());
+    if (swapped[i]) {
+      switch (decision.r) {
+      case 0:
+      case 2:
+        decision.r = 2 - decision.r;
+        break;
+      case 1:
+      case 3:
+        decision.x += 2 - decision.r;
+        decision.r = 4 - decision.r;
+        break;
+      }
+    }
+    normalized->decisions.push_back(decision);
+  }
+  delete[] swapped;
+  normalized->eof_reason = match.eof_reason;
+}
+
 static void parseField(char* p, LF* field) {
 #if OLD_PARSE_MOVIE
   for (int y = 12; y >= 1; y--) {
@@ -362,3 +389,10 @@ void parseMatches(const char* filename,
     match.decisions.push_back(decision);
   }
 }
+
+void parseMatchesForStats(const char* filename,
+                          int num_turns,
+                          vector<Match>* matches) {
+  parseMatches(filename, num_turns + 2,
+               Match::OJAMA_PUYO_MASK | Match::VANISH_PUYO_MASK, matches);
+}
@@ -31,9 +31,24 @@ struct Match {
 string normalizeSeq(const string& seq, bool* swapped = 0);
 string normalizeSeqUni(const string& seq);
 
+// Normalizes the sequence of |match| with normalizeSeq, and adjusts the
+// decisions of the kumipuyos whose axis and child are swapped.
+void normalizeMatch(const Match& match, Match* normalized);
+
 void parseMatches(const char* filename,
                   int num_turns,
                   int noeof_reason_mask,
                   vector<Match>* matches);
 
+// The number of turns matchstat looks into by default.
+const int kDefaultStatNumTurns = 40;
+
+// Parses the matches as matchstat reads them. The NEXT and NEXT2 of the last
+// of |num_turns| turns are kept, and ojama and vanished puyos don't end a
+// match. mkdb --store parses the logs with this, so a match store has the
+// same matches as the logs.
+void parseMatchesForStats(const char* filename,
+                          int num_turns,
+                          vector<Match>* matches);
+
 #endif  // HAMAJI_DB_H_
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <atomic>
 #include <sstream>
 
 #include <gflags/gflags.h>
@@ -38,7 +39,7 @@ const char* PARAM_NAMES[] = {
   "TA_SCORE"
 };
 
-static int g_eval_cnt = 0;
+static std::atomic<int> g_eval_cnt(0);
 
 static bool g_use_ta;
 static int g_ta[13*6][13*6];
@@ -50,18 +51,16 @@ struct Eval::Param {
   string name;
 };
 
-std::mutex Eval::g_mu;
+std::once_flag Eval::g_init_once;
 vector<Eval::Param> Eval::g_params;
 vector<int> Eval::g_param_index_offsets;
 
 void Eval::init() {
-  std::lock_guard<std::mutex> lock(g_mu);
-
-  static bool inited = false;
-  if (inited)
-    return;
-  inited = true;
+  // Eval is constructed in the rater's worker threads, which share the tables.
+  std::call_once(g_init_once, &Eval::initOnce);
+}
 
+void Eval::initOnce() {
   int offset = 0;
 #define DEFINE_PARAM(name, num)                        \
   g_param_index_offsets.push_back(offset);             \
@@ -121,15 +120,15 @@ void Eval::init() {
 
 Eval::Eval() {
   init();
-  params_ = g_params;
-  param_index_offsets_ = g_param_index_offsets;
+  params_ = &g_params;
+  batch_size_ = 0;
 }
 
 Eval::~Eval() {
 }
 
 int Eval::getParamIndex(int id, int i) {
-  return param_index_offsets_[id] + i;
+  return g_param_index_offsets[id] + i;
 }
 
 double Eval::getConnectionScore(const LF& field,
@@ -224,8 +223,8 @@ void Eval::getVertical3(const LF& field, vector<double>* param_scores) {
 void Eval::fillEvalParamVector(const LF& field,
                                vector<double>* param_scores,
                                int* chain_cnt) {
-  g_eval_cnt++;
-  param_scores->resize(params_.size());
+  g_eval_cnt.fetch_add(1, std::memory_order_relaxed);
+  param_scores->resize(params_->size());
 
   int ipc = 0, ucc = 0, vpc = 0;
   int cc = 0;
@@ -276,73 +275,81 @@ double Eval::evalFromParamVector(const vector<double>& param_scores) {
   int o = 0;
 #endif
   double score = 0;
-  for (int i = 0; i < param_index_offsets_.back(); i++) {
-    score += param_scores[i] * params_[o + i].value;
+  for (int i = 0; i < g_param_index_offsets.back(); i++) {
+    score += param_scores[i] * (*params_)[o + i].value;
   }
   return score;
 }
 
 double Eval::eval(LP* plan) {
-  vector<double> param_scores(params_.size());
+  vector<double> param_scores(params_->size());
   int chain_cnt = 0;
   fillEvalParamVector(plan->field, &param_scores, &chain_cnt);
-  plan->evals.resize(param_index_offsets_.size(), 0);
+  plan->evals.resize(g_param_index_offsets.size(), 0);
 
   size_t j = 0;
   int o = 0;
   plan->chain_cnt = chain_cnt;
-  for (int i = 0; i < param_index_offsets_.back(); i++) {
-    if (i == param_index_offsets_[j+1]) {
+  for (int i = 0; i < g_param_index_offsets.back(); i++) {
+    if (i == g_param_index_offsets[j+1]) {
       j++;
     }
-    plan->evals[j] += param_scores[i] * params_[o + i].value;
+    plan->evals[j] += param_scores[i] * (*params_)[o + i].value;
   }
   double r = evalFromParamVector(param_scores);
 
-  int puyo_cnt = plan->field.countPuyo();
+  double ta_score = 0;
+  addAdjustments(*plan, &ta_score, [&r](double a) { r += a; });
+  if (g_use_ta)
+    plan->evals[TA_SCORE] = ta_score;
+  return r;
+}
+
+template<typename Add>
+void Eval::addAdjustments(const LP& plan, double* ta_score, Add add) {
+  int puyo_cnt = plan.field.countPuyo();
 
 #if 0
-  int color_puyo_cnt = plan->field.countColorPuyo();
-  r += (colorPuyoCnt - puyoCnt) * 0.5;
+  int color_puyo_cnt = plan.field.countColorPuyo();
+  add((colorPuyoCnt - puyoCnt) * 0.5);
 #endif
   int hidden_color_puyo_cnt = 0;
-  int ojama_height = plan->field.getOjamaFilmHeight(&hidden_color_puyo_cnt);
+  int ojama_height = plan.field.getOjamaFilmHeight(&hidden_color_puyo_cnt);
   if (hidden_color_puyo_cnt > 10) {
-    //LOG(INFO) << ojama_height << " r=" << r;
-    r -= ojama_height * 20;
+    add(-(ojama_height * 20));
   }
 
-  if (plan->field.Get(3, 11) != PuyoColor::EMPTY)
-    r -= 5;
+  if (plan.field.Get(3, 11) != PuyoColor::EMPTY)
+    add(-5);
 
   if (puyo_cnt < 40 || is_emergency_) {
-    const LP* p = plan;
+    const LP* p = &plan;
     while (p->parent) {
       int score = p->score - p->parent->score;
       if (score > 0 && score < 200)
-        r -= 1;
+        add(-1);
       p = p->parent;
     }
     if (p->score > 0 && p->score < 200)
-      r -= 1;
+      add(-1);
     if (p->score > 0 && p->score < 1000 && puyo_cnt < 20)
-      r -= 10;
+      add(-10);
   }
 
-  r -= 0.00001 * plan->chigiri_frames;
+  add(-(0.00001 * plan.chigiri_frames));
 
   if (g_use_ta) {
-    double ta_score = 0;
+    double ts = 0;
     for (int p1 = 0; p1 < 13*6; p1++) {
       int x1 = p1 % 6 + 1;
       int y1 = p1 / 6 + 1;
-      PuyoColor c1 = plan->field.Get(x1, y1);
+      PuyoColor c1 = plan.field.Get(x1, y1);
       if (!isNormalColor(c1))
         continue;
       for (int p2 = p1+1; p2 < 13*6; p2++) {
         int x2 = p2 % 6 + 1;
         int y2 = p2 / 6 + 1;
-        PuyoColor c2 = plan->field.Get(x2, y2);
+        PuyoColor c2 = plan.field.Get(x2, y2);
         if (!isNormalColor(c2))
           continue;
 
@@ -351,19 +358,17 @@ double Eval::eval(LP* plan) {
           continue;
         if (tav > 0) {
           if (c1 != c2)
-            ta_score -= tav * 10;
+            ts -= tav * 10;
           else
-            ta_score += 1;
+            ts += 1;
         } else if (tav < 0 && c1 == c2) {
-          ta_score += tav * 10;
+          ts += tav * 10;
         }
       }
     }
-    plan->evals[TA_SCORE] = ta_score;
-    r += ta_score;
+    *ta_score = ts;
+    add(ts);
   }
-
-  return r;
 }
 
 const string Eval::getEvalString(const LP& plan) {
@@ -376,6 +381,73 @@ const string Eval::getEvalString(const LP& plan) {
   return oss.str();
 }
 
+int Eval::addToBatch(const LP& plan) {
+  int num_features = g_param_index_offsets.back();
+  int row = batch_size_++;
+  if (batch_features_.size() <
+      static_cast<size_t>(batch_size_ * num_features)) {
+    batch_features_.resize(batch_size_ * num_features);
+    batch_adjustment_ends_.resize(batch_size_);
+    batch_ta_scores_.resize(batch_size_);
+    batch_chain_cnts_.resize(batch_size_);
+  }
+
+  batch_row_.assign(params_->size(), 0);
+  fillEvalParamVector(plan.field, &batch_row_, &batch_chain_cnts_[row]);
+  copy(batch_row_.begin(), batch_row_.begin() + num_features,
+       batch_features_.begin() + row * num_features);
+
+  if (row == 0)
+    batch_adjustments_.clear();
+  batch_ta_scores_[row] = 0;
+  addAdjustments(plan, &batch_ta_scores_[row], [this](double a) {
+    batch_adjustments_.push_back(a);
+  });
+  batch_adjustment_ends_[row] = batch_adjustments_.size();
+  return row;
+}
+
+const vector<double>& Eval::evalBatch() {
+  int num_features = g_param_index_offsets.back();
+  batch_values_.resize(batch_size_);
+  // Param isn't a plain array of weights, so the weights are gathered once.
+  batch_weights_.resize(num_features);
+  for (int i = 0; i < num_features; i++)
+    batch_weights_[i] = (*params_)[i].value;
+  const double* w = batch_weights_.data();
+  const double* f = batch_features_.data();
+  int k = 0;
+  for (int row = 0; row < batch_size_; row++, f += num_features) {
+    double score = 0;
+    for (int i = 0; i < num_features; i++)
+      score += f[i] * w[i];
+    // Added in the same order as eval(), so the values are exactly the same.
+    for (; k < batch_adjustment_ends_[row]; k++)
+      score += batch_adjustments_[k];
+    batch_values_[row] = score;
+  }
+  return batch_values_;
+}
+
+string Eval::getBatchEvalString(int row) const {
+  int num_features = g_param_index_offsets.back();
+  const double* f = &batch_features_[row * num_features];
+  LP plan;
+  plan.chain_cnt = batch_chain_cnts_[row];
+  plan.evals.resize(g_param_index_offsets.size(), 0);
+  size_t j = 0;
+  for (int i = 0; i < num_features; i++) {
+    if (i == g_param_index_offsets[j+1]) {
+      j++;
+    }
+    plan.evals[j] += f[i] * (*params_)[i].value;
+  }
+  if (g_use_ta)
+    plan.evals[TA_SCORE] = batch_ta_scores_[row];
+  return getEvalString(plan);
+}
+
+
 // === study ===
 
 struct Eval::Teacher {
@@ -490,6 +562,10 @@ void Eval::study() {
 
   LOG(INFO) << "# of teachers: " << teachers.size();
 
+  // The parameters are modified only by this Eval.
+  studied_params_ = g_params;
+  params_ = &studied_params_;
+
   const double kDelta = FLAGS_delta;
   double kAlpha = FLAGS_alpha;
   double base = 0;
@@ -498,26 +574,26 @@ void Eval::study() {
     base = calcParamError(teachers);
     fprintf(stderr, "base=%f\n", base);
 
-    vector<double> diffs(params_.size());
+    vector<double> diffs(studied_params_.size());
 
-    for (size_t i = 0; i < params_.size(); i++) {
-      params_[i].value += kDelta;
+    for (size_t i = 0; i < studied_params_.size(); i++) {
+      studied_params_[i].value += kDelta;
       diffs[i] = calcParamError(teachers) - base;
-      params_[i].value -= kDelta;
+      studied_params_[i].value -= kDelta;
     }
 
-    for (size_t i = 0; i < params_.size(); i++) {
-      params_[i].value -= diffs[i] * kAlpha;
+    for (size_t i = 0; i < studied_params_.size(); i++) {
+      studied_params_[i].value -= diffs[i] * kAlpha;
     }
   }
 
   printf("# techers=%s(%d) base=%f cnt=%d iter=%d delta=%f alpha=%f*%f\n",
-         FLAGS_teacher.c_str(), (int)teachers.size(), base, g_eval_cnt,
+         FLAGS_teacher.c_str(), (int)teachers.size(), base, g_eval_cnt.load(),
          FLAGS_iter, FLAGS_delta, FLAGS_alpha, FLAGS_alpha_decay);
-  for (size_t i = 0; i < params_.size(); i++) {
-    printf("# %s\n", params_[i].name.c_str());
-    printf("%f\n", params_[i].value);
+  for (size_t i = 0; i < studied_params_.size(); i++) {
+    printf("# %s\n", studied_params_[i].name.c_str());
+    printf("%f\n", studied_params_[i].value);
   }
 
-  fprintf(stderr, "eval count=%d\n", g_eval_cnt);
+  fprintf(stderr, "eval count=%d\n", g_eval_cnt.load());
 }
@@ -25,6 +25,20 @@ public:
 
   static const string getEvalString(const LP& plan);
 
+  // Batched evaluation. The feature vectors of the plans are stored as the
+  // rows of a (plans x features) matrix, and the values of all the plans
+  // are computed by one matrix-vector multiplication. The buffers are kept
+  // across batches, so an Eval reused across thinks doesn't reallocate.
+  // Adds |plan| to the batch and returns its row. |plan| isn't kept.
+  int addToBatch(const LP& plan);
+  int batchSize() const { return batch_size_; }
+  // Returns the values of the plans in the batch, in the order of rows.
+  // The value of a row is the same as what eval() returns for the plan.
+  const vector<double>& evalBatch();
+  // Returns what getEvalString() returns for the plan at |row|.
+  string getBatchEvalString(int row) const;
+  void clearBatch() { batch_size_ = 0; }
+
   void study();
 
   void setIsEmergency(bool is_emergency) { is_emergency_ = is_emergency; }
@@ -37,17 +51,36 @@ private:
   double getConnectionScore(const LF& field, vector<double>* param_scores);
   void getHeightScore(const LF& field, vector<double>* param_scores);
   void getVertical3(const LF& field, vector<double>* param_scores);
+  // Calls |add| with each term of the value which isn't linear in the
+  // features. The value is the linear part plus the terms in order.
+  template<typename Add>
+  void addAdjustments(const LP& plan, double* ta_score, Add add);
 
   double calcParamError(vector<Teacher>& teachers);
 
   static void init();
-  static std::mutex g_mu;
+  static void initOnce();
+  static std::once_flag g_init_once;
   static vector<Param> g_params;
   static vector<int> g_param_index_offsets;
 
-  vector<Param> params_;
-  vector<int> param_index_offsets_;
+  // Points to |g_params|, which is shared and read-only, except while studying.
+  const vector<Param>* params_;
+  vector<Param> studied_params_;
   bool is_emergency_;
+
+  // Buffers of the batch. |batch_features_| is row-major, and has
+  // |g_param_index_offsets.back()| columns.
+  int batch_size_;
+  vector<double> batch_features_;
+  // The adjustments of the row |i| are [ends[i-1], ends[i]).
+  vector<double> batch_adjustments_;
+  vector<int> batch_adjustment_ends_;
+  vector<double> batch_ta_scores_;
+  vector<int> batch_chain_cnts_;
+  vector<double> batch_values_;
+  vector<double> batch_weights_;
+  vector<double> batch_row_;
 };
 
 #endif  // HAMAJI_EVAL_H_
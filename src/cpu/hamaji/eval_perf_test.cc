@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+
+#include "base/base.h"
+#include "base/time.h"
+#include "base/time_stamp_counter.h"
+#include "core/kumipuyo_seq.h"
+#include "eval.h"
+#include "field.h"
+
+using namespace std;
+
+namespace {
+
+void findPlans(vector<LP>* plans) {
+  LF f("446676"
+       "456474"
+       "656476"
+       "657564"
+       "547564"
+       "747676"
+       "466766"
+       "747674"
+       "757644"
+       "657575"
+       "475755");
+  f.FindAvailablePlans(KumipuyoSeq("RBYGRB"), plans);
+}
+
+}  // namespace
+
+TEST(PerformanceTest, Eval) {
+  vector<LP> plans;
+  findPlans(&plans);
+  Eval eval;
+
+  TimeStampCounterData tsc;
+  double begin = currentTime();
+  for (int i = 0; i < 500; i++) {
+    ScopedTimeStampCounter stsc(&tsc);
+    for (LP& plan : plans)
+      eval.eval(&plan);
+  }
+  double elapsed = currentTime() - begin;
+  cout << "evals/sec: " << plans.size() * 500 / elapsed << endl;
+  tsc.showStatistics();
+}
+
+TEST(PerformanceTest, EvalBatch) {
+  vector<LP> plans;
+  findPlans(&plans);
+  Eval eval;
+
+  TimeStampCounterData tsc;
+  double begin = currentTime();
+  for (int i = 0; i < 500; i++) {
+    ScopedTimeStampCounter stsc(&tsc);
+    for (const LP& plan : plans)
+      eval.addToBatch(plan);
+    eval.evalBatch();
+    eval.clearBatch();
+  }
+  double elapsed = currentTime() - begin;
+  cout << "evals/sec: " << plans.size() * 500 / elapsed << endl;
+  tsc.showStatistics();
+}
@@ -0,0 +1,89 @@
+#include "eval.h"
+#include "field.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "core/kumipuyo_seq.h"
+
+using namespace std;
+
+namespace {
+
+// Checks that the batch gives exactly the same values and strings as eval().
+void expectSameAsEval(Eval* eval, vector<LP>* plans) {
+  vector<double> expected;
+  for (LP& plan : *plans)
+    expected.push_back(eval->eval(&plan));
+
+  // The second round reuses the buffers of the batch.
+  for (int round = 0; round < 2; round++) {
+    for (const LP& plan : *plans)
+      eval->addToBatch(plan);
+    const vector<double>& values = eval->evalBatch();
+    ASSERT_EQ(expected.size(), values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      EXPECT_EQ(expected[i], values[i]) << i;
+      EXPECT_EQ(Eval::getEvalString((*plans)[i]), eval->getBatchEvalString(i));
+    }
+    eval->clearBatch();
+  }
+}
+
+}  // namespace
+
+TEST(EvalTest, evalBatch) {
+  LF f("446676"
+       "456474"
+       "656476"
+       "657564"
+       "547564"
+       "747676"
+       "466766"
+       "747674"
+       "757644"
+       "657575"
+       "475755");
+  vector<LP> plans;
+  f.FindAvailablePlans(KumipuyoSeq("RBYGRB"), &plans);
+  ASSERT_FALSE(plans.empty());
+
+  Eval eval;
+  expectSameAsEval(&eval, &plans);
+}
+
+TEST(EvalTest, evalBatchWithFewPuyos) {
+  // With less than 40 puyos, the scores of the parent plans are adjusted too.
+  // The ojama film hides 12 colored puyos, which is adjusted as well.
+  LF f("RR...."
+       "OOOOOO"
+       "BYGRBY"
+       "YGRBYG");
+  int hidden_color_puyo_cnt;
+  ASSERT_EQ(1, f.getOjamaFilmHeight(&hidden_color_puyo_cnt));
+  ASSERT_LT(10, hidden_color_puyo_cnt);
+
+  for (bool is_emergency : { false, true }) {
+    // eval() adds to LP::evals, so the plans are found for each evaluation.
+    vector<LP> plans;
+    f.FindAvailablePlans(KumipuyoSeq("RRBBYG"), &plans);
+
+    // RR on the column 1 vanishes 4 REDs and 2 ojamas for 40 points, and leaves
+    // 16 puyos.
+    bool found_fired_plan = false;
+    for (const LP& plan : plans) {
+      if (!plan.parent && plan.decision == Decision(1, 0)) {
+        EXPECT_EQ(40, plan.score);
+        EXPECT_EQ(16, plan.field.countPuyo());
+        found_fired_plan = true;
+      }
+    }
+    ASSERT_TRUE(found_fired_plan);
+
+    Eval eval;
+    eval.setIsEmergency(is_emergency);
+    expectSameAsEval(&eval, &plans);
+  }
+}
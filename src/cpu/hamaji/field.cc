@@ -47,7 +47,21 @@ void LF::FindAvailablePlans(const KumipuyoSeq& next, int depth, vector<LP>* plan
   }
   plans->clear();
   plans->reserve(22 + 22*22 + 22*22*22);
-  FindAvailablePlansInternal(*this, next, NULL, 0, depth, plans);
+
+  // The parents are pointed by indices while copying, since the plans
+  // given to the callback are reused.
+  vector<int> indices(depth);
+  IterateAvailablePlans(next, depth, [&](LP* plan) {
+    int d = plan->depth();
+    indices[d] = plans->size();
+    plans->push_back(*plan);
+    plans->back().parent = d ? &(*plans)[indices[d - 1]] : NULL;
+  });
+}
+
+void LF::IterateAvailablePlans(const KumipuyoSeq& next, int depth,
+                               const PlanCallback& callback) const {
+  IterateAvailablePlansInternal(*this, next, NULL, 0, depth, callback);
 }
 
 void LF::FindAvailablePlans(const KumipuyoSeq& next, vector<LP>* plans) {
@@ -80,7 +94,8 @@ static const Decision all_decisions[22] = {
   Decision(5, 1),
 };
 
-void LF::FindAvailablePlansInternal(const LF& field, const KumipuyoSeq& next, const LP* parent, int depth, int max_depth, vector<LP>* plans) {
+// static
+void LF::IterateAvailablePlansInternal(const LF& field, const KumipuyoSeq& next, const LP* parent, int depth, int max_depth, const PlanCallback& callback) {
   PuyoColor c1 = next.axis(depth);
   PuyoColor c2 = next.child(depth);
   int num_decisions;
@@ -93,25 +108,21 @@ void LF::FindAvailablePlansInternal(const LF& field, const KumipuyoSeq& next, co
     decisions = &all_decisions[0];
   }
 
-  // Cause of slowness?
   int heights[LF::MAP_WIDTH+1];
   for (int x = 1; x <= LF::WIDTH; x++) {
-    heights[x] = 100;
-    for (int y = 1; y <= LF::HEIGHT + 2; y++) {
-      if (field.Get(x, y) == PuyoColor::EMPTY) {
-        heights[x] = y;
-        break;
-      }
-    }
+    heights[x] = field.height(x) + 1;
   }
 
+  // Reused for all the decisions.
+  LP plan;
+  LF next_field;
   for (int i = 0; i < num_decisions; i++) {
     const Decision& decision = decisions[i];
     if (!PuyoController::isReachable(field, decision)) {
       continue;
     }
 
-    LF next_field(field);
+    next_field = field;
 
     int x1 = decision.x;
     int x2 = decision.x + (decision.r == 1) - (decision.r == 3);
@@ -133,9 +144,6 @@ void LF::FindAvailablePlansInternal(const LF& field, const KumipuyoSeq& next, co
       continue;
     }
 
-    // Add a new plan.
-    plans->push_back(LP());
-    LP& plan = plans->at(plans->size() - 1);
     plan.field = next_field;
     plan.decision = decision;
     plan.parent = parent;
@@ -148,9 +156,21 @@ void LF::FindAvailablePlansInternal(const LF& field, const KumipuyoSeq& next, co
       plan.chain_cnt = chains;
       plan.chigiri_frames = chigiri_frames;
     }
+    plan.evals.clear();
+
+    // The callback may modify |plan|, so the children are made from the
+    // values before the callback.
+    int plan_score = plan.score;
+    int plan_chain_cnt = plan.chain_cnt;
+    int plan_chigiri_frames = plan.chigiri_frames;
+    callback(&plan);
 
     if (depth < max_depth - 1) {
-      FindAvailablePlansInternal(next_field, next, &plan, depth + 1, max_depth, plans);
+      plan.decision = decision;
+      plan.score = plan_score;
+      plan.chain_cnt = plan_chain_cnt;
+      plan.chigiri_frames = plan_chigiri_frames;
+      IterateAvailablePlansInternal(next_field, next, &plan, depth + 1, max_depth, callback);
     }
   }
 }
@@ -213,6 +233,13 @@ bool LF::hasPuyo() const {
   return false;
 }
 
+int LP::depth() const {
+  int d = 0;
+  for (const LP* p = parent; p; p = p->parent)
+    d++;
+  return d;
+}
+
 Decision LP::getFirstDecision() const {
   const LP* p = this;
   while (p->parent)
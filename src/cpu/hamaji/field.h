@@ -1,6 +1,7 @@
 #ifndef HAMAJI_FIELD_H_
 #define HAMAJI_FIELD_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -57,7 +58,17 @@ class LF : public CoreField {
   // Normal print for debugging purpose.
   const string GetDebugOutput() const;
 
-  // TODO(mayah): Consider using Plan::iterateAvailablePlans().
+  // Calls |callback| for each plan up to |depth| pairs of puyos. A plan is
+  // visited before the plans that follow it. Unlike Plan::iterateAvailablePlans,
+  // intermediate plans are visited too, and the search continues after chains.
+  // Only one LP per depth is alive, so the plan and its parents are valid only
+  // during the callback. The callback may modify the plan; it doesn't affect
+  // the following plans.
+  typedef std::function<void (LP*)> PlanCallback;
+  void IterateAvailablePlans(const KumipuyoSeq& next, int depth,
+                             const PlanCallback& callback) const;
+
+  // Same as IterateAvailablePlans, but copies all the plans to |plans|.
   // depth = 1 -- think about the next pair of puyos.
   // depth = 2 -- think about the next 2 pairs of puyos.
   // depth = 3 -- think about the next 3 pairs of puyos.
@@ -93,15 +104,18 @@ class LF : public CoreField {
   bool complementOjamasDropped(const LF& f);
 
  private:
-  void FindAvailablePlansInternal(const LF& field, const KumipuyoSeq& next,
-                                  const LP* parent,
-                                  int depth, int max_depth,
-                                  vector<LP>* plans);
+  static void IterateAvailablePlansInternal(const LF& field,
+                                           const KumipuyoSeq& next,
+                                           const LP* parent,
+                                           int depth, int max_depth,
+                                           const PlanCallback& callback);
 };
 
 class LP {
  public:
   Decision getFirstDecision() const;
+  // Returns the number of the parents.
+  int depth() const;
 
   // Previous state.
   const LP* parent;
@@ -1,8 +1,10 @@
 #include <gtest/gtest.h>
+#include <iostream>
 #include <vector>
 
 #include "base/base.h"
 #include "base/time_stamp_counter.h"
+#include "core/kumipuyo_seq.h"
 #include "field.h"
 
 using namespace std;
@@ -13,7 +15,7 @@ TEST(PerformanceTest, FindAvailablePlans_Empty) {
   for (int i = 0; i < 500; i++) {
     ScopedTimeStampCounter stsc(&tsc);
     LF f;
-    const string& next = LF::parseNext("456745");
+    const KumipuyoSeq next("RBYGRB");
     vector<LP> plans;
     f.FindAvailablePlans(next, &plans);
   }
@@ -36,9 +38,33 @@ TEST(PerformanceTest, FindAvailablePlans_Filled) {
          "757644"
          "657575"
          "475755");
-    const string& next = LF::parseNext("456745");
+    const KumipuyoSeq next("RBYGRB");
     vector<LP> plans;
     f.FindAvailablePlans(next, &plans);
   }
   tsc.showStatistics();
 }
+
+TEST(PerformanceTest, IterateAvailablePlans_Filled) {
+  TimeStampCounterData tsc;
+
+  int num_plans = 0;
+  for (int i = 0; i < 500; i++) {
+    ScopedTimeStampCounter stsc(&tsc);
+    LF f("446676"
+         "456474"
+         "656476"
+         "657564"
+         "547564"
+         "747676"
+         "466766"
+         "747674"
+         "757644"
+         "657575"
+         "475755");
+    const KumipuyoSeq next("RBYGRB");
+    f.IterateAvailablePlans(next, 3, [&](LP*) { num_plans++; });
+  }
+  cout << "plans: " << num_plans / 500 << endl;
+  tsc.showStatistics();
+}
@@ -2,9 +2,17 @@
 #include "field.h"
 #include "util.h"
 
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include "core/kumipuyo_seq.h"
+#include "core/puyo_controller.h"
+
 TEST(FieldTest, getBestChainCount) {
   {
     LF field;
@@ -118,3 +126,146 @@ TEST(FieldTest, getProspectiveChains) {
   }
 #endif
 }
+
+namespace {
+
+// The plan enumerator before LF::IterateAvailablePlans was introduced,
+// which is kept as a reference of the plans.
+void FindAvailablePlansByOldAlgorithm(const LF& field, const KumipuyoSeq& next,
+                                      const LP* parent, int depth, int max_depth,
+                                      vector<LP>* plans) {
+  static const Decision kDecisions[22] = {
+    Decision(1, 2), Decision(2, 2), Decision(3, 2), Decision(4, 2),
+    Decision(5, 2), Decision(6, 2), Decision(2, 3), Decision(3, 3),
+    Decision(4, 3), Decision(5, 3), Decision(6, 3),
+
+    Decision(1, 0), Decision(2, 0), Decision(3, 0), Decision(4, 0),
+    Decision(5, 0), Decision(6, 0), Decision(1, 1), Decision(2, 1),
+    Decision(3, 1), Decision(4, 1), Decision(5, 1),
+  };
+
+  PuyoColor c1 = next.axis(depth);
+  PuyoColor c2 = next.child(depth);
+  int num_decisions = c1 == c2 ? 11 : 22;
+  const Decision* decisions = c1 == c2 ? &kDecisions[11] : &kDecisions[0];
+
+  int heights[LF::MAP_WIDTH + 1];
+  for (int x = 1; x <= LF::WIDTH; x++) {
+    heights[x] = 100;
+    for (int y = 1; y <= LF::HEIGHT + 2; y++) {
+      if (field.Get(x, y) == PuyoColor::EMPTY) {
+        heights[x] = y;
+        break;
+      }
+    }
+  }
+
+  for (int i = 0; i < num_decisions; i++) {
+    const Decision& decision = decisions[i];
+    if (!PuyoController::isReachable(field, decision))
+      continue;
+
+    LF next_field(field);
+    int x1 = decision.x;
+    int x2 = decision.x + (decision.r == 1) - (decision.r == 3);
+    int chigiri_frames = FRAMES_TO_DROP[abs(x1 - x2)] + FRAMES_GROUNDING;
+    if (decision.r == 2) {
+      next_field.Set(x2, heights[x2]++, c2);
+      next_field.Set(x1, heights[x1]++, c1);
+    } else {
+      next_field.Set(x1, heights[x1]++, c1);
+      next_field.Set(x2, heights[x2]++, c2);
+    }
+    heights[x1]--;
+    heights[x2]--;
+    int chains, score, frames;
+    next_field.Simulate(&chains, &score, &frames);
+    if (next_field.Get(3, 12) != PuyoColor::EMPTY)
+      continue;
+
+    // |plans| is reserved by the caller, so |plan| is not moved.
+    plans->push_back(LP());
+    LP& plan = plans->back();
+    plan.field = next_field;
+    plan.decision = decision;
+    plan.parent = parent;
+    plan.score = (parent ? parent->score : 0) + score;
+    plan.chain_cnt = (parent ? parent->chain_cnt : 0) + chains;
+    plan.chigiri_frames = (parent ? parent->chigiri_frames : 0) + chigiri_frames;
+
+    if (depth < max_depth - 1) {
+      FindAvailablePlansByOldAlgorithm(next_field, next, &plan,
+                                       depth + 1, max_depth, plans);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(FieldTest, IterateAvailablePlans) {
+  LF f("....G."
+       "....B."
+       "....Y."
+       "....G."
+       "....B."
+       "....Y."
+       "....G."
+       "....B."
+       "....Y."
+       "..R.G."
+       ".RB.B."
+       "RRBYYG");
+  const KumipuyoSeq next("RBRBYG");
+
+  vector<LP> plans;
+  plans.reserve(22 + 22 * 22 + 22 * 22 * 22);
+  FindAvailablePlansByOldAlgorithm(f, next, NULL, 0, 3, &plans);
+  // The column 5 is filled up to the 12th row, so the column 6 can't be reached.
+  ASSERT_EQ(3610U, plans.size());
+
+  vector<const LP*> first_plans;
+  for (const LP& plan : plans) {
+    if (!plan.parent)
+      first_plans.push_back(&plan);
+  }
+  ASSERT_EQ(14U, first_plans.size());
+  EXPECT_EQ(Decision(1, 2), first_plans[0]->decision);
+  EXPECT_EQ(0, first_plans[0]->chain_cnt);
+  // RED on (1, 2) vanishes 4 REDs.
+  EXPECT_EQ(Decision(1, 0), first_plans[7]->decision);
+  EXPECT_EQ(1, first_plans[7]->chain_cnt);
+  EXPECT_EQ(40, first_plans[7]->score);
+  // BLUE on (4, 2) vanishes 4 BLUEs, and then the REDs on the column 3 fall
+  // onto the REDs on the columns 1 and 2.
+  EXPECT_EQ(Decision(3, 1), first_plans[13]->decision);
+  EXPECT_EQ(2, first_plans[13]->chain_cnt);
+  EXPECT_EQ(540, first_plans[13]->score);
+
+  vector<LP> found_plans;
+  f.FindAvailablePlans(next, &found_plans);
+  ASSERT_EQ(plans.size(), found_plans.size());
+
+  size_t i = 0;
+  f.IterateAvailablePlans(next, 3, [&](LP* plan) {
+    ASSERT_LT(i, plans.size());
+    const LP& expected = plans[i];
+    EXPECT_TRUE(expected.field.isEqual(plan->field));
+    EXPECT_EQ(expected.decision, plan->decision);
+    EXPECT_EQ(expected.score, plan->score);
+    EXPECT_EQ(expected.chain_cnt, plan->chain_cnt);
+    EXPECT_EQ(expected.chigiri_frames, plan->chigiri_frames);
+    EXPECT_EQ(expected.depth(), plan->depth());
+    EXPECT_EQ(expected.getFirstDecision(), plan->getFirstDecision());
+
+    EXPECT_TRUE(expected.field.isEqual(found_plans[i].field));
+    EXPECT_EQ(expected.score, found_plans[i].score);
+    EXPECT_EQ(expected.depth(), found_plans[i].depth());
+    EXPECT_EQ(expected.getFirstDecision(), found_plans[i].getFirstDecision());
+    i++;
+
+    // Modifying the plan doesn't affect the following plans.
+    plan->score += 10000;
+    plan->chain_cnt += 100;
+  });
+  EXPECT_EQ(plans.size(), i);
+}
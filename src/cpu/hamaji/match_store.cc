@@ -0,0 +1,189 @@
+#include "match_store.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <glog/logging.h>
+
+namespace {
+
+const uint32_t kImageKind = 0x42444d48;  // "HMDB"
+const uint32_t kImageVersion = 1;
+
+// Compares the first |pairs.size()| characters of |match_pairs| with
+// |pairs|. A shorter sequence is smaller if it's a prefix of |pairs|.
+int comparePrefix(const char* match_pairs, size_t match_len,
+                  const string& pairs) {
+  size_t len = min(match_len, pairs.size());
+  int c = memcmp(match_pairs, pairs.data(), len);
+  if (c)
+    return c;
+  return len < pairs.size() ? -1 : 0;
+}
+
+}  // namespace
+
+MatchStore::MatchStore()
+    : num_matches_(0),
+      turn_offsets_(0),
+      pairs_(0),
+      decisions_(0),
+      eof_reasons_(0),
+      sorted_matches_(0) {
+}
+
+// static
+bool MatchStore::save(const vector<Match>& matches, const string& filename) {
+  vector<uint32_t> turn_offsets;
+  vector<char> pairs;
+  vector<uint8_t> decisions;
+  vector<uint8_t> eof_reasons;
+  vector<string> sorted_pairs;
+
+  turn_offsets.push_back(0);
+  for (size_t i = 0; i < matches.size(); i++) {
+    Match normalized;
+    normalizeMatch(matches[i], &normalized);
+
+    string match_pairs;
+    for (size_t j = 0; j < normalized.seq.size(); j += 3) {
+      match_pairs += normalized.seq[j];
+      match_pairs += normalized.seq[j + 1];
+    }
+    pairs.insert(pairs.end(), match_pairs.begin(), match_pairs.end());
+    sorted_pairs.push_back(match_pairs);
+
+    for (const Decision& decision : normalized.decisions)
+      decisions.push_back(decision.x * 4 + decision.r);
+    turn_offsets.push_back(decisions.size());
+    eof_reasons.push_back(normalized.eof_reason);
+  }
+
+  vector<uint32_t> sorted_matches(matches.size());
+  for (size_t i = 0; i < matches.size(); i++)
+    sorted_matches[i] = i;
+  stable_sort(sorted_matches.begin(), sorted_matches.end(),
+              [&](uint32_t a, uint32_t b) {
+                return sorted_pairs[a] < sorted_pairs[b];
+              });
+
+  file::BinaryImageWriter writer(kImageKind, kImageVersion, 0);
+  writer.write(static_cast<uint32_t>(matches.size()));
+  writer.writeArray(turn_offsets);
+  writer.writeArray(pairs);
+  writer.writeArray(decisions);
+  writer.writeArray(eof_reasons);
+  writer.writeArray(sorted_matches);
+  return writer.save(filename);
+}
+
+bool MatchStore::load(const string& filename) {
+  if (!image_.open(filename, kImageKind, kImageVersion, 0))
+    return false;
+
+  uint32_t num_matches;
+  uint32_t num_turn_offsets, num_pairs, num_decisions, num_eof_reasons;
+  uint32_t num_sorted_matches;
+  if (!image_.read(&num_matches) ||
+      !image_.readArrayView(&turn_offsets_, &num_turn_offsets) ||
+      !image_.readArrayView(&pairs_, &num_pairs) ||
+      !image_.readArrayView(&decisions_, &num_decisions) ||
+      !image_.readArrayView(&eof_reasons_, &num_eof_reasons) ||
+      !image_.readArrayView(&sorted_matches_, &num_sorted_matches) ||
+      !image_.isEnd()) {
+    LOG(ERROR) << "broken match store: " << filename;
+    return false;
+  }
+
+  if (num_turn_offsets != num_matches + 1 ||
+      num_eof_reasons != num_matches ||
+      num_sorted_matches != num_matches ||
+      turn_offsets_[num_matches] != num_decisions ||
+      num_pairs != num_decisions * 2) {
+    LOG(ERROR) << "inconsistent match store: " << filename;
+    return false;
+  }
+
+  num_matches_ = num_matches;
+  return true;
+}
+
+string MatchStore::seq(int i) const {
+  string seq;
+  for (uint32_t t = turn_offsets_[i]; t < turn_offsets_[i + 1]; t++) {
+    seq += pairs_[t * 2];
+    seq += pairs_[t * 2 + 1];
+    seq += '-';
+  }
+  return seq;
+}
+
+Decision MatchStore::decision(int i, int turn) const {
+  uint8_t d = decisions_[turn_offsets_[i] + turn];
+  return Decision(d / 4, d % 4);
+}
+
+Match MatchStore::match(int i) const {
+  Match match;
+  match.seq = seq(i);
+  for (int t = 0; t < numTurns(i); t++)
+    match.decisions.push_back(decision(i, t));
+  match.eof_reason = eofReason(i);
+  return match;
+}
+
+void MatchStore::findByPrefix(const string& prefix,
+                              vector<int>* indices) const {
+  indices->clear();
+
+  // Only the colors 'A' to 'D' can be renamed. No match has other colors.
+  for (size_t i = 0; i + 1 < prefix.size(); i += 3) {
+    for (size_t j = i; j < i + 2; j++) {
+      if (prefix[j] < 'A' || prefix[j] > 'D')
+        return;
+    }
+  }
+
+  // The stored sequences are normalized, so tries all the renamings of
+  // |prefix|.
+  int perm[4] = { 0, 1, 2, 3 };
+  vector<string> candidates;
+  do {
+    string pairs;
+    for (size_t i = 0; i + 1 < prefix.size(); i += 3) {
+      char a = perm[prefix[i] - 'A'] + 'A';
+      char b = perm[prefix[i + 1] - 'A'] + 'A';
+      pairs += min(a, b);
+      pairs += max(a, b);
+    }
+    candidates.push_back(pairs);
+  } while (next_permutation(perm, perm + 4));
+
+  sort(candidates.begin(), candidates.end());
+  candidates.erase(unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+  for (const string& pairs : candidates)
+    findByNormalizedPairs(pairs, indices);
+
+  sort(indices->begin(), indices->end());
+}
+
+void MatchStore::findByNormalizedPairs(const string& pairs,
+                                       vector<int>* indices) const {
+  auto compare = [&](uint32_t m) {
+    uint32_t begin = turn_offsets_[m];
+    uint32_t end = turn_offsets_[m + 1];
+    return comparePrefix(pairs_ + begin * 2, (end - begin) * 2, pairs);
+  };
+
+  const uint32_t* first = lower_bound(
+      sorted_matches_, sorted_matches_ + num_matches_, 0,
+      [&](uint32_t m, int) { return compare(m) < 0; });
+  const uint32_t* last = upper_bound(
+      first, sorted_matches_ + num_matches_, 0,
+      [&](int, uint32_t m) { return compare(m) > 0; });
+
+  for (const uint32_t* p = first; p != last; ++p)
+    indices->push_back(*p);
+}
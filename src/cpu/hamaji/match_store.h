@@ -0,0 +1,62 @@
+#ifndef HAMAJI_MATCH_STORE_H_
+#define HAMAJI_MATCH_STORE_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/file/binary_image.h"
+#include "db.h"
+
+// MatchStore is a columnar, memory-mapped store of normalized matches.
+// Sequences, decisions and eof reasons are kept in separate arrays, and
+// the matches are indexed in the order of their normalized sequences, so
+// matches can be looked up by a tsumo prefix without parsing logs.
+class MatchStore {
+ public:
+  MatchStore();
+
+  // Normalizes |matches| with normalizeMatch, and saves them to |filename|.
+  static bool save(const vector<Match>& matches, const string& filename);
+
+  bool load(const string& filename);
+
+  int size() const { return num_matches_; }
+
+  int numTurns(int i) const {
+    return turn_offsets_[i + 1] - turn_offsets_[i];
+  }
+  // Returns the normalized sequence of the |i|-th match, e.g. "AB-AC-".
+  string seq(int i) const;
+  Decision decision(int i, int turn) const;
+  Match::EofReason eofReason(int i) const {
+    return static_cast<Match::EofReason>(eof_reasons_[i]);
+  }
+  Match match(int i) const;
+
+  // Sets the indices of the matches whose sequences start with |prefix|
+  // (e.g. "CD-DA-") up to renaming colors. The indices are sorted.
+  // A prefix with colors other than 'A' to 'D' matches nothing.
+  void findByPrefix(const string& prefix, vector<int>* indices) const;
+
+ private:
+  // Appends the matches whose normalized sequences start with |pairs|,
+  // which has 2 characters per kumipuyo, e.g. "ABAC".
+  void findByNormalizedPairs(const string& pairs, vector<int>* indices) const;
+
+  int num_matches_;
+  // Each kumipuyo is 2 characters in |pairs_|, and a decision in
+  // |decisions_|. The i-th match has the turns in
+  // [turn_offsets_[i], turn_offsets_[i + 1]).
+  const uint32_t* turn_offsets_;
+  const char* pairs_;
+  const uint8_t* decisions_;
+  const uint8_t* eof_reasons_;
+  // The indices of the matches sorted by their normalized sequences.
+  const uint32_t* sorted_matches_;
+
+  file::BinaryImageReader image_;
+};
+
+#endif  // HAMAJI_MATCH_STORE_H_
@@ -0,0 +1,94 @@
+#include "match_store.h"
+
+#include <gtest/gtest.h>
+
+#include "base/file/temporary_file.h"
+
+using namespace std;
+
+namespace {
+
+Match makeMatch(const string& seq, Match::EofReason eof_reason) {
+  Match match;
+  match.seq = seq;
+  for (size_t i = 0; i < seq.size(); i += 3)
+    match.decisions.push_back(Decision(i / 3 % 6 + 1, 0));
+  match.eof_reason = eof_reason;
+  return match;
+}
+
+}  // namespace
+
+TEST(MatchStoreTest, saveAndLoad) {
+  vector<Match> matches;
+  matches.push_back(makeMatch("CD-DA-DA-", Match::END_MATCH));
+  matches.push_back(makeMatch("AB-CD-CD-AA-", Match::MANY_TURNS));
+  // The axis and the child are swapped by normalization.
+  Match swapped = makeMatch("BA-AA-", Match::OJAMA_PUYO);
+  swapped.decisions[0] = Decision(3, 1);
+  matches.push_back(swapped);
+
+  file::TemporaryFile tmp;
+  const string& filename = tmp.path();
+  ASSERT_TRUE(MatchStore::save(matches, filename));
+
+  MatchStore store;
+  ASSERT_TRUE(store.load(filename));
+  ASSERT_EQ(3, store.size());
+
+  for (int i = 0; i < store.size(); i++) {
+    Match expected;
+    normalizeMatch(matches[i], &expected);
+    Match actual = store.match(i);
+    EXPECT_EQ(expected.seq, actual.seq);
+    EXPECT_EQ(expected.decisions, actual.decisions);
+    EXPECT_EQ(expected.eof_reason, actual.eof_reason);
+  }
+
+  EXPECT_EQ("AB-AC-AC-", store.seq(0));
+  EXPECT_EQ(4, store.numTurns(1));
+  EXPECT_EQ(Decision(4, 3), store.decision(2, 0));
+  EXPECT_EQ(Match::OJAMA_PUYO, store.eofReason(2));
+}
+
+TEST(MatchStoreTest, findByPrefix) {
+  vector<Match> matches;
+  matches.push_back(makeMatch("AB-AC-AC-", Match::END_MATCH));
+  matches.push_back(makeMatch("CD-DA-DA-", Match::END_MATCH));
+  matches.push_back(makeMatch("AB-CD-CD-", Match::END_MATCH));
+  matches.push_back(makeMatch("AA-BB-", Match::END_MATCH));
+  matches.push_back(makeMatch("AB-", Match::END_MATCH));
+
+  file::TemporaryFile tmp;
+  const string& filename = tmp.path();
+  ASSERT_TRUE(MatchStore::save(matches, filename));
+
+  MatchStore store;
+  ASSERT_TRUE(store.load(filename));
+
+  vector<int> indices;
+  store.findByPrefix("", &indices);
+  EXPECT_EQ((vector<int> { 0, 1, 2, 3, 4 }), indices);
+
+  store.findByPrefix("DC-", &indices);
+  EXPECT_EQ((vector<int> { 0, 1, 2, 4 }), indices);
+
+  store.findByPrefix("BA-BD-", &indices);
+  EXPECT_EQ((vector<int> { 0, 1 }), indices);
+
+  store.findByPrefix("AB-CD-", &indices);
+  EXPECT_EQ((vector<int> { 2 }), indices);
+
+  store.findByPrefix("CC-", &indices);
+  EXPECT_EQ((vector<int> { 3 }), indices);
+
+  store.findByPrefix("AB-AB-AB-", &indices);
+  EXPECT_TRUE(indices.empty());
+
+  // A prefix with an unknown color matches nothing, and clears |indices|.
+  store.findByPrefix("AB-", &indices);
+  store.findByPrefix("AE-", &indices);
+  EXPECT_TRUE(indices.empty());
+  store.findByPrefix("ab-", &indices);
+  EXPECT_TRUE(indices.empty());
+}
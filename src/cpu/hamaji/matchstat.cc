@@ -9,9 +9,55 @@
 
 #include "db.h"
 #include "field.h"
+#include "match_store.h"
 #include "ratingstats.h"
 
-DEFINE_int32(num_turns, 40, "");
+DEFINE_int32(num_turns, kDefaultStatNumTurns, "");
+DEFINE_string(store, "", "If set, matches are read from this match store instead of logs.");
+
+static void addMatches(const vector<Match>& matches,
+                       int* eof_reason_stat,
+                       RatingStats* stats) {
+  for (size_t j = 0; j < matches.size(); j++) {
+    const Match& match = matches[j];
+
+    eof_reason_stat[match.eof_reason]++;
+    if (match.eof_reason != Match::MANY_TURNS)
+      continue;
+    // The NEXT2 of the last turn should be in the sequence. A match store
+    // might be made with fewer turns.
+    if (match.seq.size() < static_cast<size_t>(FLAGS_num_turns + 2) * 3)
+      continue;
+
+    LF f;
+    for (int t = 0; t < FLAGS_num_turns; t++) {
+      string next;
+      for (int k = 0; k < 6; k++) {
+        next.push_back(match.seq[t*3+k/2*3+k%2] - 'A' + 4);
+      }
+      //puts(match.seq.c_str());
+      //puts(f.GetDebugOutput(next).c_str());
+
+      vector<LP> plans;
+      f.FindAvailablePlans(next, &plans);
+
+      for (size_t k = 0; k < plans.size(); k++) {
+        for (const LP* p = &plans[k]; p; p = p->parent) {
+          //int score = p->score - (p->parent ? p->parent->score : 0);
+          //stats->add_max_score(score, p->parent);
+
+          int chain_cnt =
+            p->chain_cnt - (p->parent ? p->parent->chain_cnt : 0);
+          stats->add_chain_stats(chain_cnt, stats->total_count, t);
+        }
+      }
+
+      f.PutDecision(match.decisions[t], toPuyoColor(next[0]), toPuyoColor(next[1]));
+    }
+
+    stats->total_count++;
+  }
+}
 
 int main(int argc, char* argv[]) {
   ParseCommandLineFlags(&argc, &argv, true);
@@ -23,45 +69,18 @@ int main(int argc, char* argv[]) {
   memset(&eof_reason_stat, 0, sizeof(eof_reason_stat));
 
   RatingStats stats;
+  if (!FLAGS_store.empty()) {
+    MatchStore store;
+    CHECK(store.load(FLAGS_store)) << FLAGS_store;
+    vector<Match> matches;
+    for (int i = 0; i < store.size(); i++)
+      matches.push_back(store.match(i));
+    addMatches(matches, eof_reason_stat, &stats);
+  }
   for (int i = 1; i < argc; i++) {
     vector<Match> matches;
-    parseMatches(argv[i], FLAGS_num_turns + 2, Match::OJAMA_PUYO_MASK | Match::VANISH_PUYO_MASK, &matches);
-
-    for (size_t j = 0; j < matches.size(); j++) {
-      const Match& match = matches[j];
-
-      eof_reason_stat[match.eof_reason]++;
-      if (match.eof_reason != Match::MANY_TURNS)
-        continue;
-
-      LF f;
-      for (int t = 0; t < FLAGS_num_turns; t++) {
-        string next;
-        for (int k = 0; k < 6; k++) {
-          next.push_back(match.seq[t*3+k/2*3+k%2] - 'A' + 4);
-        }
-        //puts(match.seq.c_str());
-        //puts(f.GetDebugOutput(next).c_str());
-
-        vector<LP> plans;
-        f.FindAvailablePlans(next, &plans);
-
-        for (size_t k = 0; k < plans.size(); k++) {
-          for (const LP* p = &plans[k]; p; p = p->parent) {
-            //int score = p->score - (p->parent ? p->parent->score : 0);
-            //stats.add_max_score(score, p->parent);
-
-            int chain_cnt =
-              p->chain_cnt - (p->parent ? p->parent->chain_cnt : 0);
-            stats.add_chain_stats(chain_cnt, stats.total_count, t);
-          }
-        }
-
-        f.PutDecision(match.decisions[t], toPuyoColor(next[0]), toPuyoColor(next[1]));
-      }
-
-      stats.total_count++;
-    }
+    parseMatchesForStats(argv[i], FLAGS_num_turns, &matches);
+    addMatches(matches, eof_reason_stat, &stats);
   }
 
   ostringstream ss;
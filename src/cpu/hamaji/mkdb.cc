@@ -10,6 +10,10 @@
 
 #include "db.h"
 #include "field.h"
+#include "match_store.h"
+
+DEFINE_string(store, "", "If set, the matches are saved to this columnar match store for matchstat.");
+DEFINE_int32(num_turns, kDefaultStatNumTurns, "The number of turns matchstat reads from the match store.");
 
 int main(int argc, char* argv[]) {
   ParseCommandLineFlags(&argc, &argv, true);
@@ -19,7 +23,12 @@ int main(int argc, char* argv[]) {
 
   vector<Match> matches;
   vector<Match> finished_matches;
+  vector<Match> stat_matches;
   for (int i = 1; i < argc; i++) {
+    // The store is read by matchstat, so it's filtered as matchstat filters logs.
+    if (!FLAGS_store.empty())
+      parseMatchesForStats(argv[i], FLAGS_num_turns, &stat_matches);
+
     parseMatches(argv[i], 20, 0, &matches);
     {
       char fname_buf[9999];
@@ -27,35 +36,17 @@ int main(int argc, char* argv[]) {
       FILE* fp = fopen(fname_buf, "wb");
       CHECK(fp) << fname_buf;
       for (size_t j = 0; j < matches.size(); j++) {
-        const string& seq = matches[j].seq;
-        CHECK_EQ(seq.size(), matches[j].decisions.size() * 3);
+        Match normalized;
+        normalizeMatch(matches[j], &normalized);
         string decisions;
-        bool* swapped = new bool[seq.size() / 3];
-        string normalized = normalizeSeq(seq, swapped);
-        for (size_t k = 0; k < matches[j].decisions.size(); k++) {
-          Decision decision = matches[j].decisions[k];
-          CHECK(decision.isValid());
-          if (swapped[k]) {
-            switch (decision.r) {
-            case 0:
-            case 2:
-              decision.r = 2 - decision.r;
-              break;
-            case 1:
-            case 3:
-              decision.x += 2 - decision.r;
-              decision.r = 4 - decision.r;
-              break;
-            }
-          }
+        for (const Decision& decision : normalized.decisions) {
           decisions += decision.x + '0';
           decisions += "URDL"[decision.r];
           decisions += '-';
         }
-        delete[] swapped;
 
         fprintf(fp, "%s %s\n",
-                normalized.c_str(), decisions.c_str());
+                normalized.seq.c_str(), decisions.c_str());
       }
       fclose(fp);
       copy(matches.begin(), matches.end(), back_inserter(finished_matches));
@@ -65,6 +56,9 @@ int main(int argc, char* argv[]) {
 
   matches.swap(finished_matches);
 
+  if (!FLAGS_store.empty())
+    CHECK(MatchStore::save(stat_matches, FLAGS_store)) << FLAGS_store;
+
   size_t num_decisions = 0;
   for (size_t i = 0; i < matches.size(); i++) {
     num_decisions += matches[i].decisions.size();
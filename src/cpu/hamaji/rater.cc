@@ -8,6 +8,8 @@
 #include <chrono>
 #include <thread>
 
+#include "base/time.h"
+
 #include "field.h"
 #include "game.h"
 #include "ratingstats.h"
@@ -28,6 +30,7 @@ DEFINE_bool(show_progress, true, "");
 Rater::Rater(int eval_threads, int eval_cnt, int base_seed)
     : threads_(eval_threads),
       states_(eval_threads),
+      rating_stats_vec_(eval_cnt),
       game_index_(0),
       finished_games_(0),
       eval_cnt_(eval_cnt),
@@ -49,6 +52,7 @@ Rater::~Rater() {
 #endif  // GOOGLE3
 }
 void Rater::eval(RatingStats* all_stats) {
+  double begin_time = currentTime();
   for (size_t i = 0; i < threads_.size(); i++) {
     states_[i].tid = i;
     states_[i].rater = this;
@@ -57,24 +61,10 @@ void Rater::eval(RatingStats* all_stats) {
     });
   }
 
-  while (true) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-    std::lock_guard<std::mutex> lock(mu_);
-
-    if (FLAGS_show_progress) {
-      fprintf(stderr, "\r");
-      int sum_turns = 0;
-      for (size_t i = 0; i < states_.size(); i++) {
-        const ThreadState& s = states_[i];
-        sum_turns += s.turn;
-      }
-      fprintf(stderr, "%d/%d %d    ",
-              finished_games_, eval_cnt_, sum_turns);
-    }
-
-    if (finished_games_ == eval_cnt_)
-      break;
+  while (finished_games_ < eval_cnt_) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (FLAGS_show_progress)
+      showProgress(currentTime() - begin_time);
   }
 
   for (size_t i = 0; i < threads_.size(); i++) {
@@ -86,12 +76,28 @@ void Rater::eval(RatingStats* all_stats) {
     puyo_cloud_->Wait();
   }
 #endif // GOOGLE3
-  std::lock_guard<std::mutex> lock(mu_);
+  double elapsed_sec = currentTime() - begin_time;
+  if (FLAGS_show_progress)
+    fprintf(stderr, "\n");
+  LOG(INFO) << eval_cnt_ << " games in " << elapsed_sec << " sec ("
+            << (eval_cnt_ * 60.0 / elapsed_sec) << " games/min)";
+
   for (size_t i = 0; i < rating_stats_vec_.size(); ++i) {
     all_stats->merge(rating_stats_vec_[i]);
   }
 }
 
+void Rater::showProgress(double elapsed_sec) {
+  int sum_turns = 0;
+  for (size_t i = 0; i < states_.size(); i++) {
+    sum_turns += states_[i].turn;
+  }
+  int finished_games = finished_games_;
+  fprintf(stderr, "\r%d/%d %d %.1f games/min    ",
+          finished_games, eval_cnt_, sum_turns,
+          elapsed_sec > 0 ? finished_games * 60.0 / elapsed_sec : 0.0);
+}
+
 void* Rater::runWorker(void* self) {
   ThreadState* st = (ThreadState*)self;
   st->rater->runWorker(st->tid);
@@ -105,9 +111,8 @@ void Rater::runWorker(int tid) {
       break;
 
     if (!FLAGS_puyo_cloud) {
-      RatingStats rating_stats;
-      evalOneGame(i, base_seed_ + i, &(states_[tid]), &rating_stats);
-      GameDone(i, rating_stats);
+      evalOneGame(i, base_seed_ + i, &(states_[tid]), &rating_stats_vec_[i]);
+      finished_games_++;
     } else {
 #ifdef GOOGLE3
       puyo_cloud_->SendToPuyoCloud(i, this);
@@ -118,18 +123,14 @@ void Rater::runWorker(int tid) {
   }
 }
 
-void Rater::GameDone(const int /* index */, const RatingStats& stats) {
-  std::lock_guard<std::mutex> lock(mu_);
-  // LOG(INFO) << rating_stats_vec_.size() << " done.";
-  rating_stats_vec_.push_back(stats);
+void Rater::GameDone(const int index, const RatingStats& stats) {
+  rating_stats_vec_[index] = stats;
   finished_games_++;
 }
 
 int Rater::pickGameIndex() {
-  std::lock_guard<std::mutex> lock(mu_);
-  if (game_index_ == eval_cnt_)
-    return -1;
-  return game_index_++;
+  int i = game_index_++;
+  return i < eval_cnt_ ? i : -1;
 }
 
 void Rater::evalOneGame(int i,
@@ -1,23 +1,27 @@
 #ifndef HAMAJI_RATER_H_
 #define HAMAJI_RATER_H_
 
+#include <atomic>
 #include <thread>
-#include <mutex>
 #include <vector>
 
 #include "base.h"
+#include "ratingstats.h"
 
-class RatingStats;
 class PuyoCloudManager;
 
+// Rater plays |eval_cnt| solo games with |eval_threads| threads.
+// The i-th game always uses the seed |base_seed| + i, and the stats of
+// the games are merged in the order of games, so a rerun with the same
+// seed shows the same stats regardless of the number of threads.
 class Rater {
   struct ThreadState {
     ThreadState()
       : rater(NULL), tid(0), game_id(0), turn(0) {}
     Rater* rater;
     int tid;
-    int game_id;
-    int turn;
+    std::atomic<int> game_id;
+    std::atomic<int> turn;
   };
 
 public:
@@ -32,15 +36,15 @@ private:
   static void* runWorker(void* self);
   void runWorker(int tid);
   int pickGameIndex();
+  void showProgress(double elapsed_sec);
 
  private:
-  std::mutex mu_;
-
   vector<std::thread> threads_;
   vector<ThreadState> states_;
+  // The stats of the i-th game. Each game writes only its own slot.
   vector<RatingStats> rating_stats_vec_;
-  int game_index_;
-  int finished_games_;
+  std::atomic<int> game_index_;
+  std::atomic<int> finished_games_;
   int eval_cnt_;
   int base_seed_;
 #ifdef GOOGLE3
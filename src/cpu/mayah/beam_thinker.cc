@@ -1,15 +1,15 @@
 #include "beam_thinker.h"
 
 #include <map>
-#include <set>
-#include <unordered_set>
+#include <mutex>
+#include <sstream>
 
 #include "base/time.h"
-#include "base/wait_group.h"
-#include "core/field_pretty_printer.h"
 #include "core/kumipuyo_seq_generator.h"
 #include "core/plan/plan.h"
 #include "core/rensa/rensa_detector.h"
+#include "core/search/beam_search.h"
+#include "core/search/rollout_scheduler.h"
 
 #include <iostream>
 
@@ -21,11 +21,6 @@ using namespace std;
 
 namespace {
 
-struct SearchResult {
-    std::set<Decision> firstDecisions;
-    int maxChains = 0;
-};
-
 struct State {
     State(const CoreField& field, const Decision& firstDecision, double stateScore, int maxChains,
           int total_frames) :
@@ -52,15 +47,10 @@ struct State {
     int pending_enemy_ojama_drop_frame = 0;
 };
 
-std::pair<double, int> evalSuperLight(const CoreField& fieldBeforeRensa)
+// Evaluates |fieldBeforeRensa|. |maxChains| is the max chains of the rensas found
+// by RensaDetector in |fieldBeforeRensa|.
+double evalSuperLight(const CoreField& fieldBeforeRensa, int maxChains)
 {
-    int maxChains = 0;
-    auto callback = [&maxChains](CoreField&& complementedField, const ColumnPuyoList& /*cpl*/) {
-        maxChains = std::max(maxChains, complementedField.simulateFast());
-    };
-    static const bool prohibits[FieldConstant::MAP_WIDTH] {};
-    RensaDetector::detectByDropStrategy(fieldBeforeRensa, prohibits, PurposeForFindingRensa::FOR_FIRE, 2, 13, callback);
-
     double maxScore = 0;
     maxScore += maxChains * 1000;
 
@@ -91,121 +81,96 @@ std::pair<double, int> evalSuperLight(const CoreField& fieldBeforeRensa)
     }
 #endif
 
-    return std::make_pair(maxScore, maxChains);
+    return maxScore;
 }
 
-SearchResult run(const std::vector<State>& initialStates, KumipuyoSeq seq, int maxSearchTurns,
-                 std::mutex& mu)
+BeamSearchOptions beamSearchOptions()
 {
-    SearchResult result;
-
-    std::vector<State> currentStates(initialStates);
-
-    int maxOverallFiredChains = 0;
-    int maxOverallFiredScore = 0;
-
-    std::vector<State> nextStates;
-    nextStates.reserve(100000);
-
-    std::vector<double> time(std::max(maxSearchTurns, 10));
-
-    double beginTime = currentTime();
-
-    for (int turn = 3; turn < maxSearchTurns; ++turn) {
-        time[turn] = currentTime();
-
-        seq.dropFront();
-
-        std::unordered_set<size_t> visited;
-
-        int maxFiredScore = 0;
-        int maxFiredRensa = 0;
-
-        for (const State& s : currentStates) {
-            Plan::iterateAvailablePlans(s.field, seq, 1, [&](const RefPlan& plan) {
-                const CoreField& fieldBeforeRensa = plan.field();
-                if (!visited.insert(fieldBeforeRensa.hash()).second)
-                    return;
-
-                int total_frames = s.total_frames + plan.totalFrames() + FRAMES_PREPARING_NEXT;
+    BeamSearchOptions options;
+    options.beamWidthAt = [](int turn) { return turn <= 6 ? 22 * 22 : FLAGS_beam_width; };
+    return options;
+}
 
-                if (plan.isRensaPlan()) {
-                    maxOverallFiredScore = std::max(maxOverallFiredScore, plan.rensaResult().score);
-                    maxOverallFiredChains = std::max(maxOverallFiredChains, plan.rensaResult().chains);
+// A layer of a beam search. The rollouts share a layer while their kumipuyos are the same.
+struct BeamLayer {
+    std::vector<State> states;
+    int maxFiredChains = 0;
+    // True if no state was generated in a layer. The states are kept as they are then.
+    bool stopped = false;
+};
 
-                    maxFiredScore = std::max(maxFiredScore, plan.rensaResult().score);
-                    maxFiredRensa = std::max(maxFiredRensa, plan.rensaResult().chains);
+// Makes |child|, the next layer of |parent| with |kumipuyo|. |turn| is the turn of |child|.
+// Returns the number of the expanded states.
+long long expandLayer(int turn, const BeamLayer& parent, const Kumipuyo& kumipuyo, BeamLayer* child)
+{
+    if (parent.stopped) {
+        *child = parent;
+        return 0;
+    }
 
-                    nextStates.emplace_back(fieldBeforeRensa, s.firstDecision, plan.rensaResult().chains,
-                                            plan.rensaResult().chains, total_frames);
-                    return;
-                }
+    // The rollouts are already run in parallel, so a layer is expanded in this thread.
+    // A rollout chain is run by a worker until it forks or finishes, so each worker keeps
+    // one search, and resets it for each layer. Its buffers are reused then.
+    static thread_local BeamSearch<State> search(beamSearchOptions());
+
+    const KumipuyoSeq seq { kumipuyo };
+    int maxFiredChains = parent.maxFiredChains;
+
+    // The fields which don't fire a rensa are evaluated in a batch for each parent.
+    // The children are emitted in the order of the plans after that, since the order breaks ties.
+    // The buffers are shared by the parents, since the search is run in this thread.
+    std::vector<State> children;
+    std::vector<size_t> batchIndices;
+    std::vector<CoreField> batchFields;
+    std::vector<int> batchMaxChains;
+    RensaDetector::DropStrategyScratch scratch;
+
+    auto expand = [&](int, int /*parentIndex*/, const State& s, BeamSearchEmitter<State>* emitter) {
+        children.clear();
+        batchIndices.clear();
+        batchFields.clear();
+        Plan::iterateAvailablePlans(s.field, seq, 1, [&](const RefPlan& plan) {
+            const CoreField& fieldBeforeRensa = plan.field();
+            if (!emitter->visit(fieldBeforeRensa.hash()))
+                return;
 
-                double maxScore;
-                int maxChains;
-                std::tie(maxScore, maxChains) = evalSuperLight(fieldBeforeRensa);
-                nextStates.emplace_back(plan.field(), s.firstDecision, maxScore, maxChains, total_frames);
-            });
-        }
-
-        std::sort(nextStates.begin(), nextStates.end(), std::greater<State>());
+            int total_frames = s.total_frames + plan.totalFrames() + FRAMES_PREPARING_NEXT;
 
-        int beamWidth = FLAGS_beam_width;
-        if (turn <= 6) {
-            beamWidth = 22 * 22;
-        }
+            if (plan.isRensaPlan()) {
+                maxFiredChains = std::max(maxFiredChains, plan.rensaResult().chains);
 
-        if (nextStates.size() > static_cast<size_t>(beamWidth)) {
-            nextStates.erase(nextStates.begin() + beamWidth, nextStates.end());
-        }
-        std::swap(currentStates, nextStates);
-        nextStates.clear();
-
-        if (false) {
-            cout << "turn=" << turn
-                 << " score=" << currentStates.front().stateScore
-                 << " chains=" << currentStates.front().maxChains
-                 << " first=" << currentStates.front().firstDecision
-                 << " : fired_score=" << maxFiredScore
-                 << " fired_rensa=" << maxFiredRensa
-                 << endl;
-
-            std::map<Decision, int> m;
-            for (const auto& s : currentStates) {
-                m[s.firstDecision] += 1;
-            }
-            cout << "decision kind = " << m.size() << endl;
-            for (const auto& entry : m) {
-                cout << entry.first << " " << entry.second << endl;
+                children.emplace_back(fieldBeforeRensa, s.firstDecision, plan.rensaResult().chains,
+                                      plan.rensaResult().chains, total_frames);
+                return;
             }
 
-            FieldPrettyPrinter::print(currentStates.front().field.toPlainField(), KumipuyoSeq());
+            batchIndices.push_back(children.size());
+            batchFields.push_back(fieldBeforeRensa);
+            children.emplace_back(fieldBeforeRensa, s.firstDecision, 0, 0, total_frames);
+        });
+
+        static const bool prohibits[FieldConstant::MAP_WIDTH] {};
+        batchMaxChains.resize(batchFields.size());
+        RensaDetector::detectMaxChainsByDropStrategy(batchFields.data(), batchFields.size(), prohibits,
+                                                     PurposeForFindingRensa::FOR_FIRE, 2, 13,
+                                                     &scratch, batchMaxChains.data());
+        for (size_t i = 0; i < batchIndices.size(); ++i) {
+            State& state = children[batchIndices[i]];
+            state.maxChains = batchMaxChains[i];
+            state.stateScore = evalSuperLight(batchFields[i], batchMaxChains[i]);
         }
-    }
 
-    double endTime = currentTime();
-
-    if (false) {
-        lock_guard<mutex> lock(mu);
-        if (!currentStates.empty()) {
-            cout << "FIRED_CHAINS=" << maxOverallFiredChains
-                 << " FIRED_SCORE=" << maxOverallFiredScore
-                 << " DECISION=" << currentStates.front().firstDecision
-                 << " TIME=" << (endTime - beginTime)
-                 << " TURN4_TIME=" << (time[4] - beginTime)
-                 << " TURN5_TIME=" << (time[5] - beginTime)
-                 << " TURN6_TIME=" << (time[6] - beginTime) << endl;
-
-        } else {
-            cout << "EMPTY!" << endl;
-            result.maxChains = -1;
-            return result;
+        for (State& state : children) {
+            uint64_t hash = state.field.hash();
+            emitter->emit(std::move(state), hash);
         }
-    }
+    };
 
-    result.maxChains = maxOverallFiredChains;
-    result.firstDecisions.insert(currentStates.front().firstDecision);
-    return result;
+    search.reset(parent.states);
+    child->stopped = !search.step(turn, expand);
+    child->states = search.states();
+    child->maxFiredChains = maxFiredChains;
+    return search.stats().numExpanded;
 }
 
 } // anonymous namespace
@@ -213,6 +178,8 @@ SearchResult run(const std::vector<State>& initialStates, KumipuyoSeq seq, int m
 DropDecision BeamThinker::think(int /*frameId*/, const CoreField& field, const KumipuyoSeq& seq,
                                 const PlayerState& /*me*/, const PlayerState& /*enemy*/, bool /*fast*/) const
 {
+    double beginTime = currentTime();
+
     // If large enough, fire.
     if (true) {
         Decision tmpd;
@@ -249,35 +216,35 @@ DropDecision BeamThinker::think(int /*frameId*/, const CoreField& field, const K
         });
     }
 
-    WaitGroup wg;
-    std::mutex mu;
-
     const int maxSearchTurns = std::min(FLAGS_beam_depth, (78 - field.countPuyos()) / 2 + 4);
 #if 0
     cout << "maxSearchTurns = " << maxSearchTurns << endl;
 #endif
 
-    for (int k = 0; k < FLAGS_beam_num; ++k) {
-        wg.add(1);
-
-        executor_->submit([&]() {
-            KumipuyoSeq tmpSeq(seq.subsequence(2));
-            tmpSeq.append(KumipuyoSeqGenerator::generateRandomSequence(40));
-
-            SearchResult searchResult = run(nextStates, tmpSeq, maxSearchTurns, mu_);
-
-            {
-                lock_guard<mutex> lk(mu);
-                for (const auto& d : searchResult.firstDecisions) {
-                    score[d] += searchResult.maxChains;
-                }
-            }
-            // wg.done() should be called after releasing mu, because of deadlock.
-            wg.done();
-        });
+    // The kumipuyos of the rollouts from the 3rd turn. The known kumipuyos are followed by
+    // random ones, so the rollouts share the layers until their random kumipuyos diverge.
+    std::vector<std::vector<Kumipuyo>> rollouts(FLAGS_beam_num);
+    for (auto& kumipuyos : rollouts) {
+        KumipuyoSeq tmpSeq(seq.subsequence(2));
+        tmpSeq.append(KumipuyoSeqGenerator::generateRandomSequence(40));
+        for (int turn = 3; turn < maxSearchTurns; ++turn)
+            kumipuyos.push_back(tmpSeq.get(turn - 3));
     }
 
-    wg.waitUntilDone();
+    BeamLayer root;
+    root.states = std::move(nextStates);
+
+    std::mutex mu;
+    RolloutScheduler<BeamLayer, Kumipuyo> scheduler(executor_);
+    auto step = [](int depth, const BeamLayer& parent, const Kumipuyo& kumipuyo, BeamLayer* child) {
+        return expandLayer(depth + 3, parent, kumipuyo, child);
+    };
+    scheduler.run(std::move(root), rollouts, step, [&](int /*rollout*/, const BeamLayer& leaf) {
+        if (leaf.states.empty())
+            return;
+        lock_guard<mutex> lk(mu);
+        score[leaf.states.front().firstDecision] += leaf.maxFiredChains;
+    });
 
     Decision d;
     int s = 0;
@@ -288,5 +255,12 @@ DropDecision BeamThinker::think(int /*frameId*/, const CoreField& field, const K
         }
     }
 
-    return DropDecision(d, "BY BEAM");
+    const RolloutSchedulerStats& stats = scheduler.stats();
+    std::ostringstream ss;
+    ss << "BY BEAM"
+       << " TIME=" << static_cast<int>((currentTime() - beginTime) * 1000) << "[ms]"
+       << " STATES=" << stats.cost
+       << " SAVED=" << stats.savedCost()
+       << " FORKS=" << stats.numForks;
+    return DropDecision(d, ss.str());
 }
@@ -0,0 +1,65 @@
+// compile_books compiles TOML books into binary images, which are loaded
+// without parsing when they're up to date. See base/file/binary_image.h.
+//
+// Usage: compile_books <pattern|decision|feature> <book.toml>...
+// The image of foo.toml is saved as foo.toml.bin.
+
+#include <iostream>
+#include <string>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "base/file/binary_image.h"
+#include "core/pattern/decision_book.h"
+#include "core/pattern/pattern_book.h"
+
+#include "evaluation_parameter.h"
+
+using namespace std;
+
+namespace {
+
+bool compile(const string& kind, const string& filename)
+{
+    if (kind == "pattern") {
+        PatternBook book;
+        return book.load(filename) && book.saveImage(filename);
+    }
+    if (kind == "decision") {
+        DecisionBook book;
+        return book.load(filename) && book.saveImage(filename);
+    }
+    if (kind == "feature") {
+        EvaluationParameterMap paramMap;
+        return paramMap.load(filename) && paramMap.saveImage(filename);
+    }
+
+    LOG(ERROR) << "Unknown kind: " << kind;
+    return false;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <pattern|decision|feature> <book.toml>..." << endl;
+        return 1;
+    }
+
+    bool ok = true;
+    for (int i = 2; i < argc; ++i) {
+        if (compile(argv[1], argv[i])) {
+            cout << argv[i] << " -> " << file::binaryImagePath(argv[i]) << endl;
+        } else {
+            cerr << "Failed to compile " << argv[i] << endl;
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -6,16 +6,41 @@
 #include <algorithm>
 #include <fstream>
 #include <set>
+#include <sstream>
 #include <vector>
 
 #include <cstddef>
 #include <exception>
 #include <utility>
 
+#include "base/file/binary_image.h"
 #include "cpu/mayah/evaluation_feature.h"
 
 using namespace std;
 
+namespace {
+
+const uint32_t IMAGE_KIND = 0x4D524150; // "PARM"
+const uint32_t IMAGE_VERSION = 2;
+
+// Returns a hash of the names and the sizes of all the features.
+// When evaluation_feature.tab is modified, the images made before become stale.
+uint64_t featureLayoutHash()
+{
+    stringstream ss;
+    for (const auto& ef : EvaluationMoveFeatureSet::features())
+        ss << ef.name() << ',';
+    for (const auto& ef : EvaluationMoveFeatureSet::sparseFeatures())
+        ss << ef.name() << ':' << ef.size() << ',';
+    for (const auto& ef : EvaluationRensaFeatureSet::features())
+        ss << ef.name() << ',';
+    for (const auto& ef : EvaluationRensaFeatureSet::sparseFeatures())
+        ss << ef.name() << ':' << ef.size() << ',';
+    return file::hashContent(ss.str());
+}
+
+} // anonymous namespace
+
 bool EvaluationParameterMap::load(const string& filename)
 {
     try {
@@ -50,6 +75,51 @@ bool EvaluationParameterMap::save(const string& filename) const
     return true;
 }
 
+bool EvaluationParameterMap::loadWithImage(const string& filename)
+{
+    if (loadImage(filename))
+        return true;
+
+    LOG(INFO) << "No up-to-date image for " << filename << ". Parsing it.";
+    return load(filename);
+}
+
+bool EvaluationParameterMap::loadImage(const string& sourceFilename)
+{
+    file::BinaryImageReader reader;
+    if (!reader.open(file::binaryImagePath(sourceFilename), IMAGE_KIND, IMAGE_VERSION, file::hashFileContent(sourceFilename)))
+        return false;
+
+    uint64_t layoutHash;
+    if (!reader.read(&layoutHash) || layoutHash != featureLayoutHash()) {
+        LOG(INFO) << file::binaryImagePath(sourceFilename) << " was made with different features";
+        return false;
+    }
+
+    // Reads into a temporary map, so that a broken image doesn't leave a half-loaded map.
+    EvaluationParameterMap m;
+    if (!m.moveParamSet_.readFrom(&reader) ||
+        !m.mainRensaParamSet_.readFrom(&reader) ||
+        !m.sideRensaParamSet_.readFrom(&reader) ||
+        !reader.isEnd()) {
+        LOG(WARNING) << "broken image: " << file::binaryImagePath(sourceFilename);
+        return false;
+    }
+
+    *this = m;
+    return true;
+}
+
+bool EvaluationParameterMap::saveImage(const string& sourceFilename) const
+{
+    file::BinaryImageWriter writer(IMAGE_KIND, IMAGE_VERSION, file::hashFileContent(sourceFilename));
+    writer.write(featureLayoutHash());
+    moveParamSet_.writeTo(&writer);
+    mainRensaParamSet_.writeTo(&writer);
+    sideRensaParamSet_.writeTo(&writer);
+    return writer.save(file::binaryImagePath(sourceFilename));
+}
+
 bool EvaluationParameterMap::loadValue(const toml::Value& v)
 {
     // Check v has only |mode| key
@@ -12,6 +12,7 @@
 #include <toml/toml.h>
 
 #include "base/base.h"
+#include "base/file/binary_image.h"
 #include "evaluation_feature.h"
 #include "evaluation_mode.h"
 
@@ -170,6 +171,41 @@ public:
         return true;
     }
 
+    void writeTo(file::BinaryImageWriter* writer) const
+    {
+        writer->writeArray(param_);
+        writer->writeArray(std::vector<std::uint8_t>(hasParam_.begin(), hasParam_.end()));
+        for (const auto& p : sparseParam_)
+            writer->writeArray(p);
+        writer->writeArray(std::vector<std::uint8_t>(hasSparseParam_.begin(), hasSparseParam_.end()));
+    }
+
+    // Returns false if the image doesn't have the same feature sizes as this.
+    bool readFrom(file::BinaryImageReader* reader)
+    {
+        std::vector<double> param;
+        std::vector<std::uint8_t> hasParam;
+        if (!reader->readArray(&param) || param.size() != param_.size())
+            return false;
+        if (!reader->readArray(&hasParam) || hasParam.size() != hasParam_.size())
+            return false;
+        param_ = std::move(param);
+        hasParam_.assign(hasParam.begin(), hasParam.end());
+
+        for (auto& p : sparseParam_) {
+            std::vector<double> sparseParam;
+            if (!reader->readArray(&sparseParam) || sparseParam.size() != p.size())
+                return false;
+            p = std::move(sparseParam);
+        }
+
+        std::vector<std::uint8_t> hasSparseParam;
+        if (!reader->readArray(&hasSparseParam) || hasSparseParam.size() != hasSparseParam_.size())
+            return false;
+        hasSparseParam_.assign(hasSparseParam.begin(), hasSparseParam.end());
+        return true;
+    }
+
     void clear()
     {
         std::fill(param_.begin(), param_.end(), 0.0);
@@ -248,6 +284,24 @@ public:
         }
     }
 
+    void writeTo(file::BinaryImageWriter* writer) const
+    {
+        defaultParam_.writeTo(writer);
+        for (const auto& param : params_)
+            param.writeTo(writer);
+    }
+
+    bool readFrom(file::BinaryImageReader* reader)
+    {
+        if (!defaultParam_.readFrom(reader))
+            return false;
+        for (auto& param : params_) {
+            if (!param.readFrom(reader))
+                return false;
+        }
+        return true;
+    }
+
     toml::Value toTomlValue(const std::string& anotherKey) const
     {
         toml::Value value;
@@ -329,10 +383,18 @@ public:
     bool load(const std::string& filename);
     bool save(const std::string& filename) const;
 
+    // Loads the binary image compiled from |filename| if it's up to date.
+    // Otherwise, |filename| is parsed. See base/file/binary_image.h.
+    bool loadWithImage(const std::string& filename);
+    // Saves this map as an image of |sourceFilename|.
+    bool saveImage(const std::string& sourceFilename) const;
+
     // For interactive UI.
     void removeNontokopuyoParameter();
 
 private:
+    bool loadImage(const std::string& sourceFilename);
+
     EvaluationMoveParameterSet moveParamSet_;
     EvaluationRensaParameterSet mainRensaParamSet_;
     EvaluationRensaParameterSet sideRensaParamSet_;
@@ -414,6 +414,9 @@ void Evaluator<ScoreCollector>::eval(const RefPlan& plan,
     RensaDetector::detectSideChain(fieldBeforeRensa, RensaDetectorStrategy::defaultDropStrategy(),
                                    [&](CoreField&& cf, const ColumnPuyoList& cpl) {
         // TODO(mayah): fireColor is not PuyoColor::EMPTY.
+        // The results are not cached. About half of the side chain fields repeat in a search,
+        // but simulate() is as fast as a cache lookup: for the 25k side chain fields of
+        // the depth 2 plans, a per-thread cache took 6.0-6.8M cycles, and simulate() 5.4M.
         RensaResult rensaResult = cf.simulate();
         evalCallback(cf, rensaResult, cpl, PuyoColor::EMPTY, string(), 0.0);
     });
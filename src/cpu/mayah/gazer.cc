@@ -7,6 +7,8 @@
 
 #include <glog/logging.h>
 
+#include "base/executor.h"
+#include "base/time.h"
 #include "core/plan/plan.h"
 #include "core/rensa/rensa_detector.h"
 #include "core/field_checker.h"
@@ -163,18 +165,95 @@ string GazeResult::toRensaInfoString() const
 
 // ----------------------------------------------------------------------
 
+Gazer::Gazer(Executor* executor) :
+    executor_(executor),
+    requestedVersion_(0)
+{
+}
+
+Gazer::~Gazer()
+{
+    // Cancels the pending gazes, and waits for them since they refer to |this|.
+    ++requestedVersion_;
+    waitGroup_.waitUntilDone();
+}
+
 void Gazer::initialize(int frameIdGameWillBegin)
 {
+    int version = ++requestedVersion_;
+
+    lock_guard<mutex> lock(mu_);
     gazeResult_.reset(frameIdGameWillBegin, 72);
+    publishedVersion_ = version;
+    condVar_.notify_all();
 }
 
 void Gazer::gaze(int frameId, const CoreField& originalField, const KumipuyoSeq& kumipuyoSeq)
+{
+    int version = ++requestedVersion_;
+    if (!executor_) {
+        runGaze(version, frameId, originalField, kumipuyoSeq);
+        return;
+    }
+
+    waitGroup_.add(1);
+    executor_->submit([this, version, frameId, originalField, kumipuyoSeq]() {
+        runGaze(version, frameId, originalField, kumipuyoSeq);
+        waitGroup_.done();
+    });
+}
+
+GazeResult Gazer::gazeResult(bool waitsForPendingGaze) const
+{
+    unique_lock<mutex> lock(mu_);
+    if (waitsForPendingGaze && publishedVersion_ != requestedVersion_) {
+        double beginTime = currentTime();
+        condVar_.wait(lock, [this]() { return publishedVersion_ == requestedVersion_; });
+        stats_.totalWaitMillis += (currentTime() - beginTime) * 1000;
+    }
+    return gazeResult_;
+}
+
+GazeStats Gazer::stats() const
+{
+    lock_guard<mutex> lock(mu_);
+    return stats_;
+}
+
+void Gazer::runGaze(int version, int frameId, const CoreField& originalField, const KumipuyoSeq& kumipuyoSeq)
+{
+    auto isCancelled = [this, version]() { return version != requestedVersion_; };
+
+    double beginTime = currentTime();
+    GazeResult result;
+    bool finished = !isCancelled() && gazeInternal(frameId, originalField, kumipuyoSeq, isCancelled, &result);
+    double gazeMillis = (currentTime() - beginTime) * 1000;
+
+    lock_guard<mutex> lock(mu_);
+    if (!finished || isCancelled()) {
+        ++stats_.numCancelled;
+        LOG(INFO) << "Gaze cancelled: frame_id=" << frameId;
+        return;
+    }
+
+    gazeResult_ = std::move(result);
+    publishedVersion_ = version;
+    ++stats_.numFinished;
+    stats_.totalGazeMillis += gazeMillis;
+    stats_.maxGazeMillis = std::max(stats_.maxGazeMillis, gazeMillis);
+    LOG(INFO) << "Gaze done: frame_id=" << frameId << " in " << gazeMillis << " [ms]";
+    condVar_.notify_all();
+}
+
+// static
+bool Gazer::gazeInternal(int frameId, const CoreField& originalField, const KumipuyoSeq& kumipuyoSeq,
+                         const std::function<bool ()>& isCancelled, GazeResult* result)
 {
     LOG(INFO) << "Gaze: frame_id=" << frameId << "\n"
               << originalField.toDebugString() << "\nSeq: " << kumipuyoSeq.toString();
 
     int numReachableSpaces = originalField.countConnectedPuyos(3, 12);
-    gazeResult_.reset(frameId, numReachableSpaces);
+    result->reset(frameId, numReachableSpaces);
 
     // FeasibleRensaHandTree.
     {
@@ -209,13 +288,17 @@ void Gazer::gaze(int frameId, const CoreField& originalField, const KumipuyoSeq&
 
         RensaHandTree tree = RensaHandTree(std::vector<RensaHandNode> { maker.makeNode() });
         LOG(INFO) << "Feasible: " << endl << tree.toString();
-        gazeResult_.setFeasibleRensaHandTree(std::move(tree));
+        result->setFeasibleRensaHandTree(std::move(tree));
     }
 
+    if (isCancelled())
+        return false;
+
     // PossibleRensaHandTree.
     // We'd like make the depth 3, but eval() gets really slow (2~3 ms each hand.)
     RensaHandTree tree = RensaHandTree::makeTree(2, originalField, PuyoSet(), 0, kumipuyoSeq);
     LOG(INFO) << "Possible:" << endl << tree.toString();
 
-    gazeResult_.setPossibleRensaHandTree(std::move(tree));
+    result->setPossibleRensaHandTree(std::move(tree));
+    return true;
 }
@@ -1,16 +1,22 @@
 #ifndef CPU_MAYAH_GAZER_H_
 #define CPU_MAYAH_GAZER_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "base/noncopyable.h"
+#include "base/wait_group.h"
 #include "core/client/ai/ai.h"
 #include "core/probability/puyo_set.h"
 
 #include "rensa_hand_tree.h"
 
+class Executor;
 class KumipuyoSeq;
 
 class GazeResult {
@@ -44,14 +50,52 @@ private:
     RensaHandTree possibleRensaHandTree_;
 };
 
+// Timing metrics of Gazer. Times are in milliseconds.
+struct GazeStats {
+    int numFinished = 0;
+    int numCancelled = 0;
+    double totalGazeMillis = 0;
+    double maxGazeMillis = 0;
+    // Time think() has spent waiting for a pending gaze.
+    double totalWaitMillis = 0;
+};
+
+// Gazer gazes the enemy's field.
+// If an executor is given, gaze() only requests gazing, and the work is done on the executor.
+// Each request has a version. When a newer request arrives, the older requests are cancelled
+// (queued ones are skipped, and running ones are abandoned between the feasible and possible
+// phases), and only the result of the latest request is published.
+// The executor should not be shared with think(), otherwise gazing delays thinking.
 class Gazer : noncopyable {
 public:
+    explicit Gazer(Executor* executor = nullptr);
+    ~Gazer();
+
     void initialize(int frameIdGameWillBegin);
     void gaze(int frameId, const CoreField&, const KumipuyoSeq&);
 
-    const GazeResult& gazeResult() const { return gazeResult_; }
+    // Returns a snapshot of the latest published gaze result.
+    // If |waitsForPendingGaze| is true, waits for the latest requested gaze to be published.
+    // Use false in fast mode so that gazing never delays think().
+    GazeResult gazeResult(bool waitsForPendingGaze = true) const;
+
+    GazeStats stats() const;
+
 private:
+    // Computes the gaze result. Returns false if |isCancelled| becomes true on the way.
+    static bool gazeInternal(int frameId, const CoreField&, const KumipuyoSeq&,
+                             const std::function<bool ()>& isCancelled, GazeResult*);
+    void runGaze(int version, int frameId, const CoreField&, const KumipuyoSeq&);
+
+    Executor* executor_;
+    WaitGroup waitGroup_;
+
+    std::atomic<int> requestedVersion_;
+    mutable std::mutex mu_;
+    mutable std::condition_variable condVar_;
+    int publishedVersion_ = 0;
     GazeResult gazeResult_;
+    mutable GazeStats stats_;
 };
 
 #endif // CPU_MAYAH_GAZER_H_
@@ -3,6 +3,7 @@
 #include <memory>
 #include <gtest/gtest.h>
 
+#include "base/executor.h"
 #include "core/kumipuyo_seq.h"
 #include "core/probability/puyo_set_probability.h"
 
@@ -79,3 +80,29 @@ TEST_F(GazerTest, estimateMaxScoreUsingRensaIsOngoing)
     EXPECT_EQ(36840, gazeResult.estimateMaxScore(300, enemy)) << gazeResult.toRensaInfoString();
     EXPECT_EQ(36840, gazeResult.estimateMaxScore(400, enemy)) << gazeResult.toRensaInfoString();
 }
+
+TEST(GazerAsyncTest, latestResultIsPublished)
+{
+    CoreField f(
+        "BRBG  "
+        "BBRBBB"
+        "RRYGGG");
+    KumipuyoSeq seq("BYRRGG");
+
+    Executor executor(1);
+    executor.start();
+
+    Gazer gazer(&executor);
+    gazer.initialize(100);
+    gazer.gaze(50, CoreField(), seq);
+    gazer.gaze(100, f, seq);
+
+    GazeResult gazeResult = gazer.gazeResult();
+    EXPECT_EQ(100, gazeResult.frameIdToStartNextMove());
+    EXPECT_EQ(2280, gazeResult.estimateMaxScore(100, PlayerState())) << gazeResult.toRensaInfoString();
+
+    // The first request is published only if it has finished before the second one arrives.
+    GazeStats stats = gazer.stats();
+    EXPECT_EQ(2, stats.numFinished + stats.numCancelled);
+    EXPECT_LE(1, stats.numFinished);
+}
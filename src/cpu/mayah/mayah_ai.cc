@@ -39,7 +39,7 @@ MayahAI::~MayahAI()
 DropDecision MayahAI::think(int frame_id, const CoreField& f, const KumipuyoSeq& kumipuyo_seq,
                             const PlayerState& me, const PlayerState& enemy, bool fast) const
 {
-    return pattern_thinker_->think(frame_id, f, kumipuyo_seq, me, enemy, gazer_.gazeResult(), fast,
+    return pattern_thinker_->think(frame_id, f, kumipuyo_seq, me, enemy, gazer_.gazeResult(!fast), fast,
                                    usesDecisionBook_, usesRensaHandTree_);
 }
 
@@ -48,7 +48,7 @@ ThoughtResult MayahAI::thinkPlan(int frameId, const CoreField& cf, const Kumipuy
                                  int depth, int maxIteration, bool fast,
                                  std::vector<Decision>* specifiedDecisions) const
 {
-    return pattern_thinker_->thinkPlan(frameId, cf, seq, me, enemy, depth, maxIteration, gazer_.gazeResult(), fast,
+    return pattern_thinker_->thinkPlan(frameId, cf, seq, me, enemy, depth, maxIteration, gazer_.gazeResult(!fast), fast,
                                        usesDecisionBook_, usesRensaHandTree_, specifiedDecisions);
 }
 
@@ -1,15 +1,25 @@
+#include <stdlib.h>
+#include <unistd.h>
+
 #include <iostream>
 
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
 
+#include "base/file/binary_image.h"
+#include "base/file/file.h"
+#include "base/file/path.h"
+#include "base/time.h"
 #include "base/time_stamp_counter.h"
 #include "core/plan/plan.h"
 #include "core/core_field.h"
 #include "core/frame_request.h"
 #include "core/kumipuyo_seq.h"
+#include "core/pattern/decision_book.h"
+#include "core/pattern/pattern_book.h"
 #include "core/probability/puyo_set_probability.h"
 
+#include "evaluation_parameter.h"
 #include "mayah_ai.h"
 #include "pattern_thinker.h"
 
@@ -236,6 +246,48 @@ TEST(MayahAIPerformanceTest, slow_pattern_from_real_6)
     runTest(PatternThinker::DEFAULT_DEPTH, PatternThinker::DEFAULT_NUM_ITERATION, cf, seq);
 }
 
+TEST(MayahAIPerformanceTest, loadBooks)
+{
+    // The books are copied to a temporary directory, so that images are not made in the source tree.
+    char dir[] = "/tmp/mayah_books_XXXXXX";
+    ASSERT_TRUE(mkdtemp(dir) != nullptr);
+
+    const string names[] = { "feature.toml", "decision.toml", "pattern.toml" };
+    string paths[3];
+    for (int i = 0; i < 3; ++i) {
+        paths[i] = file::joinPath(dir, names[i]);
+        ASSERT_TRUE(file::copyFile(file::joinPath(SRC_DIR, "cpu/mayah", names[i]), paths[i]));
+    }
+
+    for (bool usesImage : { false, true }) {
+        if (usesImage) {
+            EvaluationParameterMap paramMap;
+            DecisionBook decisionBook;
+            PatternBook patternBook;
+            ASSERT_TRUE(paramMap.load(paths[0]) && paramMap.saveImage(paths[0]));
+            ASSERT_TRUE(decisionBook.load(paths[1]) && decisionBook.saveImage(paths[1]));
+            ASSERT_TRUE(patternBook.load(paths[2]) && patternBook.saveImage(paths[2]));
+        }
+
+        double beginTime = currentTime();
+        EvaluationParameterMap paramMap;
+        DecisionBook decisionBook;
+        PatternBook patternBook;
+        ASSERT_TRUE(paramMap.loadWithImage(paths[0]));
+        ASSERT_TRUE(decisionBook.loadWithImage(paths[1]));
+        ASSERT_TRUE(patternBook.loadWithImage(paths[2]));
+        double endTime = currentTime();
+
+        cout << (usesImage ? "image: " : "toml: ") << (endTime - beginTime) * 1000 << " [ms]" << endl;
+    }
+
+    for (const auto& path : paths) {
+        EXPECT_TRUE(file::remove(path));
+        EXPECT_TRUE(file::remove(file::binaryImagePath(path)));
+    }
+    EXPECT_EQ(0, rmdir(dir));
+}
+
 int main(int argc, char* argv[])
 {
     google::InitGoogleLogging(argv[0]);
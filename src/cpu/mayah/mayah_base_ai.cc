@@ -1,6 +1,7 @@
 #include "mayah_base_ai.h"
 
 #include "base/file/path.h"
+#include "base/time.h"
 #include "core/frame_request.h"
 
 DEFINE_string(feature, SRC_DIR "/cpu/mayah/feature.toml", "the path to feature parameter");
@@ -8,13 +9,22 @@ DEFINE_string(decision_book, SRC_DIR "/cpu/mayah/decision.toml", "the path to de
 DEFINE_string(pattern_book, SRC_DIR "/cpu/mayah/pattern.toml", "the path to pattern book");
 
 DEFINE_bool(from_wrapper, false, "Make this true in wrapper script.");
+DEFINE_bool(use_book_image, true, "Load the binary images made by compile_books if they're up to date.");
+DEFINE_bool(async_gaze, true, "Gaze the enemy in a background thread.");
 
 using namespace std;
 
 MayahBaseAI::MayahBaseAI(int argc, char* argv[], const char* name, std::unique_ptr<Executor> executor) :
     AI(argc, argv, name),
-    executor_(std::move(executor))
+    executor_(std::move(executor)),
+    gazeExecutor_(FLAGS_async_gaze ? new Executor(1) : nullptr),
+    gazer_(gazeExecutor_.get())
 {
+    if (gazeExecutor_)
+        gazeExecutor_->start();
+
+    double beginTime = currentTime();
+
     loadEvaluationParameter();
 
     string decision_book_path;
@@ -33,14 +43,23 @@ MayahBaseAI::MayahBaseAI(int argc, char* argv[], const char* name, std::unique_p
 
     LOG(INFO) << "decision_book_path=" << decision_book_path;
     CHECK(!decision_book_path.empty()) << "decision_book_path should not be empty";
-    CHECK(decisionBook_.load(decision_book_path)) << "failed to load decision book";
+    if (FLAGS_use_book_image)
+        CHECK(decisionBook_.loadWithImage(decision_book_path)) << "failed to load decision book";
+    else
+        CHECK(decisionBook_.load(decision_book_path)) << "failed to load decision book";
     LOG(INFO) << "decision_book load done";
 
     LOG(INFO) << "pattern_book_path=" << pattern_book_path;
     CHECK(!pattern_book_path.empty()) << "pattern_book_path should not be empty";
-    CHECK(patternBook_.load(pattern_book_path)) << "failed to load pattern book";
+    if (FLAGS_use_book_image)
+        CHECK(patternBook_.loadWithImage(pattern_book_path)) << "failed to load pattern book";
+    else
+        CHECK(patternBook_.load(pattern_book_path)) << "failed to load pattern book";
     LOG(INFO) << "pattern_book load done";
 
+    double endTime = currentTime();
+    LOG(INFO) << "books loaded in " << (endTime - beginTime) * 1000 << " [ms]";
+
     VLOG(1) << evaluationParameterMap_.toString();
 
     beam_thinker_.reset(new BeamThinker(executor_.get()));
@@ -65,6 +84,8 @@ bool MayahBaseAI::loadEvaluationParameter()
         feature_path = file::joinPath(SRC_DIR, FLAGS_feature);
     }
 
+    if (FLAGS_use_book_image)
+        return evaluationParameterMap_.loadWithImage(feature_path);
     return evaluationParameterMap_.load(feature_path);
 }
 
@@ -36,6 +36,8 @@ protected:
     DecisionBook decisionBook_;
     PatternBook patternBook_;
     std::unique_ptr<Executor> executor_;
+    // Gazer has its own executor so that gazing doesn't occupy the threads of think().
+    std::unique_ptr<Executor> gazeExecutor_;
 
     std::unique_ptr<BeamThinker> beam_thinker_;
     std::unique_ptr<PatternThinker> pattern_thinker_;
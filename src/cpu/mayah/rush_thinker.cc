@@ -189,8 +189,9 @@ SearchState RushThinker::search(
     init_state.features[2] = std::numeric_limits<int>::min();
 
     q_states[0].push_back(init_state);
+    FlatHashSet visited;
     for (int t = 0; t < search_turns; ++t) {
-        std::unordered_set<std::uint64_t> visited;
+        visited.clear();
         const auto& que = q_states[t];
         std::vector<SearchState>& next_states = q_states[t + 1];
         for (size_t i = 0; i < que.size(); ++i)
@@ -228,14 +229,14 @@ SearchState RushThinker::search(
 
 void RushThinker::generateNextStates(
     const SearchState& state, int from, const Kumipuyo& kumi,
-    std::unordered_set<std::uint64_t>& visited, std::vector<SearchState>& states) const {
+    FlatHashSet& visited, std::vector<SearchState>& states) const {
     const RushThinker* th = this;
     auto callback = [&th, &state, &from, &visited, &states](const RefPlan& plan) {
         const CoreField field = plan.field();
         RensaResult result = plan.rensaResult();
 
         std::uint64_t h = field.hash();
-        if (!visited.insert(h).second)
+        if (!visited.insert(h))
             return;
 
         if (plan.isRensaPlan()) {
@@ -2,8 +2,8 @@
 #define CPU_MAYAH_BEAM_RUSH_THINKER_H_
 
 #include <string>
-#include <unordered_set>
 
+#include "base/flat_hash_set.h"
 #include "core/client/ai/ai.h"
 
 struct RensaResult;
@@ -22,7 +22,7 @@ private:
     SearchState search(const CoreField& field, const KumipuyoSeq& vseq, int search_turns) const;
 
     void generateNextStates(const SearchState& state, int from, const Kumipuyo& kumi,
-                            std::unordered_set<std::uint64_t>& visited,
+                            FlatHashSet& visited,
                             std::vector<SearchState>& states) const;
 
     SearchState generateNextRensaState(const CoreField& field, int from, const SearchState& state, const RefPlan& plan) const;
@@ -20,7 +20,7 @@ YukinaAI::YukinaAI(int argc, char* argv[]) :
 DropDecision YukinaAI::think(int frame_id, const CoreField& field, const KumipuyoSeq& kumipuyo_seq,
                              const PlayerState& me, const PlayerState& enemy, bool fast) const
 {
-    const GazeResult& gazeResult = gazer_.gazeResult();
+    const GazeResult gazeResult = gazer_.gazeResult(!fast);
 
     // tsubushi
     if (!enemy.isRensaOngoing()) {
@@ -107,7 +107,7 @@ DropDecision YukinaAI::think(int frame_id, const CoreField& field, const Kumipuy
     // Rethink by pattern_thinker_ with fast=true.
     const bool usesDecisionBook = true;
     const bool usesRensaHandTree = false;
-    return pattern_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, gazer_.gazeResult(), true,
+    return pattern_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, gazeResult, true,
                                    usesDecisionBook, usesRensaHandTree);
 }
 
@@ -122,7 +122,7 @@ DropDecision YukinaAI::thinkByThinker(int frame_id, const CoreField& field, cons
     const bool usesRensaHandTree = !fast;
 
     if (fast) {
-        return pattern_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, gazer_.gazeResult(), fast,
+        return pattern_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, gazer_.gazeResult(!fast), fast,
                                        usesDecisionBook, usesRensaHandTree);
     }
 
@@ -132,12 +132,12 @@ DropDecision YukinaAI::thinkByThinker(int frame_id, const CoreField& field, cons
             return beam_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, fast);
         }
 #endif
-        return pattern_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, gazer_.gazeResult(), fast,
+        return pattern_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, gazer_.gazeResult(!fast), fast,
                                        usesDecisionBook, usesRensaHandTree);
     }
 
     if (field.countPuyos() >= 64) {
-        return pattern_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, gazer_.gazeResult(), fast,
+        return pattern_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, gazer_.gazeResult(!fast), fast,
                                        usesDecisionBook, usesRensaHandTree);
     }
 
@@ -158,7 +158,7 @@ DropDecision YukinaAI::thinkByThinker(int frame_id, const CoreField& field, cons
     }
 
     if (field.countPuyos() <= 24) {
-        return pattern_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, gazer_.gazeResult(), fast,
+        return pattern_thinker_->think(frame_id, field, kumipuyo_seq, me, enemy, gazer_.gazeResult(!fast), fast,
                                        usesDecisionBook, usesRensaHandTree);
     }
 
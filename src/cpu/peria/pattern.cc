@@ -32,7 +32,7 @@ DecisionBook* Pattern::getJoseki() {
   static std::unique_ptr<DecisionBook> s_joseki;
   if (!s_joseki) {
     s_joseki.reset(new DecisionBook());
-    if (!s_joseki->load(FLAGS_joseki_book)) {
+    if (!s_joseki->loadWithImage(FLAGS_joseki_book)) {
       LOG(INFO) << "Failed to load JOSEKI file: " << FLAGS_joseki_book;
     }
   }
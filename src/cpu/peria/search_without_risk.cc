@@ -139,7 +139,7 @@ void SearchWithoutRisk::expand(const SearchState& from, const int index) {
   auto callback = [&self, &from, &index](const RefPlan& plan)
   {
     const CoreField field = plan.field();
-    if (!self->visited_[index + 1].insert(field.hash()).second)
+    if (!self->visited_[index + 1].insert(field.hash()))
       return;
     int frame = from.frame - plan.totalFrames();
     SearchState next;
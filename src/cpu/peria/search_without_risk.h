@@ -2,9 +2,9 @@
 
 #include <cstdint>
 #include <deque>
-#include <unordered_set>
 #include <vector>
 
+#include "base/flat_hash_set.h"
 #include "core/core_field.h"
 #include "core/decision.h"
 #include "core/kumipuyo_seq.h"
@@ -46,7 +46,7 @@ class SearchWithoutRisk {
   int best_score_ = 0;
   Decision best_decision_;
   std::vector<std::deque<SearchState>> states_;
-  std::vector<std::unordered_set<std::uint64_t>> visited_;
+  std::vector<FlatHashSet> visited_;
   KumipuyoSeq seq_;
 
   std::array<std::array<double, 4>, 7> total_score_ {};
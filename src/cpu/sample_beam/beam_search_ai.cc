@@ -10,6 +10,7 @@
 #include <glog/logging.h>
 
 #include "base/base.h"
+#include "base/executor.h"
 #include "base/time.h"
 #include "core/plan/plan.h"
 #include "core/rensa/rensa_detector.h"
@@ -40,6 +41,13 @@ struct SearchState {
   // 2Dub: [0: # of 2dub, 1: # of ojama, 2: expected score]
 };
 
+// Compares the features lexicographically.
+struct BetterState {
+  bool operator()(const SearchState& a, const SearchState& b) const {
+    return a.features > b.features;
+  }
+};
+
 BeamFullAI::BeamFullAI() : BeamSearchAI("Full") {}
 
 bool BeamFullAI::skipRensaPlan(const RensaResult&) const {
@@ -148,6 +156,13 @@ DropDecision Beam2DubAI::think(int frame_id, const CoreField& field, const Kumip
 
 // ===================================================================
 
+BeamSearchAI::BeamSearchAI(const std::string& name) :
+    AI(name),
+    executor_(Executor::makeDefaultExecutor()) {
+}
+
+BeamSearchAI::~BeamSearchAI() {}
+
 DropDecision BeamSearchAI::think(
     int frame_id, const CoreField& field, const KumipuyoSeq& seq,
     const PlayerState&, const PlayerState&, bool) const {
@@ -216,36 +231,33 @@ SearchState BeamSearchAI::search(
   init_state.features[0] = 0;
   init_state.features[1] = 0;
   init_state.features[2] = std::numeric_limits<int>::min();
-
   q_states[0].push_back(init_state);
-  for (int t = 0; t < search_turns; ++t) {
-    std::unordered_set<uint64> visited;
-    const auto& que = q_states[t];
-    std::vector<SearchState>& next_states = q_states[t + 1];
-    for (size_t i = 0; i < que.size(); ++i)
-      generateNextStates(que[i], i, vseq.get(t), visited, next_states);
 
-    if (next_states.empty())
-      break;
-    std::sort(next_states.begin(), next_states.end(),
-              [](const SearchState& a, const SearchState& b) {
-                if (a.features[0] == b.features[0]) {
-                  if (a.features[1] == b.features[1])
-                    return a.features[2] > b.features[2];
-                  return a.features[1] > b.features[1];
-                }
-                return a.features[0] > b.features[0];
-              });
-    if (static_cast<int>(next_states.size()) >= FLAGS_beam_width)
-      next_states.erase(next_states.begin() + FLAGS_beam_width, next_states.end());
-
-    const SearchState best = *next_states.begin();
+  BeamSearchOptions options;
+  options.beamWidth = FLAGS_beam_width;
+  options.executor = executor_.get();
+  BeamSearch<SearchState, BetterState> beam_search(options);
+
+  std::vector<KumipuyoSeq> kumipuyos;
+  for (int t = 0; t < search_turns; ++t)
+    kumipuyos.push_back(KumipuyoSeq{vseq.get(t)});
+
+  auto expand = [this, &kumipuyos](int t, int from, const SearchState& state,
+                                   BeamSearchEmitter<SearchState>* emitter) {
+    generateNextStates(state, from, kumipuyos[t], emitter);
+  };
+  auto on_layer = [&q_states, &search_turns](int t, const std::vector<SearchState>& next_states) {
+    q_states[t + 1] = next_states;
+
+    const SearchState& best = next_states.front();
     if (std::all_of(next_states.begin(), next_states.end(),
-        [&best](const SearchState& s){ return s.decision == best.decision; })) {
+                    [&best](const SearchState& s){ return s.decision == best.decision; })) {
       search_turns = t + 1;
-      break;
+      return false;
     }
-  }
+    return true;
+  };
+  beam_search.run(q_states[0], search_turns, expand, on_layer);
 
 #if RECORD_RANK_LOG
   int bt = 0;
@@ -283,24 +295,22 @@ SearchState BeamSearchAI::search(
 }
 
 void BeamSearchAI::generateNextStates(
-    const SearchState& state, int from, const Kumipuyo& kumi,
-    std::unordered_set<uint64>& visited, std::vector<SearchState>& states) const {
+    const SearchState& state, int from, const KumipuyoSeq& kumi,
+    BeamSearchEmitter<SearchState>* emitter) const {
   const BeamSearchAI* th = this;
-  auto callback = [&th, &state, &from, &visited, &states](const RefPlan& plan) {
-    const CoreField field = plan.field();
+  auto callback = [&th, &state, &from, emitter](const RefPlan& plan) {
+    const CoreField& field = plan.field();
     RensaResult result = plan.rensaResult();
 
     uint64 h = field.hash();
-    if (!visited.insert(h).second)
+    if (!emitter->visit(h))
       return;
 
     if (plan.isRensaPlan()) {
       if (th->skipRensaPlan(result))
         return;
 
-      SearchState next = th->generateNextRensaState(field, from, state, plan);
-      states.push_back(next);
-
+      emitter->emit(th->generateNextRensaState(field, from, state, plan), h);
       return;
     }
 
@@ -315,11 +325,10 @@ void BeamSearchAI::generateNextStates(
                                         PurposeForFindingRensa::FOR_FIRE, 2, 13,
                                         detect_callback);
 
-    SearchState next = th->generateNextNonRensaState(field, from, state, plan, expect);
-    states.push_back(next);
+    emitter->emit(th->generateNextNonRensaState(field, from, state, plan, expect), h);
   };
 
-  Plan::iterateAvailablePlans(state.field, {kumi}, 1, callback);
+  Plan::iterateAvailablePlans(state.field, kumi, 1, callback);
 }
 
 }  // namespace sample
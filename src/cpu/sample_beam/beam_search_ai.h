@@ -4,11 +4,13 @@
 // BeamSearchAI is a skelton AI to implement AIs using beam search algorithm.
 // This file also creates 2 different type AIs ineriting from BeamSearchAI.
 
+#include <memory>
 #include <string>
-#include <unordered_set>
 
 #include "core/client/ai/ai.h"
+#include "core/search/beam_search.h"
 
+class Executor;
 struct RensaResult;
 class RefPlan;
 
@@ -23,8 +25,8 @@ class BeamSearchAI : public AI {
   using uint64 = std::uint64_t;
   using int64 = std::int64_t;
  public:
-  BeamSearchAI(const std::string& name) : AI(name) {}
-  virtual ~BeamSearchAI() {}
+  BeamSearchAI(const std::string& name);
+  virtual ~BeamSearchAI();
 
   virtual DropDecision think(int frame_id, const CoreField& field, const KumipuyoSeq& seq,
                              const PlayerState&, const PlayerState&, bool fast) const;
@@ -32,15 +34,17 @@ class BeamSearchAI : public AI {
  private:
   SearchState search(const CoreField& field, const KumipuyoSeq& vseq, int search_turns) const;
 
-  void generateNextStates(const SearchState& state, int from, const Kumipuyo& kumi,
-                          std::unordered_set<uint64>& visited,
-                          std::vector<SearchState>& states) const;
+  void generateNextStates(const SearchState& state, int from, const KumipuyoSeq& kumi,
+                          BeamSearchEmitter<SearchState>* emitter) const;
 
   // pure virtual methods to change the behavior.
   virtual bool skipRensaPlan(const RensaResult& result) const = 0;
   virtual SearchState generateNextRensaState(const CoreField& field, int from, const SearchState& state, const RefPlan& plan) const = 0;
   virtual SearchState generateNextNonRensaState(const CoreField& field, int from, const SearchState& state, const RefPlan& plan, int expect) const = 0;
   virtual bool shouldUpdateState(const SearchState& orig, const SearchState& res) const = 0;
+
+  // Expands the states of a layer in parallel. Use --num_threads to set the number of threads.
+  std::unique_ptr<Executor> executor_;
 };
 
 // Type specified AIs ------------------------------------------------
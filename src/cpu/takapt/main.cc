@@ -3,6 +3,7 @@
 
 #include "base/base.h"
 #include "base/executor.h"
+#include "base/flat_hash_set.h"
 #include "base/time.h"
 #include "core/plan/plan.h"
 #include "core/rensa/rensa_detector.h"
@@ -17,7 +18,6 @@
 #include <cstdio>
 
 #include <numeric>
-#include <unordered_set>
 #include <unordered_map>
 #include <future>
 
@@ -51,7 +51,7 @@ struct State
     }
 };
 
-void next_states(const State& current_state, const Kumipuyo& kumipuyo, const int good_chains, const int enough_score, unordered_set<int64_t>& visited, int qi, vector<State>& state_q, vector<State>& fired)
+void next_states(const State& current_state, const Kumipuyo& kumipuyo, const int good_chains, const int enough_score, FlatHashSet& visited, int qi, vector<State>& state_q, vector<State>& fired)
 {
     auto drop_callback = [&](const RefPlan& plan)
     {
@@ -60,10 +60,8 @@ void next_states(const State& current_state, const Kumipuyo& kumipuyo, const int
         CoreField field = plan.field();
         RensaResult rensa_result = plan.rensaResult();
 
-        const int64_t field_hash = plan.field().hash();
-        if (visited.count(field_hash))
+        if (!visited.insert(plan.field().hash()))
             return;
-        visited.insert(field_hash);
 
         int frames = current_state.frames + plan.totalFrames() + rensa_result.frames;
         int pending_enemy_score = current_state.pending_enemy_score;
@@ -204,9 +202,10 @@ BeamSearchResult beamsearch(const CoreField& start_field, const KumipuyoSeq& seq
 
     Decision first_decision_for_max_chains;
     int max_chains = 0;
+    FlatHashSet visited;
     for (int turn = 0; turn < turns; ++turn)
     {
-        unordered_set<int64_t> visited;
+        visited.clear();
         state_q[turn + 1].reserve(state_q[turn].size() * 11);
         fired[turn + 1].reserve(state_q[turn].size());
 
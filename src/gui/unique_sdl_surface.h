@@ -1,10 +1,13 @@
 #ifndef GUI_UNIQUE_SURFACE_H_
 #define GUI_UNIQUE_SURFACE_H_
 
+#include <functional>
 #include <memory>
 #include <SDL.h>
 
-typedef std::unique_ptr<SDL_Surface, void (*)(SDL_Surface*)> UniqueSDLSurface;
+// The deleter is std::function so that a surface can be returned to its owner
+// (e.g. a buffer pool) instead of being freed.
+typedef std::unique_ptr<SDL_Surface, std::function<void (SDL_Surface*)>> UniqueSDLSurface;
 
 inline UniqueSDLSurface makeUniqueSDLSurface(SDL_Surface* surface)
 {
@@ -11,7 +11,13 @@
 #include <sstream>
 #include <string>
 
+#include <smmintrin.h>
+
+#include <glog/logging.h>
+
+#include "base/executor.h"
 #include "base/file/file.h"
+#include "base/wait_group.h"
 
 namespace {
 
@@ -25,6 +31,36 @@ inline float d_activator(float x)
     return 1 / std::cosh(x) / std::cosh(x);
 }
 
+// y[i] += a * x[i] for 0 <= i < n.
+inline void addScaled(float a, const float* x, float* y, int n)
+{
+    const __m128 va = _mm_set1_ps(a);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 vy = _mm_loadu_ps(y + i);
+        vy = _mm_add_ps(vy, _mm_mul_ps(va, _mm_loadu_ps(x + i)));
+        _mm_storeu_ps(y + i, vy);
+    }
+    for (; i < n; ++i)
+        y[i] += a * x[i];
+}
+
+// Returns sum of x[i] * y[i] for 0 <= i < n.
+inline float dot(const float* x, const float* y, int n)
+{
+    __m128 sum = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    float result = _mm_cvtss_f32(sum);
+    for (; i < n; ++i)
+        result += x[i] * y[i];
+    return result;
+}
+
 } // namespace
 
 namespace learning {
@@ -71,6 +107,30 @@ MultiLayerPerceptron::BackPropagationIntermediateStorage MultiLayerPerceptron::m
     return error_data;
 }
 
+MultiLayerPerceptron::GradientStorage MultiLayerPerceptron::makeGradientStorage() const
+{
+    GradientStorage gradient;
+    gradient.dw2.reset(new float[hidden_layer_weight_size()]);
+    gradient.dw3.reset(new float[output_layer_weight_size()]);
+    std::fill(gradient.dw2.get(), gradient.dw2.get() + hidden_layer_weight_size(), 0.0);
+    std::fill(gradient.dw3.get(), gradient.dw3.get() + output_layer_weight_size(), 0.0);
+    return gradient;
+}
+
+MultiLayerPerceptron::MiniBatchStorage MultiLayerPerceptron::makeMiniBatchStorage(int num_shards) const
+{
+    CHECK_GT(num_shards, 0);
+
+    MiniBatchStorage storage;
+    for (int i = 0; i < num_shards; ++i) {
+        storage.data.push_back(makeForwadingStorage());
+        storage.error_data.push_back(makeBackpropagationStorage());
+        storage.gradients.push_back(makeGradientStorage());
+    }
+    storage.num_correct.resize(num_shards);
+    return storage;
+}
+
 int MultiLayerPerceptron::hidden_layer_weight_size() const
 {
     return ((num_input_ + 1) * num_hidden_);
@@ -95,48 +155,143 @@ bool MultiLayerPerceptron::train(int correct_label,
                                  float l2_normalization)
 {
     int predicted_label = predict(x, data);
+    calculateError(correct_label, *data, error_data);
 
-    // calculate error.
-    for (int i = 0; i < num_output_; ++i) {
-        if (correct_label == i) {
-            error_data->e3[i] = data->i3[i] - 1;
-        } else {
-            error_data->e3[i] = data->i3[i];
-        }
+    // back propagation
+    for (int i = 0; i < num_hidden_ + 1; ++i) {
+        addScaled(-learning_rate * data->o2[i], error_data->e3.get(), &w3_[i * num_output_], num_output_);
     }
 
-    for (int i = 0; i < num_hidden_; ++i) {
-        float t = 0;
-        for (int j = 0; j < num_output_; ++j) {
-            t += w3_[i * num_output_ + j] * error_data->e3[j];
+    for (int i = 0; i < num_input_ + 1; ++i) {
+        addScaled(-learning_rate * data->o1[i], error_data->e2.get(), &w2_[i * num_hidden_], num_hidden_);
+    }
+
+    // normalization
+    if (l2_normalization != 0.0) {
+        for (int i = 0; i < hidden_layer_weight_size(); ++i) {
+            w2_[i] -= learning_rate * l2_normalization * w2_[i];
+        }
+        for (int i = 0; i < output_layer_weight_size(); ++i) {
+            w3_[i] -= learning_rate * l2_normalization * w3_[i];
         }
-        error_data->e2[i] = t * d_activator(data->i2[i]);
     }
 
-    // back propagation
+    return correct_label == predicted_label;
+}
+
+bool MultiLayerPerceptron::accumulateGradient(int correct_label,
+                                              const float x[],
+                                              ForwardingIntermediateStorage* data,
+                                              BackPropagationIntermediateStorage* error_data,
+                                              GradientStorage* gradient) const
+{
+    int predicted_label = predict(x, data);
+    calculateError(correct_label, *data, error_data);
+
     for (int i = 0; i < num_hidden_ + 1; ++i) {
-        for (int j = 0; j < num_output_; ++j) {
-            w3_[i * num_output_ + j] -= learning_rate * error_data->e3[j] * data->o2[i];
-        }
+        addScaled(data->o2[i], error_data->e3.get(), &gradient->dw3[i * num_output_], num_output_);
     }
 
     for (int i = 0; i < num_input_ + 1; ++i) {
-        for (int j = 0; j < num_hidden_; ++j) {
-            w2_[i * num_hidden_ + j] -= learning_rate * data->o1[i] * error_data->e2[j];
-        }
+        addScaled(data->o1[i], error_data->e2.get(), &gradient->dw2[i * num_hidden_], num_hidden_);
     }
 
+    return correct_label == predicted_label;
+}
+
+void MultiLayerPerceptron::applyGradient(const GradientStorage& gradient,
+                                         int batch_size,
+                                         float learning_rate,
+                                         float l2_normalization)
+{
+    CHECK_GT(batch_size, 0);
+
+    const float rate = learning_rate / batch_size;
+    addScaled(-rate, gradient.dw2.get(), w2_.get(), hidden_layer_weight_size());
+    addScaled(-rate, gradient.dw3.get(), w3_.get(), output_layer_weight_size());
+
     // normalization
     if (l2_normalization != 0.0) {
+        const float decay = 1 - learning_rate * l2_normalization;
         for (int i = 0; i < hidden_layer_weight_size(); ++i) {
-            w2_[i] -= learning_rate * l2_normalization * w2_[i];
+            w2_[i] *= decay;
         }
         for (int i = 0; i < output_layer_weight_size(); ++i) {
-            w3_[i] -= learning_rate * l2_normalization * w3_[i];
+            w3_[i] *= decay;
         }
     }
+}
 
-    return correct_label == predicted_label;
+int MultiLayerPerceptron::trainMiniBatch(int size,
+                                         const int labels[],
+                                         const float* const xs[],
+                                         MiniBatchStorage* storage,
+                                         Executor* executor,
+                                         float learning_rate,
+                                         float l2_normalization)
+{
+    const int num_shards = static_cast<int>(storage->gradients.size());
+    CHECK_GT(num_shards, 0);
+    if (size <= 0)
+        return 0;
+
+    auto runShard = [&](int shard) {
+        GradientStorage* gradient = &storage->gradients[shard];
+        std::fill(gradient->dw2.get(), gradient->dw2.get() + hidden_layer_weight_size(), 0.0);
+        std::fill(gradient->dw3.get(), gradient->dw3.get() + output_layer_weight_size(), 0.0);
+
+        int num_correct = 0;
+        for (int i = shard; i < size; i += num_shards) {
+            if (accumulateGradient(labels[i], xs[i], &storage->data[shard], &storage->error_data[shard], gradient))
+                ++num_correct;
+        }
+        storage->num_correct[shard] = num_correct;
+    };
+
+    if (executor && num_shards > 1) {
+        WaitGroup wg;
+        wg.add(num_shards);
+        for (int shard = 0; shard < num_shards; ++shard) {
+            executor->submit([&, shard]() {
+                runShard(shard);
+                wg.done();
+            });
+        }
+        wg.waitUntilDone();
+    } else {
+        for (int shard = 0; shard < num_shards; ++shard)
+            runShard(shard);
+    }
+
+    // Reduce the gradients into the first shard.
+    GradientStorage* gradient = &storage->gradients[0];
+    int num_correct = storage->num_correct[0];
+    for (int shard = 1; shard < num_shards; ++shard) {
+        addScaled(1, storage->gradients[shard].dw2.get(), gradient->dw2.get(), hidden_layer_weight_size());
+        addScaled(1, storage->gradients[shard].dw3.get(), gradient->dw3.get(), output_layer_weight_size());
+        num_correct += storage->num_correct[shard];
+    }
+
+    applyGradient(*gradient, size, learning_rate, l2_normalization);
+    return num_correct;
+}
+
+void MultiLayerPerceptron::calculateError(int correct_label,
+                                          const ForwardingIntermediateStorage& data,
+                                          BackPropagationIntermediateStorage* error_data) const
+{
+    for (int i = 0; i < num_output_; ++i) {
+        if (correct_label == i) {
+            error_data->e3[i] = data.i3[i] - 1;
+        } else {
+            error_data->e3[i] = data.i3[i];
+        }
+    }
+
+    for (int i = 0; i < num_hidden_; ++i) {
+        float t = dot(&w3_[i * num_output_], error_data->e3.get(), num_output_);
+        error_data->e2[i] = t * d_activator(data.i2[i]);
+    }
 }
 
 void MultiLayerPerceptron::forward(const float x[], ForwardingIntermediateStorage* data) const
@@ -148,9 +303,7 @@ void MultiLayerPerceptron::forward(const float x[], ForwardingIntermediateStorag
 
     std::fill(data->i2.get(), data->i2.get() + num_hidden_, 0.0);
     for (int j = 0; j < num_input_ + 1; ++j) {
-        for (int i = 0; i < num_hidden_; ++i) {
-            data->i2[i] += w2_[j * num_hidden_ + i] * data->o1[j];
-        }
+        addScaled(data->o1[j], &w2_[j * num_hidden_], data->i2.get(), num_hidden_);
     }
 
     for (int i = 0; i < num_hidden_; ++i) {
@@ -160,20 +313,18 @@ void MultiLayerPerceptron::forward(const float x[], ForwardingIntermediateStorag
 
     std::fill(data->i3.get(), data->i3.get() + num_output_, 0.0);
     for (int j = 0; j < num_hidden_ + 1; ++j) {
-        for (int i = 0; i < num_output_; ++i) {
-            data->i3[i] += w3_[j * num_output_ + i] * data->o2[j];
-        }
+        addScaled(data->o2[j], &w3_[j * num_output_], data->i3.get(), num_output_);
     }
 }
 
 void MultiLayerPerceptron::setHiddenLayerParameter(const float values[])
 {
-    memcpy(w2_.get(), values, hidden_layer_weight_size());
+    memcpy(w2_.get(), values, sizeof(float) * hidden_layer_weight_size());
 }
 
 void MultiLayerPerceptron::setOutputLayerParameter(const float values[])
 {
-    memcpy(w3_.get(), values, output_layer_weight_size());
+    memcpy(w3_.get(), values, sizeof(float) * output_layer_weight_size());
 }
 
 bool MultiLayerPerceptron::saveParameterAsCSource(const char* path, const char* prefix) const
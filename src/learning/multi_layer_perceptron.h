@@ -2,11 +2,16 @@
 #define LEARNING_MULTILAYER_PERCEPTRON_H_
 
 #include <memory>
+#include <vector>
+
+class Executor;
 
 namespace learning {
 
 // Defines a 3-layer perceptron.
-// This is not thread-safe.
+// predict() and accumulateGradient() are const, so they can be called from
+// multiple threads as long as each thread uses its own storages.
+// Other methods that update the weights are not thread-safe.
 class MultiLayerPerceptron {
 public:
     struct ForwardingIntermediateStorage {
@@ -19,12 +24,26 @@ public:
         std::unique_ptr<float[]> e2; // hidden layer error
         std::unique_ptr<float[]> e3; // output layer error
     };
+    struct GradientStorage {
+        std::unique_ptr<float[]> dw2; // hidden layer weight gradient
+        std::unique_ptr<float[]> dw3; // output layer weight gradient
+    };
+    // Storages used in trainMiniBatch(). Each shard has its own storages,
+    // so the shards can be processed in parallel.
+    struct MiniBatchStorage {
+        std::vector<ForwardingIntermediateStorage> data;
+        std::vector<BackPropagationIntermediateStorage> error_data;
+        std::vector<GradientStorage> gradients;
+        std::vector<int> num_correct;
+    };
 
     MultiLayerPerceptron(int in, int hid, int out);
     ~MultiLayerPerceptron();
 
     ForwardingIntermediateStorage makeForwadingStorage() const;
     BackPropagationIntermediateStorage makeBackpropagationStorage() const;
+    GradientStorage makeGradientStorage() const;
+    MiniBatchStorage makeMiniBatchStorage(int num_shards) const;
 
     // Returns the label.
     // |x| should have |num_input_| size.
@@ -39,6 +58,32 @@ public:
                float learning_rate = 0.1,
                float l2_normalization = 0.001);
 
+    // Adds the gradient of single data to |gradient|. The weights are not updated.
+    // Returns true if the prediction for |x| was correct.
+    bool accumulateGradient(int correct_label,
+                            const float x[],
+                            ForwardingIntermediateStorage* data,
+                            BackPropagationIntermediateStorage* error_data,
+                            GradientStorage* gradient) const;
+
+    // Updates the weights with |gradient| averaged over |batch_size| data.
+    void applyGradient(const GradientStorage& gradient,
+                       int batch_size,
+                       float learning_rate = 0.1,
+                       float l2_normalization = 0.001);
+
+    // Trains |size| data at once. |xs[i]| should have |num_input_| size, and its label is |labels[i]|.
+    // The batch is split into the shards of |storage|. When |executor| is not null,
+    // the shards are processed on |executor|, and their gradients are reduced after that.
+    // Returns the number of data that were predicted correctly before the update.
+    int trainMiniBatch(int size,
+                       const int labels[],
+                       const float* const xs[],
+                       MiniBatchStorage* storage,
+                       Executor* executor = nullptr,
+                       float learning_rate = 0.1,
+                       float l2_normalization = 0.001);
+
     void setHiddenLayerParameter(const float values[]);
     void setOutputLayerParameter(const float values[]);
 
@@ -49,6 +94,10 @@ private:
     int output_layer_weight_size() const;
 
     void forward(const float x[], ForwardingIntermediateStorage* data) const;
+    // Calculates the errors of the output and hidden layers from the result of forward().
+    void calculateError(int correct_label,
+                        const ForwardingIntermediateStorage& data,
+                        BackPropagationIntermediateStorage* error_data) const;
 
     const int num_input_;  // the number of input layer neuron.
     const int num_hidden_; // the number of hidden layer nueron.
@@ -0,0 +1,116 @@
+#include "learning/multi_layer_perceptron.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/executor.h"
+#include "base/time.h"
+
+using namespace std;
+
+namespace learning {
+
+namespace {
+
+// The same size as the MultiLayerPerceptron used in tool/arow.cc.
+const int NUM_INPUT = 16 * 16 * 3;
+const int NUM_HIDDEN = 20;
+const int NUM_OUTPUT = 10;
+
+const int NUM_DATA = 4096;
+const int NUM_EPOCHS = 5;
+const int BATCH_SIZE = 64;
+
+struct TrainingData {
+    vector<vector<float>> xs;
+    vector<const float*> ptrs;
+    vector<int> labels;
+};
+
+TrainingData makeTrainingData()
+{
+    std::mt19937 mt(1);
+    std::uniform_real_distribution<float> distribution(0.0, 1.0);
+
+    TrainingData training;
+    training.xs.assign(NUM_DATA, vector<float>(NUM_INPUT));
+    for (int i = 0; i < NUM_DATA; ++i) {
+        for (auto& v : training.xs[i])
+            v = distribution(mt);
+        training.ptrs.push_back(training.xs[i].data());
+        training.labels.push_back(i % NUM_OUTPUT);
+    }
+    return training;
+}
+
+void showThroughput(const char* name, double seconds)
+{
+    cout << name << ": " << (NUM_DATA * NUM_EPOCHS / seconds) << " samples/sec" << endl;
+}
+
+void runMiniBatch(const char* name, int numShards, Executor* executor)
+{
+    TrainingData training = makeTrainingData();
+    MultiLayerPerceptron mlp(NUM_INPUT, NUM_HIDDEN, NUM_OUTPUT);
+    auto storage = mlp.makeMiniBatchStorage(numShards);
+
+    double begin = currentTime();
+    for (int epoch = 0; epoch < NUM_EPOCHS; ++epoch) {
+        for (int i = 0; i < NUM_DATA; i += BATCH_SIZE) {
+            mlp.trainMiniBatch(BATCH_SIZE, &training.labels[i], &training.ptrs[i], &storage, executor, 0.01);
+        }
+    }
+    showThroughput(name, currentTime() - begin);
+}
+
+} // anonymous namespace
+
+TEST(MultiLayerPerceptronPerformanceTest, train)
+{
+    TrainingData training = makeTrainingData();
+    MultiLayerPerceptron mlp(NUM_INPUT, NUM_HIDDEN, NUM_OUTPUT);
+    auto data = mlp.makeForwadingStorage();
+    auto errorData = mlp.makeBackpropagationStorage();
+
+    double begin = currentTime();
+    for (int epoch = 0; epoch < NUM_EPOCHS; ++epoch) {
+        for (int i = 0; i < NUM_DATA; ++i)
+            mlp.train(training.labels[i], training.ptrs[i], &data, &errorData, 0.01);
+    }
+    showThroughput("train", currentTime() - begin);
+}
+
+TEST(MultiLayerPerceptronPerformanceTest, trainMiniBatch)
+{
+    runMiniBatch("trainMiniBatch", 1, nullptr);
+}
+
+TEST(MultiLayerPerceptronPerformanceTest, trainMiniBatchInParallel)
+{
+    const int numThreads = 4;
+    Executor executor(numThreads);
+    executor.start();
+
+    runMiniBatch("trainMiniBatch (4 threads)", numThreads, &executor);
+}
+
+TEST(MultiLayerPerceptronPerformanceTest, predict)
+{
+    TrainingData training = makeTrainingData();
+    MultiLayerPerceptron mlp(NUM_INPUT, NUM_HIDDEN, NUM_OUTPUT);
+    auto data = mlp.makeForwadingStorage();
+
+    int sum = 0;
+    double begin = currentTime();
+    for (int epoch = 0; epoch < NUM_EPOCHS; ++epoch) {
+        for (int i = 0; i < NUM_DATA; ++i)
+            sum += mlp.predict(training.ptrs[i], &data);
+    }
+    showThroughput("predict", currentTime() - begin);
+    EXPECT_LE(0, sum);
+}
+
+} // namespace learning
@@ -0,0 +1,116 @@
+#include "learning/multi_layer_perceptron.h"
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "base/executor.h"
+
+using namespace std;
+
+namespace learning {
+
+namespace {
+
+const int NUM_INPUT = 10;
+const int NUM_HIDDEN = 7;
+const int NUM_OUTPUT = 3;
+
+void initialize(MultiLayerPerceptron* mlp)
+{
+    std::mt19937 mt(1);
+    std::uniform_real_distribution<float> distribution(-1.0, 1.0);
+
+    vector<float> w2((NUM_INPUT + 1) * NUM_HIDDEN);
+    vector<float> w3((NUM_HIDDEN + 1) * NUM_OUTPUT);
+    for (auto& w : w2)
+        w = distribution(mt);
+    for (auto& w : w3)
+        w = distribution(mt);
+
+    mlp->setHiddenLayerParameter(w2.data());
+    mlp->setOutputLayerParameter(w3.data());
+}
+
+vector<vector<float>> makeInputs(int size)
+{
+    std::mt19937 mt(2);
+    std::uniform_real_distribution<float> distribution(0.0, 1.0);
+
+    vector<vector<float>> xs(size, vector<float>(NUM_INPUT));
+    for (auto& x : xs) {
+        for (auto& v : x)
+            v = distribution(mt);
+    }
+    return xs;
+}
+
+void expectSameOutput(const MultiLayerPerceptron& expected, const MultiLayerPerceptron& actual,
+                      const vector<vector<float>>& xs)
+{
+    auto expectedData = expected.makeForwadingStorage();
+    auto actualData = actual.makeForwadingStorage();
+    for (const auto& x : xs) {
+        EXPECT_EQ(expected.predict(x.data(), &expectedData), actual.predict(x.data(), &actualData));
+        for (int i = 0; i < NUM_OUTPUT; ++i)
+            EXPECT_NEAR(expectedData.i3[i], actualData.i3[i], 1e-4);
+    }
+}
+
+} // anonymous namespace
+
+TEST(MultiLayerPerceptronTest, trainMiniBatchWithSingleData)
+{
+    MultiLayerPerceptron expected(NUM_INPUT, NUM_HIDDEN, NUM_OUTPUT);
+    MultiLayerPerceptron actual(NUM_INPUT, NUM_HIDDEN, NUM_OUTPUT);
+    initialize(&expected);
+    initialize(&actual);
+
+    vector<vector<float>> xs = makeInputs(20);
+
+    auto data = expected.makeForwadingStorage();
+    auto errorData = expected.makeBackpropagationStorage();
+    auto storage = actual.makeMiniBatchStorage(1);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        int label = i % NUM_OUTPUT;
+        const float* x = xs[i].data();
+        EXPECT_EQ(expected.train(label, x, &data, &errorData),
+                  actual.trainMiniBatch(1, &label, &x, &storage) == 1);
+    }
+
+    expectSameOutput(expected, actual, xs);
+}
+
+TEST(MultiLayerPerceptronTest, trainMiniBatchInParallel)
+{
+    const int BATCH_SIZE = 16;
+    const int NUM_SHARDS = 4;
+
+    MultiLayerPerceptron expected(NUM_INPUT, NUM_HIDDEN, NUM_OUTPUT);
+    MultiLayerPerceptron actual(NUM_INPUT, NUM_HIDDEN, NUM_OUTPUT);
+    initialize(&expected);
+    initialize(&actual);
+
+    vector<vector<float>> xs = makeInputs(BATCH_SIZE * 5);
+    vector<int> labels;
+    vector<const float*> ptrs;
+    for (size_t i = 0; i < xs.size(); ++i) {
+        labels.push_back(i % NUM_OUTPUT);
+        ptrs.push_back(xs[i].data());
+    }
+
+    Executor executor(NUM_SHARDS);
+    executor.start();
+
+    auto expectedStorage = expected.makeMiniBatchStorage(1);
+    auto actualStorage = actual.makeMiniBatchStorage(NUM_SHARDS);
+    for (size_t i = 0; i < xs.size(); i += BATCH_SIZE) {
+        EXPECT_EQ(expected.trainMiniBatch(BATCH_SIZE, &labels[i], &ptrs[i], &expectedStorage),
+                  actual.trainMiniBatch(BATCH_SIZE, &labels[i], &ptrs[i], &actualStorage, &executor));
+    }
+
+    expectSameOutput(expected, actual, xs);
+}
+
+} // namespace learning
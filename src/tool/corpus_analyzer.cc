@@ -0,0 +1,72 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "base/executor.h"
+#include "base/time.h"
+#include "core/server/corpus_analyzer.h"
+#include "core/server/game_analyzers.h"
+
+DEFINE_bool(rensa_potential, true, "run RensaDetector on each field. This is the slowest analyzer.");
+DEFINE_int32(rensa_potential_iteration, 2, "the max iteration of RensaDetector::detectIteratively");
+
+DECLARE_int32(num_threads);
+
+using namespace std;
+
+namespace {
+
+template<typename T>
+CorpusAnalyzer::Factory factoryOf()
+{
+    return []() { return unique_ptr<GameAnalyzer>(new T); };
+}
+
+} // namespace
+
+// Analyzes a corpus of game logs (game state logs, JSON logs or PuyofuRecorder logs) in parallel.
+// Use --num_threads to set the number of the workers.
+int main(int argc, char* argv[])
+{
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (argc < 2) {
+        cerr << argv[0] << " <filename> ..." << endl;
+        return EXIT_FAILURE;
+    }
+
+    unique_ptr<Executor> executor = Executor::makeDefaultExecutor();
+    CorpusAnalyzer corpusAnalyzer(executor.get());
+    corpusAnalyzer.addAnalyzer("max chain", factoryOf<MaxChainAnalyzer>());
+    corpusAnalyzer.addAnalyzer("ojama", factoryOf<OjamaAnalyzer>());
+    corpusAnalyzer.addAnalyzer("decision timing", factoryOf<DecisionTimingAnalyzer>());
+    if (FLAGS_rensa_potential) {
+        corpusAnalyzer.addAnalyzer("rensa potential", []() {
+            return unique_ptr<GameAnalyzer>(new RensaPotentialAnalyzer(FLAGS_rensa_potential_iteration));
+        });
+    }
+
+    double beginTime = currentTime();
+    bool ok = corpusAnalyzer.analyze(vector<string>(argv + 1, argv + argc));
+    double endTime = currentTime();
+
+    for (int i = 0; i < corpusAnalyzer.numAnalyzers(); ++i) {
+        cout << "[" << corpusAnalyzer.name(i) << "]" << endl
+             << corpusAnalyzer.result(i).toString() << endl;
+    }
+
+    cout << corpusAnalyzer.numGames() << " games, "
+         << corpusAnalyzer.numFrames() << " frames in "
+         << (endTime - beginTime) << " [s] with "
+         << FLAGS_num_threads << " threads" << endl;
+    for (const string& path : corpusAnalyzer.failedPaths())
+        cerr << "failed to analyze: " << path << endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
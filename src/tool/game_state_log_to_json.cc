@@ -0,0 +1,39 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "core/server/game_state_log.h"
+
+using namespace std;
+
+// Converts game state logs written by GameStateRecorder to json.
+// <name>.bin is converted to <name>.json.
+int main(int argc, char* argv[])
+{
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (argc < 2) {
+        cerr << argv[0] << " <filename> ..." << endl;
+        return EXIT_FAILURE;
+    }
+
+    int status = 0;
+    for (char** filename = argv + 1; *filename; ++filename) {
+        string logPath(*filename);
+        string jsonPath = logPath;
+        if (jsonPath.size() > 4 && jsonPath.compare(jsonPath.size() - 4, 4, ".bin") == 0)
+            jsonPath.resize(jsonPath.size() - 4);
+        jsonPath += ".json";
+
+        if (!convertGameStateLogToJson(logPath, jsonPath)) {
+            cerr << "failed to convert: " << logPath << endl;
+            status = EXIT_FAILURE;
+        }
+    }
+
+    return status;
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -10,6 +11,11 @@
 #include "core/core_field.h"
 #include "core/pattern/pattern_book.h"
 #include "core/rensa_tracker/rensa_chain_tracker.h"
+#include "core/server/game_state_observer.h"
+#include "core/server/game_state_replay.h"
+
+DEFINE_int32(from_frame, 0, "the first frame to analyze in game state logs");
+DEFINE_int32(to_frame, -1, "the last frame to analyze in game state logs. -1 means the last frame");
 
 using namespace std;
 
@@ -83,10 +89,58 @@ void add(PatternBook* patternBook, const CoreField& original, std::unordered_set
     }
 }
 
+void addField(const PlainField& pf, PatternBook* patternBook,
+              std::unordered_set<std::string>* patterns,
+              std::unordered_set<CoreField>* visited)
+{
+    CoreField cf(CoreField::fromPlainFieldWithDrop(pf));
+    if (!visited->insert(cf).second || !cf.rensaWillOccur())
+        return;
+
+    add(patternBook, cf, patterns);
+}
+
+// Reads a game state log written by GameStateRecorder. Only the frames in
+// [FLAGS_from_frame, FLAGS_to_frame] are read.
+bool parseGameStateLogAndAdd(const char* filename, PatternBook* patternBook,
+                             std::unordered_set<std::string>* patterns,
+                             std::unordered_set<CoreField>* visited)
+{
+    GameStateReplay replay;
+    if (!replay.open(filename))
+        return false;
+
+    class Observer : public GameStateObserver {
+    public:
+        Observer(PatternBook* patternBook,
+                 std::unordered_set<std::string>* patterns,
+                 std::unordered_set<CoreField>* visited) :
+            patternBook_(patternBook), patterns_(patterns), visited_(visited) {}
+
+        void onUpdate(const GameState& state) override
+        {
+            addField(state.playerGameState(0).field, patternBook_, patterns_, visited_);
+        }
+
+    private:
+        PatternBook* patternBook_;
+        std::unordered_set<std::string>* patterns_;
+        std::unordered_set<CoreField>* visited_;
+    } observer(patternBook, patterns, visited);
+
+    int fromFrameId = max(FLAGS_from_frame, replay.firstFrameId());
+    int toFrameId = FLAGS_to_frame >= 0 ? FLAGS_to_frame : replay.lastFrameId();
+    return replay.play(fromFrameId, toFrameId, &observer);
+}
+
 bool parseAndAdd(const char* filename, PatternBook* patternBook,
                  std::unordered_set<std::string>* patterns,
                  std::unordered_set<CoreField>* visited)
 {
+    const string name(filename);
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".bin") == 0)
+        return parseGameStateLogAndAdd(filename, patternBook, patterns, visited);
+
     ifstream ifs(filename);
     if (!ifs) {
         PLOG(ERROR) << "failed to open " << filename;
@@ -98,11 +152,7 @@ bool parseAndAdd(const char* filename, PatternBook* patternBook,
 
     for (unsigned int i = 0; i < root.size(); ++i) {
         PlainField pf(root[i]["p1"].asString());
-        CoreField cf(CoreField::fromPlainFieldWithDrop(pf));
-        if (!visited->insert(cf).second || !cf.rensaWillOccur())
-            continue;
-
-        add(patternBook, cf, patterns);
+        addField(pf, patternBook, patterns, visited);
     }
     return true;
 }
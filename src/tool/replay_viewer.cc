@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "core/server/game_state.h"
+#include "core/server/game_state_replay.h"
+#include "gui/box.h"
+#include "gui/field_drawer.h"
+#include "gui/main_window.h"
+#include "gui/user_event_drawer.h"
+
+DEFINE_int32(from_frame, 0, "the frame to start the replay from");
+
+using namespace std;
+
+// Shows a game state log. SPACE plays or pauses, LEFT/RIGHT moves a frame,
+// and UP/DOWN moves a second.
+class ReplayKeyListener : public MainWindow::EventListener {
+public:
+    ReplayKeyListener(GameStateReplay* replay, GameStateObserver* observer, int frameId) :
+        replay_(replay),
+        observer_(observer),
+        frameId_(frameId)
+    {
+        show();
+    }
+
+    void handleEvent(const SDL_Event& event) override
+    {
+        if (event.type != SDL_KEYDOWN)
+            return;
+
+        switch (event.key.keysym.sym) {
+        case SDLK_SPACE:
+            playing_ = !playing_;
+            return;
+        case SDLK_LEFT:
+            move(-1);
+            return;
+        case SDLK_RIGHT:
+            move(1);
+            return;
+        case SDLK_UP:
+            move(-60);
+            return;
+        case SDLK_DOWN:
+            move(60);
+            return;
+        default:
+            return;
+        }
+    }
+
+    void handleAfterPollEvent() override
+    {
+        if (playing_)
+            move(1);
+    }
+
+private:
+    void move(int frames)
+    {
+        frameId_ = max(replay_->firstFrameId(), min(replay_->lastFrameId(), frameId_ + frames));
+        show();
+    }
+
+    void show()
+    {
+        GameState state(frameId_);
+        if (replay_->stateAt(frameId_, &state))
+            observer_->onUpdate(state);
+    }
+
+    GameStateReplay* replay_;
+    GameStateObserver* observer_;
+    int frameId_;
+    bool playing_ = false;
+};
+
+// Gives a state to all the drawers.
+class MultiObserver : public GameStateObserver {
+public:
+    void add(GameStateObserver* observer) { observers_.push_back(observer); }
+
+    void onUpdate(const GameState& state) override
+    {
+        for (GameStateObserver* observer : observers_)
+            observer->onUpdate(state);
+    }
+
+private:
+    vector<GameStateObserver*> observers_;
+};
+
+int main(int argc, char* argv[])
+{
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+
+    if (argc != 2) {
+        cerr << argv[0] << " <game state log>" << endl;
+        return EXIT_FAILURE;
+    }
+
+    GameStateReplay replay;
+    if (!replay.open(argv[1])) {
+        cerr << "failed to open: " << argv[1] << endl;
+        return EXIT_FAILURE;
+    }
+
+    SDL_Init(SDL_INIT_VIDEO);
+    atexit(SDL_Quit);
+
+    MainWindow mainWindow(640, 448, Box(0, 0, 640, 448));
+    FieldDrawer fieldDrawer;
+    UserEventDrawer userEventDrawer;
+    mainWindow.addDrawer(&fieldDrawer);
+    mainWindow.addDrawer(&userEventDrawer);
+
+    MultiObserver observer;
+    observer.add(&fieldDrawer);
+    observer.add(&userEventDrawer);
+
+    ReplayKeyListener listener(&replay, &observer, max(FLAGS_from_frame, replay.firstFrameId()));
+    mainWindow.addEventListener(&listener);
+
+    mainWindow.runMainLoop();
+    return 0;
+}
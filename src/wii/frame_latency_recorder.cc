@@ -0,0 +1,135 @@
+#include "wii/frame_latency_recorder.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "base/file/file.h"
+
+using namespace std;
+
+LatencyHistogram::LatencyHistogram(int maxMillis) :
+    buckets_(maxMillis + 1)
+{
+}
+
+void LatencyHistogram::add(double seconds)
+{
+    int millis = static_cast<int>(seconds * 1000);
+    millis = std::max(0, std::min(millis, static_cast<int>(buckets_.size()) - 1));
+    buckets_[millis] += 1;
+    count_ += 1;
+    maxSeconds_ = std::max(maxSeconds_, seconds);
+}
+
+double LatencyHistogram::percentileMillis(double p) const
+{
+    if (count_ == 0)
+        return 0;
+
+    int threshold = static_cast<int>(count_ * p / 100);
+    int sum = 0;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+        sum += buckets_[i];
+        if (sum > threshold)
+            return i;
+    }
+    return buckets_.size() - 1;
+}
+
+string LatencyHistogram::toString() const
+{
+    ostringstream ss;
+    ss << "count=" << count_
+       << " p50=" << percentileMillis(50) << "ms"
+       << " p90=" << percentileMillis(90) << "ms"
+       << " p99=" << percentileMillis(99) << "ms"
+       << " max=" << fixed << setprecision(1) << maxMillis() << "ms" << endl;
+
+    int maxBucket = *std::max_element(buckets_.begin(), buckets_.end());
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+        if (buckets_[i] == 0)
+            continue;
+        int width = maxBucket > 0 ? (buckets_[i] * 50 + maxBucket - 1) / maxBucket : 0;
+        ss << setw(4) << i << (i + 1 == buckets_.size() ? "+ms " : "ms  ")
+           << setw(7) << buckets_[i] << " " << string(width, '#') << endl;
+    }
+    return ss.str();
+}
+
+void FrameLatencyRecorder::record(const FrameTimestamps& ts)
+{
+    lock_guard<mutex> lock(mu_);
+    timestamps_.push_back(ts);
+}
+
+vector<FrameTimestamps> FrameLatencyRecorder::timestamps() const
+{
+    lock_guard<mutex> lock(mu_);
+    return timestamps_;
+}
+
+template<typename Begin, typename End>
+LatencyHistogram FrameLatencyRecorder::makeHistogram(Begin begin, End end) const
+{
+    lock_guard<mutex> lock(mu_);
+    LatencyHistogram histogram;
+    for (const FrameTimestamps& ts : timestamps_) {
+        double b = begin(ts);
+        double e = end(ts);
+        if (b < 0 || e < 0)
+            continue;
+        histogram.add(e - b);
+    }
+    return histogram;
+}
+
+LatencyHistogram FrameLatencyRecorder::analysisLatency() const
+{
+    return makeHistogram([](const FrameTimestamps& ts) { return ts.captured; },
+                         [](const FrameTimestamps& ts) { return ts.analyzed; });
+}
+
+LatencyHistogram FrameLatencyRecorder::aiLatency() const
+{
+    return makeHistogram([](const FrameTimestamps& ts) { return ts.analyzed; },
+                         [](const FrameTimestamps& ts) { return ts.aiResponded; });
+}
+
+LatencyHistogram FrameLatencyRecorder::keyLatency() const
+{
+    return makeHistogram([](const FrameTimestamps& ts) { return ts.aiResponded; },
+                         [](const FrameTimestamps& ts) { return ts.keySent; });
+}
+
+LatencyHistogram FrameLatencyRecorder::endToEndLatency() const
+{
+    return makeHistogram([](const FrameTimestamps& ts) { return ts.captured; },
+                         [](const FrameTimestamps& ts) { return ts.keySent; });
+}
+
+string FrameLatencyRecorder::toString() const
+{
+    ostringstream ss;
+    ss << "capture -> analysis: " << analysisLatency().toString()
+       << "analysis -> AI response: " << aiLatency().toString()
+       << "AI response -> key: " << keyLatency().toString()
+       << "capture -> key: " << endToEndLatency().toString();
+    return ss.str();
+}
+
+bool FrameLatencyRecorder::saveAsCSV(const string& filename) const
+{
+    ostringstream ss;
+    ss << "frame_id,captured,analyzed,ai_responded,key_sent" << endl;
+    ss << fixed << setprecision(6);
+    for (const FrameTimestamps& ts : timestamps()) {
+        ss << ts.frameId << ','
+           << ts.captured << ','
+           << ts.analyzed << ','
+           << ts.aiResponded << ','
+           << ts.keySent << endl;
+    }
+
+    return file::writeFile(filename, ss.str());
+}
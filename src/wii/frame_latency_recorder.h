@@ -0,0 +1,64 @@
+#ifndef WII_FRAME_LATENCY_RECORDER_H_
+#define WII_FRAME_LATENCY_RECORDER_H_
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Timestamps [s] of each stage in WiiConnectServer for one frame.
+// A negative value means the stage didn't happen in the frame
+// (e.g. no key is sent in most of the frames).
+struct FrameTimestamps {
+    int frameId = 0;
+    double captured = -1;     // Source produced the frame (e.g. the capture device delivered it).
+    double analyzed = -1;     // Analyzer finished analyzing the frame.
+    double aiResponded = -1;  // the responses from AIs are received.
+    double keySent = -1;      // keys are passed to KeySender.
+};
+
+// LatencyHistogram is a histogram of latency with 1ms buckets.
+class LatencyHistogram {
+public:
+    explicit LatencyHistogram(int maxMillis = 100);
+
+    // |seconds| larger than maxMillis is counted in the last bucket.
+    void add(double seconds);
+
+    int count() const { return count_; }
+    double percentileMillis(double p) const;
+    double maxMillis() const { return maxSeconds_ * 1000; }
+
+    std::string toString() const;
+
+private:
+    std::vector<int> buckets_;
+    int count_ = 0;
+    double maxSeconds_ = 0;
+};
+
+// FrameLatencyRecorder collects FrameTimestamps of every frame, and makes latency
+// histograms of each stage. This is thread-safe.
+class FrameLatencyRecorder {
+public:
+    void record(const FrameTimestamps&);
+
+    std::vector<FrameTimestamps> timestamps() const;
+
+    // capture -> analysis, analysis -> AI response, AI response -> key, capture -> key.
+    LatencyHistogram analysisLatency() const;
+    LatencyHistogram aiLatency() const;
+    LatencyHistogram keyLatency() const;
+    LatencyHistogram endToEndLatency() const;
+
+    std::string toString() const;
+    bool saveAsCSV(const std::string& filename) const;
+
+private:
+    template<typename Begin, typename End>
+    LatencyHistogram makeHistogram(Begin, End) const;
+
+    mutable std::mutex mu_;
+    std::vector<FrameTimestamps> timestamps_;
+};
+
+#endif // WII_FRAME_LATENCY_RECORDER_H_
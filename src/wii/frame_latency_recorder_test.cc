@@ -0,0 +1,51 @@
+#include "wii/frame_latency_recorder.h"
+
+#include <gtest/gtest.h>
+
+TEST(LatencyHistogramTest, percentile)
+{
+    LatencyHistogram histogram(100);
+    for (int i = 0; i < 100; ++i)
+        histogram.add(i * 0.001 + 0.0005);
+
+    EXPECT_EQ(100, histogram.count());
+    EXPECT_EQ(50, histogram.percentileMillis(50));
+    EXPECT_EQ(90, histogram.percentileMillis(90));
+    EXPECT_NEAR(99.5, histogram.maxMillis(), 1e-6);
+}
+
+TEST(LatencyHistogramTest, overflow)
+{
+    LatencyHistogram histogram(10);
+    histogram.add(1.0);
+
+    EXPECT_EQ(10, histogram.percentileMillis(50));
+    EXPECT_NEAR(1000, histogram.maxMillis(), 1e-6);
+}
+
+TEST(FrameLatencyRecorderTest, histogram)
+{
+    FrameLatencyRecorder recorder;
+
+    FrameTimestamps ts1;
+    ts1.frameId = 1;
+    ts1.captured = 1.0;
+    ts1.analyzed = 1.0105;
+    ts1.aiResponded = 1.0205;
+    ts1.keySent = 1.0215;
+    recorder.record(ts1);
+
+    // No key is sent in this frame.
+    FrameTimestamps ts2;
+    ts2.frameId = 2;
+    ts2.captured = 2.0;
+    ts2.analyzed = 2.0055;
+    recorder.record(ts2);
+
+    EXPECT_EQ(2u, recorder.timestamps().size());
+    EXPECT_EQ(2, recorder.analysisLatency().count());
+    EXPECT_EQ(1, recorder.aiLatency().count());
+    EXPECT_EQ(1, recorder.keyLatency().count());
+    EXPECT_EQ(1, recorder.endToEndLatency().count());
+    EXPECT_EQ(21, recorder.endToEndLatency().percentileMillis(50));
+}
@@ -0,0 +1,105 @@
+// replay_wii drives WiiConnectServer from a recorded movie or captured images
+// instead of the capture hardware, and reports the latency of each stage.
+// Keys are not sent anywhere (or printed to stdout with --stdout_keys), so this
+// runs without any hardware.
+//
+// A deterministic AI such as cpu/control_tester/run_right.sh is useful to see
+// the latency of the server itself.
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include <SDL.h>
+
+#include "base/file/path.h"
+#include "base/strings.h"
+#include "capture/ac_analyzer.h"
+#include "capture/images_source.h"
+#include "capture/movie_source.h"
+#include "wii/frame_latency_recorder.h"
+#include "wii/null_key_sender.h"
+#include "wii/stdout_key_sender.h"
+#include "wii/wii_connect_server.h"
+
+using namespace std;
+
+DEFINE_string(source, "", "movie filename, or directory containing captured images (*.bmp, *.png)");
+DEFINE_int32(fps, 60, "FPS of the movie.");
+DEFINE_bool(stdout_keys, false, "print keys to stdout instead of discarding them");
+DEFINE_string(csv, "", "if set, per-frame timestamps are saved to this file");
+
+static unique_ptr<Source> makeReplaySource()
+{
+    if (file::isDirectory(FLAGS_source)) {
+        vector<string> files;
+        CHECK(file::listFiles(FLAGS_source, &files)) << FLAGS_source;
+
+        vector<string> images;
+        for (const auto& f : files) {
+            if (strings::hasSuffix(f, ".bmp") || strings::hasSuffix(f, ".png"))
+                images.push_back(file::joinPath(FLAGS_source, f));
+        }
+        std::sort(images.begin(), images.end());
+        CHECK(!images.empty()) << "no image in " << FLAGS_source;
+
+        return unique_ptr<Source>(new Images(images));
+    }
+
+    MovieSource* source = new MovieSource(FLAGS_source);
+    source->setFPS(FLAGS_fps);
+    return unique_ptr<Source>(source);
+}
+
+static unique_ptr<KeySender> makeKeySender()
+{
+    if (FLAGS_stdout_keys)
+        return unique_ptr<KeySender>(new StdoutKeySender);
+    return unique_ptr<KeySender>(new NullKeySender);
+}
+
+int main(int argc, char* argv[])
+{
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    google::InitGoogleLogging(argv[0]);
+#if !defined(_MSC_VER)
+    google::InstallFailureSignalHandler();
+#endif
+
+    if (argc < 3 || FLAGS_source.empty()) {
+        fprintf(stderr, "Usage: %s --source=<movie or image directory> [option] <1p> <2p>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    SDL_Init(SDL_INIT_TIMER);
+    atexit(SDL_Quit);
+
+    MovieSource::init();
+
+    unique_ptr<Source> source = makeReplaySource();
+    CHECK(source->ok());
+
+    ACAnalyzer analyzer;
+    unique_ptr<KeySender> keySender[2] { makeKeySender(), makeKeySender() };
+
+    FrameLatencyRecorder recorder;
+    WiiConnectServer server(source.get(), &analyzer, keySender[0].get(), keySender[1].get(), argv[1], argv[2]);
+    server.setLatencyRecorder(&recorder);
+
+    source->start();
+    server.start();
+    server.waitUntilDone();
+
+    cout << "frames: delivered=" << source->numDeliveredFrames()
+         << " dropped=" << source->numDroppedFrames() << endl;
+    cout << recorder.toString();
+
+    if (!FLAGS_csv.empty())
+        CHECK(recorder.saveAsCSV(FLAGS_csv)) << FLAGS_csv;
+
+    return 0;
+}
@@ -68,6 +68,12 @@ void WiiConnectServer::stop()
         th_.join();
 }
 
+void WiiConnectServer::waitUntilDone()
+{
+    if (th_.joinable())
+        th_.join();
+}
+
 void WiiConnectServer::reset()
 {
     for (int i = 0; i < 2; ++i) {
@@ -97,6 +103,9 @@ void WiiConnectServer::runLoop()
 
     while (!shouldStop_) {
         UniqueSDLSurface surface(source_->nextFrame());
+        timestamps_ = FrameTimestamps();
+        timestamps_.frameId = frameId;
+        timestamps_.captured = source_->lastFrameTime();
 
         auto curr_time = std::chrono::steady_clock::now();
         auto timeout_time = curr_time + std::chrono::milliseconds(16);
@@ -128,6 +137,7 @@ void WiiConnectServer::runLoop()
 
         unique_ptr<AnalyzerResult> r =
             analyzer_->analyze(surface.get(), prevSurface.get(), prev2Surface.get(), prev3Surface.get(), analyzerResults_);
+        timestamps_.analyzed = currentTime();
         LOG(INFO) << r->toString();
 
         switch (r->state()) {
@@ -210,6 +220,9 @@ void WiiConnectServer::runLoop()
                 analyzerResults_.pop_back();
         }
 
+        if (latencyRecorder_)
+            latencyRecorder_->record(timestamps_);
+
         frameId++;
     }
 }
@@ -285,6 +298,7 @@ bool WiiConnectServer::playForPlaying(int frameId, const AnalyzerResult& analyze
 
     vector<FrameResponse> responses[2];
     connector_->receive(frameId, responses, timeout_time);
+    timestamps_.aiResponded = currentTime();
 
     for (int pi = 0; pi < 2; pi++) {
         if (!isAi_[pi])
@@ -528,6 +542,7 @@ void WiiConnectServer::outputKeys(int pi, const AnalyzerResult& analyzerResult,
         }
 
         keySenders_[pi]->sendKeySetSeq(keySetSeq);
+        timestamps_.keySent = currentTime();
         return;
     }
 }
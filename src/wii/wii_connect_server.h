@@ -20,6 +20,7 @@
 #include "core/server/connector/connector_manager.h"
 #include "gui/drawer.h"
 #include "gui/unique_sdl_surface.h"
+#include "wii/frame_latency_recorder.h"
 
 class Analyzer;
 class AnalyzerResult;
@@ -36,12 +37,16 @@ public:
 
     // Dont' take the ownership.
     void addObserver(GameStateObserver*);
+    // Dont' take the ownership. This should be called before start().
+    void setLatencyRecorder(FrameLatencyRecorder* recorder) { latencyRecorder_ = recorder; }
 
     virtual void draw(Screen*) override;
     virtual std::unique_ptr<AnalyzerResult> analyzerResult() const override;
 
     bool start();
     void stop();
+    // Waits until the server stops by itself, e.g. when the source reaches its end.
+    void waitUntilDone();
 
     static KumipuyoPos calculateDropPosition(const PlainField&, const Decision&);
 
@@ -76,6 +81,10 @@ private:
     Analyzer* analyzer_;
     KeySender* keySenders_[2];
 
+    FrameLatencyRecorder* latencyRecorder_ = nullptr;
+    // Timestamps of the current frame. Used only in the server thread.
+    FrameTimestamps timestamps_;
+
     std::map<RealColor, PuyoColor> colorMap_;
     std::array<bool, 4> colorsUsed_;
 